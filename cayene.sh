@@ -23,6 +23,8 @@ function print_usage() {
     echo "  build [debug|release]      - Compilar el proyecto"
     echo "  test [debug|release]       - Ejecutar tests"
     echo "  run [debug|release]        - Ejecutar el ejemplo básico"
+    echo "  bench [preset]             - Ejecutar el benchmark de decodificación"
+    echo "  pgo                        - Compilar con ThinLTO + PGO (preset release-pgo)"
     echo "  clean                      - Limpiar archivos de build"
     echo "  rebuild [debug|release]    - Limpiar y recompilar"
     echo "  format                     - Formatear código con clang-format"
@@ -84,6 +86,32 @@ function run_example() {
     "./build/$build_type/examples/basic_example"
 }
 
+function run_bench() {
+    local build_type="${1:-$BUILD_TYPE}"
+    echo -e "${YELLOW}Ejecutando benchmark (${build_type})...${NC}"
+    cd "$PROJECT_ROOT"
+
+    if [ ! -f "build/$build_type/tools/cayene_bench" ]; then
+        echo -e "${YELLOW}Ejecutable no encontrado, compilando primero...${NC}"
+        configure_project "$build_type"
+        build_project "$build_type"
+    fi
+
+    "./build/$build_type/tools/cayene_bench"
+}
+
+function pgo_build() {
+    echo -e "${YELLOW}Compilando binario instrumentado y entrenando con el corpus...${NC}"
+    cd "$PROJECT_ROOT"
+    cmake --preset release-pgo-generate
+    cmake --build --preset release-pgo-train
+
+    echo -e "${YELLOW}Compilando con ThinLTO + PGO...${NC}"
+    cmake --preset release-pgo
+    cmake --build --preset release-pgo
+    echo -e "${GREEN}✓ Compilación PGO completa (build/release-pgo)${NC}"
+}
+
 function clean_project() {
     echo -e "${YELLOW}Limpiando archivos de build...${NC}"
     cd "$PROJECT_ROOT"
@@ -141,6 +169,12 @@ case $COMMAND in
     run)
         run_example "$@"
         ;;
+    bench)
+        run_bench "$@"
+        ;;
+    pgo)
+        pgo_build
+        ;;
     clean)
         clean_project
         ;;
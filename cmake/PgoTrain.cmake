@@ -0,0 +1,40 @@
+# Runs the PGO training workload and merges the resulting profiles.
+#
+# Invoked by the cayene_pgo_train target with:
+#   -DBENCH=<path to cayene_bench>
+#   -DPROFILE_DIR=<CAYENE_PGO_DIR>
+#   -DCOMPILER_ID=<CMAKE_CXX_COMPILER_ID>
+#   -DLLVM_PROFDATA=<llvm-profdata, Clang only>
+
+file(GLOB_RECURSE stale_profiles
+    "${PROFILE_DIR}/*.profraw" "${PROFILE_DIR}/*.profdata" "${PROFILE_DIR}/*.gcda"
+)
+if(stale_profiles)
+    file(REMOVE ${stale_profiles})
+endif()
+
+execute_process(
+    COMMAND "${BENCH}" --payloads 20000 --iterations 20
+    RESULT_VARIABLE bench_result
+)
+if(NOT bench_result EQUAL 0)
+    message(FATAL_ERROR "Training workload failed: ${bench_result}")
+endif()
+
+# GCC writes .gcda files straight into PROFILE_DIR; Clang needs a merge step
+if(COMPILER_ID MATCHES "Clang")
+    file(GLOB raw_profiles "${PROFILE_DIR}/*.profraw")
+    if(NOT raw_profiles)
+        message(FATAL_ERROR "No .profraw files were written to ${PROFILE_DIR}")
+    endif()
+
+    execute_process(
+        COMMAND "${LLVM_PROFDATA}" merge -output=${PROFILE_DIR}/cayene.profdata ${raw_profiles}
+        RESULT_VARIABLE merge_result
+    )
+    if(NOT merge_result EQUAL 0)
+        message(FATAL_ERROR "llvm-profdata merge failed: ${merge_result}")
+    endif()
+endif()
+
+message(STATUS "PGO profiles written to ${PROFILE_DIR}")
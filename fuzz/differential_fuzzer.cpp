@@ -0,0 +1,249 @@
+/**
+ * @file differential_fuzzer.cpp
+ * @brief libFuzzer target checking every decode engine against Decoder::decode
+ *
+ * The first input bytes describe random custom-type registrations, the rest
+ * is the payload. Each engine must agree with the reference JSON decoder on
+ * both the error classification and the decoded values; any mismatch aborts.
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "cayene/decoder.hpp"
+
+namespace
+{
+
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define FUZZ_CHECK(condition)                                                             \
+    do                                                                                    \
+    {                                                                                     \
+        if (!(condition))                                                                 \
+        {                                                                                 \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            std::abort();                                                                 \
+        }                                                                                 \
+    } while (false)
+
+constexpr std::size_t kMaxCustomTypes = 4;
+constexpr std::size_t kMaxCustomSize = 12;
+
+/**
+ * @brief Reference decode result, with exceptions mapped to error codes
+ */
+struct Reference
+{
+    cayene::ErrorCode code{cayene::ErrorCode::Ok};
+    cayene::Json json;
+};
+
+Reference run_reference(cayene::Decoder& decoder, std::span<const std::uint8_t> payload)
+{
+    Reference reference;
+    try
+    {
+        reference.json = decoder.decode(payload);
+    }
+    catch (const cayene::PayloadEmptyException&)
+    {
+        reference.code = cayene::ErrorCode::PayloadEmpty;
+    }
+    catch (const cayene::UnknownDataTypeException&)
+    {
+        reference.code = cayene::ErrorCode::UnknownDataType;
+    }
+    catch (const cayene::BadPayloadFormatException&)
+    {
+        reference.code = cayene::ErrorCode::BadPayloadFormat;
+    }
+    catch (const cayene::UnexpectedException&)
+    {
+        reference.code = cayene::ErrorCode::Unexpected;
+    }
+    return reference;
+}
+
+// Custom decoders echo their bytes so values can be compared exactly
+cayene::Json echo_decoder(std::span<const std::uint8_t> data)
+{
+    cayene::Json bytes = cayene::Json::array();
+    for (const std::uint8_t byte : data)
+    {
+        bytes.push_back(byte);
+    }
+    return bytes;
+}
+
+std::size_t register_custom_types(cayene::Decoder& decoder, std::span<const std::uint8_t> input)
+{
+    if (input.empty())
+    {
+        return 0;
+    }
+
+    const std::size_t count = input[0] % (kMaxCustomTypes + 1);
+    std::size_t consumed = 1;
+    for (std::size_t i = 0; i < count && consumed + 2 <= input.size(); ++i, consumed += 2)
+    {
+        const std::uint8_t type_id = input[consumed];
+        const std::size_t size = 1 + (input[consumed + 1] % kMaxCustomSize);
+        const bool existed = decoder.has_type(type_id);
+        const bool added = decoder.add_custom_type(type_id, "Custom" + std::to_string(type_id),
+                                                   size, echo_decoder);
+        FUZZ_CHECK(added != existed);
+    }
+    return consumed;
+}
+
+std::string record_key(const cayene::Decoder& decoder, const cayene::Record& record)
+{
+    return decoder.find_type(record.type_id)->name + "_" + std::to_string(record.channel);
+}
+
+void check_record(const cayene::Record& record, const cayene::Json& expected)
+{
+    if (record.value_count == 0)
+    {
+        FUZZ_CHECK(echo_decoder(record.data) == expected);
+        return;
+    }
+
+    if (record.value_count == 1)
+    {
+        FUZZ_CHECK(expected.is_number());
+        FUZZ_CHECK(expected.get<double>() == record.value(0));
+        return;
+    }
+
+    static constexpr const char* xyz[] = {"x", "y", "z"};
+    static constexpr const char* gps[] = {"latitude", "longitude", "altitude"};
+    const auto* const names = record.type_id == 0x88 ? gps : xyz;
+    FUZZ_CHECK(expected.is_object() && expected.size() == record.value_count);
+    for (std::size_t i = 0; i < record.value_count; ++i)
+    {
+        FUZZ_CHECK(expected.at(names[i]).get<double>() == record.value(i));
+    }
+}
+
+void check_records(const cayene::Decoder& decoder, const Reference& reference,
+                   std::span<const cayene::Record> records)
+{
+    // Later records overwrite earlier ones with the same key, as in the Json object
+    cayene::Json seen = cayene::Json::object();
+    for (const auto& record : records)
+    {
+        const std::string key = record_key(decoder, record);
+        FUZZ_CHECK(reference.json.contains(key));
+        seen[key] = true;
+    }
+    FUZZ_CHECK(seen.size() == reference.json.size());
+
+    for (std::size_t i = 0; i < records.size(); ++i)
+    {
+        const std::string key = record_key(decoder, records[i]);
+        bool overwritten = false;
+        for (std::size_t j = i + 1; j < records.size(); ++j)
+        {
+            overwritten = overwritten || record_key(decoder, records[j]) == key;
+        }
+        if (!overwritten)
+        {
+            check_record(records[i], reference.json.at(key));
+        }
+    }
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    const std::span<const std::uint8_t> input(data, size);
+
+    cayene::Decoder decoder;
+    const std::size_t consumed = register_custom_types(decoder, input);
+    const auto payload = input.subspan(consumed);
+
+    const Reference reference = run_reference(decoder, payload);
+
+    // validate
+    const cayene::DecodeStatus validated = decoder.validate(payload);
+    FUZZ_CHECK(validated.code == reference.code);
+
+    // decode_records
+    std::vector<cayene::Record> records((payload.size() / 2) + 1);
+    const cayene::DecodeStatus decoded = decoder.decode_records(payload, records);
+    FUZZ_CHECK(decoded.code == reference.code);
+    FUZZ_CHECK(decoded.offset == validated.offset);
+    records.resize(decoded.count);
+    if (decoded.ok())
+    {
+        FUZZ_CHECK(decoded.count == validated.count);
+        check_records(decoder, reference, records);
+    }
+
+    // visit
+    std::vector<cayene::Record> visited;
+    const cayene::DecodeStatus visit_status = decoder.visit(
+        payload, [&visited](const cayene::Record& record) { visited.push_back(record); });
+    FUZZ_CHECK(visit_status.code == reference.code);
+    FUZZ_CHECK(visited.size() == records.size() || !visit_status.ok());
+
+    // write_json
+    std::vector<char> text((payload.size() * 64) + 16);
+    const cayene::DecodeStatus written = decoder.write_json(payload, text);
+    FUZZ_CHECK(written.code == reference.code);
+    if (written.ok())
+    {
+        FUZZ_CHECK(cayene::Json::parse(text.begin(), text.begin() + static_cast<std::ptrdiff_t>(
+                                                                      written.count)) ==
+                   reference.json);
+    }
+
+    // decode_flat
+    cayene::FlatObject flat;
+    const cayene::DecodeStatus flat_status = decoder.decode_flat(payload, flat);
+    FUZZ_CHECK(flat_status.code == reference.code);
+    if (flat_status.ok())
+    {
+        FUZZ_CHECK(flat_status.count == validated.count);
+        FUZZ_CHECK(flat.to_json() == reference.json);
+    }
+
+    // Projection on the first record's type: the same records as filtering afterwards
+    if (decoded.ok() && !records.empty())
+    {
+        const auto filter = cayene::RecordFilter::types({records.front().type_id});
+        std::vector<cayene::Record> projected(records.size());
+        const cayene::DecodeStatus projected_status =
+            decoder.decode_records(payload, projected, filter);
+        FUZZ_CHECK(projected_status.ok());
+
+        cayene::Json expected = cayene::Json::object();
+        std::size_t selected = 0;
+        for (const auto& record : records)
+        {
+            if (record.type_id != records.front().type_id)
+            {
+                continue;
+            }
+            FUZZ_CHECK(selected < projected_status.count);
+            FUZZ_CHECK(projected[selected].data.data() == record.data.data());
+            ++selected;
+            const std::string key = record_key(decoder, record);
+            expected[key] = reference.json.at(key);
+        }
+        FUZZ_CHECK(selected == projected_status.count);
+        FUZZ_CHECK(decoder.decode(payload, filter) == expected);
+    }
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file standalone_driver.cpp
+ * @brief Minimal LLVMFuzzerTestOneInput driver for compilers without libFuzzer
+ *
+ * Replays every file given on the command line, then runs -runs=N inputs
+ * from a fixed-seed generator biased towards well-formed Cayene LPP records.
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size);
+
+namespace
+{
+
+constexpr std::uint8_t kStandardTypes[] = {0x00, 0x01, 0x02, 0x03, 0x65, 0x66,
+                                           0x67, 0x68, 0x71, 0x73, 0x86, 0x88};
+constexpr std::size_t kStandardSizes[] = {1, 1, 2, 2, 2, 1, 2, 2, 6, 2, 6, 9};
+
+std::vector<std::uint8_t> generate_input(std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<std::uint8_t> input;
+
+    // Custom type registrations header
+    const int custom_count = byte(rng) % 5;
+    input.push_back(static_cast<std::uint8_t>(custom_count));
+    for (int i = 0; i < custom_count * 2; ++i)
+    {
+        input.push_back(static_cast<std::uint8_t>(byte(rng)));
+    }
+
+    const int record_count = byte(rng) % 8;
+    for (int i = 0; i < record_count; ++i)
+    {
+        input.push_back(static_cast<std::uint8_t>(byte(rng)));
+        const int choice = byte(rng) % 16;
+        if (choice < 12)
+        {
+            input.push_back(kStandardTypes[choice]);
+            for (std::size_t j = 0; j < kStandardSizes[choice]; ++j)
+            {
+                input.push_back(static_cast<std::uint8_t>(byte(rng)));
+            }
+        }
+        else
+        {
+            // Arbitrary type id and length, exercising custom types and errors
+            const int length = 1 + (byte(rng) % 12);
+            for (int j = 0; j < length; ++j)
+            {
+                input.push_back(static_cast<std::uint8_t>(byte(rng)));
+            }
+        }
+    }
+    return input;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    long runs = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (argument.rfind("-runs=", 0) == 0)
+        {
+            runs = std::stol(argument.substr(6));
+            continue;
+        }
+
+        std::ifstream file(argument, std::ios::binary);
+        const std::vector<std::uint8_t> input((std::istreambuf_iterator<char>(file)),
+                                              std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+
+    std::mt19937 rng(0xCA7E4E);
+    for (long run = 0; run < runs; ++run)
+    {
+        const auto input = generate_input(rng);
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+
+    std::cout << "Executed " << runs << " generated inputs\n";
+    return 0;
+}
@@ -0,0 +1,314 @@
+#ifndef CAYENE_AFFINITY_HPP
+#define CAYENE_AFFINITY_HPP
+
+/**
+ * @file affinity.hpp
+ * @brief CPU topology discovery, thread pinning and NUMA-local allocation helpers
+ *
+ * On Linux the NUMA layout is read from /sys/devices/system/node and
+ * threads are pinned with pthread_setaffinity_np(); no libnuma is needed.
+ * Memory is placed by first touch: the kernel backs a page on the node of
+ * the CPU that first writes it, so buffers allocated and initialized by a
+ * thread pinned to a node live on that node. Elsewhere the topology is a
+ * single node and pinning reports ENOSYS.
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace cayene
+{
+
+/**
+ * @brief How worker threads are bound to CPUs
+ */
+enum class CpuPlacement : std::uint8_t
+{
+    None,  ///< Leave scheduling to the OS
+    Node,  ///< Pin each thread to all CPUs of its NUMA node
+    Core,  ///< Pin each thread to one CPU of its NUMA node
+};
+
+/**
+ * @brief Parse a kernel CPU list such as "0-3,8,10-11"
+ *
+ * @return The CPUs in the order listed; empty if the text is malformed
+ */
+[[nodiscard]] inline std::vector<unsigned> parse_cpu_list(std::string_view text)
+{
+    std::vector<unsigned> cpus;
+    auto number = [&text](unsigned& value)
+    {
+        if (text.empty() || text.front() < '0' || text.front() > '9')
+        {
+            return false;
+        }
+        value = 0;
+        while (!text.empty() && text.front() >= '0' && text.front() <= '9')
+        {
+            value = (value * 10) + static_cast<unsigned>(text.front() - '0');
+            text.remove_prefix(1);
+        }
+        return true;
+    };
+
+    while (!text.empty() && (text.back() == '\n' || text.back() == ' '))
+    {
+        text.remove_suffix(1);
+    }
+    while (!text.empty())
+    {
+        unsigned first = 0;
+        if (!number(first))
+        {
+            return {};
+        }
+        unsigned last = first;
+        if (!text.empty() && text.front() == '-')
+        {
+            text.remove_prefix(1);
+            if (!number(last) || last < first)
+            {
+                return {};
+            }
+        }
+        for (unsigned cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+        if (!text.empty())
+        {
+            if (text.front() != ',')
+            {
+                return {};
+            }
+            text.remove_prefix(1);
+        }
+    }
+    return cpus;
+}
+
+/**
+ * @brief The CPUs this process may run on, grouped by NUMA node
+ *
+ * Threads are spread over the nodes in contiguous blocks: of count
+ * threads, thread index runs on node index * node_count() / count, so
+ * neighbouring indices (e.g. a pipeline's workers) share a node.
+ */
+struct CpuTopology
+{
+    std::vector<std::vector<unsigned>> nodes;  ///< CPUs of each node that has any usable CPU
+
+    /**
+     * @brief Read the topology of the machine, restricted to the process's affinity mask
+     *
+     * Always returns at least one node.
+     */
+    [[nodiscard]] static CpuTopology detect()
+    {
+        std::vector<unsigned> allowed;
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (::sched_getaffinity(0, sizeof(set), &set) == 0)
+        {
+            for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if (CPU_ISSET(cpu, &set))
+                {
+                    allowed.push_back(cpu);
+                }
+            }
+        }
+#endif
+        if (allowed.empty())
+        {
+            for (unsigned cpu = 0; cpu < std::max(1U, std::thread::hardware_concurrency()); ++cpu)
+            {
+                allowed.push_back(cpu);
+            }
+        }
+
+        CpuTopology topology;
+#if defined(__linux__)
+        // Node numbers may have gaps (offline or memory-only nodes)
+        for (unsigned node = 0, missing = 0; missing < 8; ++node)
+        {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) +
+                               "/cpulist");
+            if (!file)
+            {
+                ++missing;
+                continue;
+            }
+            missing = 0;
+            std::string line;
+            std::getline(file, line);
+            std::vector<unsigned> cpus;
+            for (const unsigned cpu : parse_cpu_list(line))
+            {
+                if (std::binary_search(allowed.begin(), allowed.end(), cpu))
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+            if (!cpus.empty())
+            {
+                topology.nodes.push_back(std::move(cpus));
+            }
+        }
+#endif
+        if (topology.nodes.empty())
+        {
+            topology.nodes.push_back(std::move(allowed));
+        }
+        return topology;
+    }
+
+    [[nodiscard]] std::size_t node_count() const noexcept { return nodes.size(); }
+
+    /**
+     * @brief Node of thread index out of count
+     */
+    [[nodiscard]] std::size_t node_of(std::size_t index, std::size_t count) const noexcept
+    {
+        if (nodes.empty() || count == 0)
+        {
+            return 0;
+        }
+        return std::min((index % count) * nodes.size() / count, nodes.size() - 1);
+    }
+
+    /**
+     * @brief CPUs that thread index out of count should be pinned to
+     *
+     * Node placement returns the whole node. Core placement returns one CPU,
+     * handing the node's CPUs out in turn to the threads placed on it.
+     * Empty for CpuPlacement::None.
+     */
+    [[nodiscard]] std::vector<unsigned> cpus_for(std::size_t index, std::size_t count,
+                                                 CpuPlacement placement) const
+    {
+        if (placement == CpuPlacement::None || nodes.empty() || count == 0)
+        {
+            return {};
+        }
+        const std::size_t node = node_of(index, count);
+        const std::vector<unsigned>& cpus = nodes[node];
+        if (placement == CpuPlacement::Node || cpus.empty())
+        {
+            return cpus;
+        }
+        std::size_t first = index % count;  // First thread index placed on this node
+        while (first > 0 && node_of(first - 1, count) == node)
+        {
+            --first;
+        }
+        return {cpus[((index % count) - first) % cpus.size()]};
+    }
+};
+
+/**
+ * @brief Restrict the calling thread to a set of CPUs
+ *
+ * @return false with errno set on failure (EINVAL for CPUs outside the
+ *         machine or the process's cpuset, ENOSYS where unsupported)
+ */
+inline bool pin_current_thread(std::span<const unsigned> cpus) noexcept
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const unsigned cpu : cpus)
+    {
+        if (cpu >= CPU_SETSIZE)
+        {
+            errno = EINVAL;
+            return false;
+        }
+        CPU_SET(cpu, &set);
+    }
+    if (cpus.empty())
+    {
+        errno = EINVAL;
+        return false;
+    }
+    const int error = ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+    if (error != 0)
+    {
+        errno = error;
+        return false;
+    }
+    return true;
+#else
+    static_cast<void>(cpus);
+    errno = ENOSYS;
+    return false;
+#endif
+}
+
+/**
+ * @brief Run a callable on a short-lived thread pinned to the given CPUs
+ *
+ * Whatever the callable allocates and initializes is first touched on
+ * their node, so this places long-lived buffers without a NUMA library.
+ * The callable runs even if pinning fails; it then lands wherever the OS
+ * schedules it. Exceptions it throws are rethrown to the caller.
+ *
+ * @return Whether the thread was pinned
+ */
+template <typename Function>
+bool run_on_cpus(std::span<const unsigned> cpus, Function&& function)
+{
+    bool pinned = false;
+#ifndef CAYENE_NO_EXCEPTIONS
+    std::exception_ptr exception;
+#endif
+    std::thread thread(
+        [&]()
+        {
+            pinned = pin_current_thread(cpus);
+#ifndef CAYENE_NO_EXCEPTIONS
+            try
+            {
+                function();
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+#else
+            function();
+#endif
+        });
+    thread.join();
+#ifndef CAYENE_NO_EXCEPTIONS
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+#endif
+    return pinned;
+}
+
+}  // namespace cayene
+
+#endif  // CAYENE_AFFINITY_HPP
@@ -0,0 +1,439 @@
+#ifndef CAYENE_AGGREGATOR_HPP
+#define CAYENE_AGGREGATOR_HPP
+
+/**
+ * @file aggregator.hpp
+ * @brief Tumbling-window aggregation of decoded records
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "decoder.hpp"
+#include "detail/open_addressing.hpp"
+#include "filter.hpp"
+#include "record.hpp"
+
+namespace cayene
+{
+
+/**
+ * @brief Statistics of one (device, channel, type) over one window
+ *
+ * Values are kept as raw fixed-point integers; the accessors scale them
+ * with the type's divisors.
+ */
+struct WindowAggregate
+{
+    std::uint64_t window_start{0};  ///< First timestamp of the window
+    std::uint32_t device{0};
+    std::uint8_t channel{0};
+    std::uint8_t type_id{0};
+    std::uint8_t value_count{0};
+    std::uint64_t count{0};           ///< Number of records, 0 for an unused slot
+    std::uint64_t last_timestamp{0};  ///< Timestamp of the last record
+    std::array<std::int32_t, kMaxRecordValues> min{};
+    std::array<std::int32_t, kMaxRecordValues> max{};
+    std::array<std::int32_t, kMaxRecordValues> last{};
+    std::array<std::int64_t, kMaxRecordValues> sum{};
+
+    [[nodiscard]] double min_value(std::size_t index = 0) const noexcept
+    {
+        return scale(min[index], index);
+    }
+
+    [[nodiscard]] double max_value(std::size_t index = 0) const noexcept
+    {
+        return scale(max[index], index);
+    }
+
+    [[nodiscard]] double last_value(std::size_t index = 0) const noexcept
+    {
+        return scale(last[index], index);
+    }
+
+    [[nodiscard]] double mean(std::size_t index = 0) const noexcept
+    {
+        return static_cast<double>(sum[index]) / static_cast<double>(count) /
+               standard_value_layout(type_id).divisor[index];
+    }
+
+    /**
+     * @brief Check whether two aggregates cover the same key and window
+     */
+    [[nodiscard]] bool same_key(const WindowAggregate& other) const noexcept
+    {
+        return window_start == other.window_start && device == other.device &&
+               channel == other.channel && type_id == other.type_id;
+    }
+
+    /**
+     * @brief Fold the statistics of the same key from another shard into this one
+     */
+    void merge(const WindowAggregate& other) noexcept
+    {
+        for (std::size_t i = 0; i < value_count; ++i)
+        {
+            min[i] = std::min(min[i], other.min[i]);
+            max[i] = std::max(max[i], other.max[i]);
+            sum[i] += other.sum[i];
+        }
+        if (other.last_timestamp >= last_timestamp)
+        {
+            last = other.last;
+            last_timestamp = other.last_timestamp;
+        }
+        count += other.count;
+    }
+
+private:
+    [[nodiscard]] double scale(std::int32_t raw, std::size_t index) const noexcept
+    {
+        return static_cast<double>(raw) / standard_value_layout(type_id).divisor[index];
+    }
+};
+
+/**
+ * @brief Single-writer aggregation state of one shard
+ *
+ * Accumulates count, min, max, sum and last per (window, device, channel,
+ * type) in an open-addressed table. Timestamps are in any unit the caller
+ * chooses, as long as window_length uses the same one. Records of windows
+ * that were already drained are counted as late and dropped; custom types
+ * carry no typed values and are ignored.
+ *
+ * The table only allocates when it grows.
+ */
+class AggregationShard
+{
+public:
+    /**
+     * @brief Create a shard
+     *
+     * @param window_length Length of a tumbling window; 0 is taken as 1
+     * @param expected_keys Number of (window, device, channel, type) keys to make room for
+     */
+    explicit AggregationShard(std::uint64_t window_length, std::size_t expected_keys = 0)
+        : window_length_(std::max<std::uint64_t>(window_length, 1))
+    {
+        reserve(expected_keys);
+    }
+
+    /**
+     * @brief Fold a record into the window containing a timestamp
+     */
+    void add(std::uint32_t device, std::uint64_t timestamp, const Record& record)
+    {
+        const std::uint64_t window_start = timestamp - (timestamp % window_length_);
+        if (record.value_count == 0)
+        {
+            return;
+        }
+        if (window_start < closed_before_)
+        {
+            ++late_;
+            return;
+        }
+
+        WindowAggregate* slot = find(window_start, device, record.channel, record.type_id);
+        if (slot->count != 0)
+        {
+            for (std::size_t i = 0; i < record.value_count; ++i)
+            {
+                slot->min[i] = std::min(slot->min[i], record.raw[i]);
+                slot->max[i] = std::max(slot->max[i], record.raw[i]);
+                slot->sum[i] += record.raw[i];
+            }
+            if (timestamp >= slot->last_timestamp)
+            {
+                slot->last = record.raw;
+                slot->last_timestamp = timestamp;
+            }
+            ++slot->count;
+            return;
+        }
+
+        // Only inserts can push the table past its load factor
+        if (detail::exceeds_load(size_, slots_.size()))
+        {
+            rehash(slots_.size() * 2);
+            slot = find(window_start, device, record.channel, record.type_id);
+        }
+        *slot = WindowAggregate{};
+        slot->window_start = window_start;
+        slot->device = device;
+        slot->channel = record.channel;
+        slot->type_id = record.type_id;
+        slot->value_count = record.value_count;
+        slot->count = 1;
+        slot->last_timestamp = timestamp;
+        slot->min = record.raw;
+        slot->max = record.raw;
+        slot->last = record.raw;
+        for (std::size_t i = 0; i < record.value_count; ++i)
+        {
+            slot->sum[i] = record.raw[i];
+        }
+        ++size_;
+    }
+
+    /**
+     * @brief Decode a payload and fold every selected record into the shard
+     *
+     * @return Status of the decode, with the number of records decoded
+     */
+    DecodeStatus add_payload(const Decoder& decoder, std::uint32_t device,
+                             std::uint64_t timestamp,
+                             std::span<const std::uint8_t> encoded_payload,
+                             const RecordFilter& filter = {})
+    {
+        return decoder.visit(encoded_payload, filter,
+                             [this, device, timestamp](const Record& record)
+                             { add(device, timestamp, record); });
+    }
+
+    /**
+     * @brief Move the aggregates of every window starting before a limit to an output
+     *
+     * Later records for those windows are counted as late.
+     *
+     * @param window_limit Windows with window_start < window_limit are drained
+     * @param output Receives the aggregates, in no particular order
+     */
+    void drain(std::uint64_t window_limit, std::vector<WindowAggregate>& output)
+    {
+        closed_before_ = std::max(closed_before_, window_limit);
+
+        // Linear probing cannot leave holes, so the remaining entries are reinserted
+        spare_.assign(slots_.size(), WindowAggregate{});
+        spare_.swap(slots_);
+        size_ = 0;
+        for (const WindowAggregate& entry : spare_)
+        {
+            if (entry.count == 0)
+            {
+                continue;
+            }
+            if (entry.window_start < window_limit)
+            {
+                output.push_back(entry);
+            }
+            else
+            {
+                insert(entry);
+            }
+        }
+    }
+
+    /**
+     * @brief Make room for a number of keys without rehashing
+     */
+    void reserve(std::size_t keys)
+    {
+        const std::size_t wanted = detail::capacity_for(keys);
+        if (wanted > slots_.size())
+        {
+            rehash(wanted);
+        }
+    }
+
+    [[nodiscard]] std::uint64_t window_length() const noexcept { return window_length_; }
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] std::uint64_t late_records() const noexcept { return late_; }
+
+private:
+    [[nodiscard]] std::size_t index_of(std::uint64_t window_start, std::uint32_t device,
+                                       std::uint8_t channel, std::uint8_t type_id) const noexcept
+    {
+        const std::uint64_t key = detail::record_key(device, channel, type_id);
+        return detail::slot_index(key ^ (window_start * 0xC2B2AE3D27D4EB4FULL), shift_);
+    }
+
+    // Slot holding a key, or the empty slot where it would be inserted
+    [[nodiscard]] WindowAggregate* find(std::uint64_t window_start, std::uint32_t device,
+                                        std::uint8_t channel, std::uint8_t type_id) noexcept
+    {
+        WindowAggregate* slot = &slots_[index_of(window_start, device, channel, type_id)];
+        while (slot->count != 0 &&
+               (slot->window_start != window_start || slot->device != device ||
+                slot->channel != channel || slot->type_id != type_id))
+        {
+            slot = slot == &slots_.back() ? slots_.data() : slot + 1;
+        }
+        return slot;
+    }
+
+    void insert(const WindowAggregate& entry)
+    {
+        std::size_t index = index_of(entry.window_start, entry.device, entry.channel,
+                                     entry.type_id);
+        while (slots_[index].count != 0)
+        {
+            index = (index + 1) & (slots_.size() - 1);
+        }
+        slots_[index] = entry;
+        ++size_;
+    }
+
+    void rehash(std::size_t capacity)
+    {
+        std::vector<WindowAggregate> previous(capacity);
+        previous.swap(slots_);
+        shift_ = detail::index_shift(capacity);
+        size_ = 0;
+        for (const WindowAggregate& entry : previous)
+        {
+            if (entry.count != 0)
+            {
+                insert(entry);
+            }
+        }
+        spare_.reserve(capacity);
+    }
+
+    std::uint64_t window_length_;
+    std::vector<WindowAggregate> slots_;
+    std::vector<WindowAggregate> spare_;
+    std::size_t size_{0};
+    unsigned shift_{64};
+    std::uint64_t closed_before_{0};
+    std::uint64_t late_{0};
+};
+
+/**
+ * @brief Windowed aggregation split into independently updated shards
+ *
+ * Each shard is meant to be owned by one thread (typically one per core)
+ * and updated through shard(i) without any locking. Closing a window
+ * drains every shard and merges their partial aggregates, so it must not
+ * run concurrently with updates: call it from the shard threads' common
+ * synchronisation point, e.g. between batches.
+ */
+class ShardedAggregator
+{
+public:
+    /**
+     * @brief Create an aggregator
+     *
+     * @param shard_count Number of shards; 0 is taken as 1
+     * @param window_length Length of a tumbling window; 0 is taken as 1
+     * @param expected_keys_per_shard Keys each shard makes room for up front
+     */
+    ShardedAggregator(std::size_t shard_count, std::uint64_t window_length,
+                      std::size_t expected_keys_per_shard = 0)
+    {
+        shard_count = std::max<std::size_t>(shard_count, 1);
+        shards_.reserve(shard_count);
+        for (std::size_t i = 0; i < shard_count; ++i)
+        {
+            shards_.emplace_back(window_length, expected_keys_per_shard);
+        }
+    }
+
+    [[nodiscard]] std::size_t shard_count() const noexcept { return shards_.size(); }
+
+    [[nodiscard]] AggregationShard& shard(std::size_t index) noexcept
+    {
+        return shards_[index].state;
+    }
+
+    /**
+     * @brief Close every window that ended at or before a timestamp
+     *
+     * @param now Current timestamp; the window containing it stays open
+     * @param output Receives one merged aggregate per key, ordered by window,
+     *               device, channel and type
+     * @return Number of aggregates appended
+     */
+    std::size_t close_windows(std::uint64_t now, std::vector<WindowAggregate>& output)
+    {
+        const std::uint64_t window_length = shards_.front().state.window_length();
+        return close_before(now - (now % window_length), output);
+    }
+
+    /**
+     * @brief Close every window, including the current one
+     *
+     * Meant for shutdown: any record added afterwards is late.
+     */
+    std::size_t close_all(std::vector<WindowAggregate>& output)
+    {
+        return close_before(std::numeric_limits<std::uint64_t>::max(), output);
+    }
+
+    /**
+     * @brief Number of records dropped because their window was already closed
+     */
+    [[nodiscard]] std::uint64_t late_records() const noexcept
+    {
+        std::uint64_t late = 0;
+        for (const Shard& shard : shards_)
+        {
+            late += shard.state.late_records();
+        }
+        return late;
+    }
+
+private:
+    // Keep shards on separate cache lines so that their owners do not contend
+    struct alignas(64) Shard
+    {
+        Shard(std::uint64_t window_length, std::size_t expected_keys)
+            : state(window_length, expected_keys)
+        {
+        }
+
+        AggregationShard state;
+    };
+
+    std::size_t close_before(std::uint64_t window_limit, std::vector<WindowAggregate>& output)
+    {
+        const auto first = static_cast<std::ptrdiff_t>(output.size());
+        for (Shard& shard : shards_)
+        {
+            shard.state.drain(window_limit, output);
+        }
+
+        const auto begin = output.begin() + first;
+        std::sort(begin, output.end(),
+                  [](const WindowAggregate& lhs, const WindowAggregate& rhs)
+                  {
+                      return std::tie(lhs.window_start, lhs.device, lhs.channel, lhs.type_id) <
+                             std::tie(rhs.window_start, rhs.device, rhs.channel, rhs.type_id);
+                  });
+
+        auto merged = begin;
+        for (auto it = begin; it != output.end(); ++it)
+        {
+            if (it != begin && merged->same_key(*it))
+            {
+                merged->merge(*it);
+            }
+            else if (it != begin)
+            {
+                *++merged = *it;
+            }
+        }
+        if (begin != output.end())
+        {
+            output.erase(merged + 1, output.end());
+        }
+        return output.size() - static_cast<std::size_t>(first);
+    }
+
+    std::vector<Shard> shards_;
+};
+
+}  // namespace cayene
+
+#endif  // CAYENE_AGGREGATOR_HPP
@@ -0,0 +1,218 @@
+#ifndef CAYENE_ARCHIVE_HPP
+#define CAYENE_ARCHIVE_HPP
+
+/**
+ * @file archive.hpp
+ * @brief Uplink archive format: a flat file of timestamped device payloads
+ *
+ * Layout (version 1, all integers little-endian):
+ *
+ *     "CAYARCH1"                                    8-byte file header
+ *     device u32 | timestamp u64 | size u16 | bytes  one entry per payload
+ *
+ * Entries are written back to back in arrival order, so an archive can be
+ * appended to and replayed with sequential I/O only.
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "pipeline.hpp"
+
+namespace cayene
+{
+
+inline constexpr std::array<std::uint8_t, 8> kArchiveMagic = {'C', 'A', 'Y', 'A',
+                                                              'R', 'C', 'H', '1'};
+
+/**
+ * @brief Size of the header preceding every archived payload
+ */
+inline constexpr std::size_t kArchiveEntryHeaderSize = 14;
+
+/**
+ * @brief Encode the header of one archive entry
+ */
+[[nodiscard]] constexpr std::array<std::uint8_t, kArchiveEntryHeaderSize>
+encode_archive_entry_header(std::uint32_t device, std::uint64_t timestamp,
+                            std::uint16_t size) noexcept
+{
+    std::array<std::uint8_t, kArchiveEntryHeaderSize> header{};
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        header[i] = static_cast<std::uint8_t>(device >> (8 * i));
+    }
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+        header[4 + i] = static_cast<std::uint8_t>(timestamp >> (8 * i));
+    }
+    header[12] = static_cast<std::uint8_t>(size);
+    header[13] = static_cast<std::uint8_t>(size >> 8U);
+    return header;
+}
+
+/**
+ * @brief Append one entry to an in-memory archive
+ *
+ * @return false if the payload is larger than an entry can hold (65535 bytes)
+ */
+inline bool append_archive_entry(std::vector<std::uint8_t>& archive, std::uint32_t device,
+                                 std::uint64_t timestamp, std::span<const std::uint8_t> payload)
+{
+    if (payload.size() > UINT16_MAX)
+    {
+        return false;
+    }
+    if (archive.empty())
+    {
+        archive.insert(archive.end(), kArchiveMagic.begin(), kArchiveMagic.end());
+    }
+    const auto header =
+        encode_archive_entry_header(device, timestamp, static_cast<std::uint16_t>(payload.size()));
+    archive.insert(archive.end(), header.begin(), header.end());
+    archive.insert(archive.end(), payload.begin(), payload.end());
+    return true;
+}
+
+/**
+ * @brief Incremental archive reader over arbitrarily split chunks
+ *
+ * Feed the file contents in order, in chunks of any size (e.g. the buffers
+ * of a UringFileReader); every complete entry is passed to the visitor as
+ * a PayloadRef valid for the duration of the call. Entries that lie within
+ * one chunk are not copied; only an entry split across chunks is
+ * reassembled.
+ */
+class ArchiveParser
+{
+public:
+    /**
+     * @brief Consume the next chunk of the file
+     *
+     * @param visitor Callable invoked as visitor(const PayloadRef&) per entry
+     * @return false if the data is not an archive (bad magic); parsing stops
+     */
+    template <typename Visitor>
+    bool feed(std::span<const std::uint8_t> chunk, Visitor&& visitor)
+    {
+        if (failed_)
+        {
+            return false;
+        }
+        while (!chunk.empty())
+        {
+            if (!pending_.empty() || !header_checked_)
+            {
+                // Reassemble the magic or an entry that straddles chunks
+                const std::size_t wanted = pending_size() - pending_.size();
+                const std::size_t take = std::min(wanted, chunk.size());
+                pending_.insert(pending_.end(), chunk.begin(),
+                                chunk.begin() + static_cast<std::ptrdiff_t>(take));
+                chunk = chunk.subspan(take);
+                if (pending_.size() < pending_size())
+                {
+                    continue;
+                }
+                if (!header_checked_)
+                {
+                    if (!std::equal(kArchiveMagic.begin(), kArchiveMagic.end(), pending_.begin()))
+                    {
+                        failed_ = true;
+                        return false;
+                    }
+                    header_checked_ = true;
+                    pending_.clear();
+                    continue;
+                }
+                if (pending_.size() == kArchiveEntryHeaderSize && entry_size(pending_) != 0)
+                {
+                    continue;  // Header complete, the payload follows
+                }
+                emit(pending_, visitor);
+                pending_.clear();
+                continue;
+            }
+
+            // Fast path: whole entries inside the chunk
+            if (chunk.size() >= kArchiveEntryHeaderSize &&
+                chunk.size() >= kArchiveEntryHeaderSize + entry_size(chunk))
+            {
+                const std::size_t length = kArchiveEntryHeaderSize + entry_size(chunk);
+                emit(chunk.first(length), visitor);
+                chunk = chunk.subspan(length);
+                continue;
+            }
+            pending_.assign(chunk.begin(), chunk.end());
+            chunk = {};
+        }
+        return true;
+    }
+
+    /**
+     * @brief Check the end of the file
+     *
+     * @return true if the input ended on an entry boundary
+     */
+    [[nodiscard]] bool finish() const noexcept
+    {
+        return !failed_ && header_checked_ && pending_.empty();
+    }
+
+    /**
+     * @brief Number of entries read so far
+     */
+    [[nodiscard]] std::uint64_t entries() const noexcept { return entries_; }
+
+private:
+    [[nodiscard]] static std::size_t entry_size(std::span<const std::uint8_t> header) noexcept
+    {
+        return static_cast<std::size_t>(header[12]) | (static_cast<std::size_t>(header[13]) << 8U);
+    }
+
+    // Bytes the pending buffer must hold before it can be acted on
+    [[nodiscard]] std::size_t pending_size() const noexcept
+    {
+        if (!header_checked_)
+        {
+            return kArchiveMagic.size();
+        }
+        if (pending_.size() < kArchiveEntryHeaderSize)
+        {
+            return kArchiveEntryHeaderSize;
+        }
+        return kArchiveEntryHeaderSize + entry_size(pending_);
+    }
+
+    template <typename Visitor>
+    void emit(std::span<const std::uint8_t> entry, Visitor& visitor)
+    {
+        PayloadRef ref;
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            ref.device |= static_cast<std::uint32_t>(entry[i]) << (8 * i);
+        }
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            ref.timestamp |= static_cast<std::uint64_t>(entry[4 + i]) << (8 * i);
+        }
+        ref.payload = entry.subspan(kArchiveEntryHeaderSize);
+        ++entries_;
+        visitor(ref);
+    }
+
+    std::vector<std::uint8_t> pending_;
+    std::uint64_t entries_{0};
+    bool header_checked_{false};
+    bool failed_{false};
+};
+
+}  // namespace cayene
+
+#endif  // CAYENE_ARCHIVE_HPP
@@ -0,0 +1,663 @@
+#ifndef CAYENE_ASYNC_HPP
+#define CAYENE_ASYNC_HPP
+
+/**
+ * @file async.hpp
+ * @brief C++20 coroutine interface: awaitable batch decoding and async sinks
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "affinity.hpp"
+#include "decoder.hpp"
+#include "filter.hpp"
+#include "pipeline.hpp"
+#include "record.hpp"
+
+namespace cayene
+{
+
+template <typename T = void>
+class Task;
+
+namespace detail
+{
+
+class TaskPromiseBase
+{
+public:
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+
+    // Symmetric transfer to the awaiting coroutine, so long chains of
+    // completed tasks do not grow the stack
+    struct FinalAwaiter
+    {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            const std::coroutine_handle<> continuation = handle.promise().continuation_;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+
+    void unhandled_exception() noexcept
+    {
+#ifndef CAYENE_NO_EXCEPTIONS
+        exception_ = std::current_exception();
+#else
+        std::terminate();
+#endif
+    }
+
+    void set_continuation(std::coroutine_handle<> continuation) noexcept
+    {
+        continuation_ = continuation;
+    }
+
+protected:
+    void rethrow_if_failed() const
+    {
+#ifndef CAYENE_NO_EXCEPTIONS
+        if (exception_)
+        {
+            std::rethrow_exception(exception_);
+        }
+#endif
+    }
+
+private:
+    std::coroutine_handle<> continuation_;
+#ifndef CAYENE_NO_EXCEPTIONS
+    std::exception_ptr exception_;
+#endif
+};
+
+template <typename T>
+class TaskPromise final : public TaskPromiseBase
+{
+public:
+    Task<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& value) noexcept(std::is_nothrow_constructible_v<T, U&&>)
+    {
+        value_.emplace(std::forward<U>(value));
+    }
+
+    T result()
+    {
+        rethrow_if_failed();
+        return std::move(*value_);
+    }
+
+private:
+    std::optional<T> value_;
+};
+
+template <>
+class TaskPromise<void> final : public TaskPromiseBase
+{
+public:
+    Task<void> get_return_object() noexcept;
+
+    void return_void() const noexcept {}
+
+    void result() const { rethrow_if_failed(); }
+};
+
+}  // namespace detail
+
+/**
+ * @brief Lazily started coroutine returning a T
+ *
+ * The coroutine starts running when the task is co_awaited, and resumes
+ * its awaiter when it completes. Exceptions propagate to the awaiter.
+ * Use sync_wait() to run a task from ordinary code.
+ */
+template <typename T>
+class [[nodiscard]] Task
+{
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other)
+        {
+            destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { destroy(); }
+
+    auto operator co_await() && noexcept
+    {
+        struct Awaiter
+        {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept { return handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                handle.promise().set_continuation(awaiting);
+                return handle;
+            }
+
+            T await_resume() { return handle.promise().result(); }
+        };
+        return Awaiter{handle_};
+    }
+
+private:
+    friend promise_type;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+    void destroy() noexcept
+    {
+        if (handle_)
+        {
+            handle_.destroy();
+            handle_ = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail
+{
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept
+{
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept
+{
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// Coroutine run by sync_wait(); signals the blocked thread when it completes
+class BlockingTask
+{
+public:
+    struct promise_type
+    {
+        std::mutex* mutex{nullptr};
+        std::condition_variable* finished{nullptr};
+        bool* done{nullptr};
+
+        BlockingTask get_return_object() noexcept
+        {
+            return BlockingTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+
+        auto final_suspend() noexcept
+        {
+            // The waiter destroys the frame once it sees done, which it can
+            // only do after the lock, the last access here, is released
+            struct Signal
+            {
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<promise_type> handle) const noexcept
+                {
+                    const promise_type& promise = handle.promise();
+                    const std::lock_guard lock(*promise.mutex);
+                    *promise.done = true;
+                    promise.finished->notify_all();
+                }
+                void await_resume() const noexcept {}
+            };
+            return Signal{};
+        }
+
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+
+    BlockingTask(BlockingTask&& other) noexcept : handle_(std::exchange(other.handle_, nullptr))
+    {
+    }
+    BlockingTask(const BlockingTask&) = delete;
+    BlockingTask& operator=(const BlockingTask&) = delete;
+    BlockingTask& operator=(BlockingTask&&) = delete;
+
+    ~BlockingTask()
+    {
+        if (handle_)
+        {
+            handle_.destroy();
+        }
+    }
+
+    void run_and_wait()
+    {
+        std::mutex mutex;
+        std::condition_variable finished;
+        bool done = false;
+        handle_.promise().mutex = &mutex;
+        handle_.promise().finished = &finished;
+        handle_.promise().done = &done;
+
+        handle_.resume();
+        std::unique_lock lock(mutex);
+        finished.wait(lock, [&done]() { return done; });
+    }
+
+private:
+    explicit BlockingTask(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+}  // namespace detail
+
+/**
+ * @brief Run a task to completion, blocking the calling thread
+ *
+ * Must not be called from the thread that the task needs to resume on
+ * (e.g. the event loop thread a Scheduler posts to).
+ */
+template <typename T>
+T sync_wait(Task<T> task)
+{
+#ifndef CAYENE_NO_EXCEPTIONS
+    std::exception_ptr exception;
+#endif
+    std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> result;
+
+    auto run = [&]() -> detail::BlockingTask
+    {
+#ifndef CAYENE_NO_EXCEPTIONS
+        try
+        {
+#endif
+            if constexpr (std::is_void_v<T>)
+            {
+                co_await std::move(task);
+                result.emplace(true);
+            }
+            else
+            {
+                result.emplace(co_await std::move(task));
+            }
+#ifndef CAYENE_NO_EXCEPTIONS
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+#endif
+    };
+    run().run_and_wait();
+
+#ifndef CAYENE_NO_EXCEPTIONS
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+#endif
+    if constexpr (!std::is_void_v<T>)
+    {
+        return std::move(*result);
+    }
+}
+
+/**
+ * @brief Decoded records of a batch, in submission order
+ *
+ * Records point into the submitted payload bytes. The batch owns the
+ * record storage and is move-only so that the spans stay valid.
+ */
+class DecodedBatch
+{
+public:
+    DecodedBatch() = default;
+    DecodedBatch(DecodedBatch&&) noexcept = default;
+    DecodedBatch& operator=(DecodedBatch&&) noexcept = default;
+    DecodedBatch(const DecodedBatch&) = delete;
+    DecodedBatch& operator=(const DecodedBatch&) = delete;
+    ~DecodedBatch() = default;
+
+    [[nodiscard]] std::size_t size() const noexcept { return payloads_.size(); }
+    [[nodiscard]] bool empty() const noexcept { return payloads_.empty(); }
+
+    [[nodiscard]] const DecodedPayload& operator[](std::size_t index) const noexcept
+    {
+        return payloads_[index];
+    }
+
+    [[nodiscard]] auto begin() const noexcept { return payloads_.begin(); }
+    [[nodiscard]] auto end() const noexcept { return payloads_.end(); }
+
+    /**
+     * @brief Number of payloads that did not decode cleanly
+     */
+    [[nodiscard]] std::size_t failures() const noexcept
+    {
+        std::size_t failed = 0;
+        for (const DecodedPayload& payload : payloads_)
+        {
+            if (!payload.status.ok())
+            {
+                ++failed;
+            }
+        }
+        return failed;
+    }
+
+    /**
+     * @brief Total records decoded
+     */
+    [[nodiscard]] std::size_t record_count() const noexcept { return records_.size(); }
+
+private:
+    friend class AsyncDecoder;
+
+    void decode(const Decoder& decoder, std::span<const PayloadRef> batch,
+                const RecordFilter& filter)
+    {
+        payloads_.resize(batch.size());
+        std::vector<std::size_t> first(batch.size() + 1, 0);
+        for (std::size_t i = 0; i < batch.size(); ++i)
+        {
+            DecodedPayload& result = payloads_[i];
+            result.device = batch[i].device;
+            result.timestamp = batch[i].timestamp;
+            result.payload = batch[i].payload;
+            first[i] = records_.size();
+            result.status = decoder.visit(batch[i].payload, filter,
+                                          [this](const Record& record)
+                                          { records_.push_back(record); });
+        }
+        // Spans are taken once the record storage stops growing
+        first[batch.size()] = records_.size();
+        for (std::size_t i = 0; i < batch.size(); ++i)
+        {
+            payloads_[i].records =
+                std::span<const Record>(records_).subspan(first[i], first[i + 1] - first[i]);
+        }
+    }
+
+    std::vector<DecodedPayload> payloads_;
+    std::vector<Record> records_;
+};
+
+/**
+ * @brief Destination of decoded batches that may suspend, e.g. on network I/O
+ */
+class AsyncSink
+{
+public:
+    virtual ~AsyncSink() = default;
+
+    /**
+     * @brief Receive a batch; the batch stays valid until the task completes
+     */
+    virtual Task<> consume(const DecodedBatch& batch) = 0;
+};
+
+/**
+ * @brief Decodes batches on background threads for coroutine callers
+ *
+ * co_await decode_async(batch) suspends the caller, decodes the batch on
+ * one of the decoder's threads and resumes the caller through the
+ * Scheduler, typically the event loop's post(), so the reactor thread
+ * never runs a decode. Without a scheduler the caller resumes on the
+ * decode thread.
+ *
+ * An exception thrown while decoding (e.g. bad_alloc) is rethrown from the
+ * co_await. So is one thrown by the scheduler, in which case the caller
+ * resumes on the decode thread instead.
+ *
+ * Batches are the unit of work: each is decoded by a single thread, and
+ * batches complete in no particular order when there are several threads.
+ */
+class AsyncDecoder
+{
+public:
+    using Scheduler = std::function<void(std::coroutine_handle<>)>;
+
+    /**
+     * @brief Awaitable returned by decode_async()
+     */
+    class DecodeOperation
+    {
+    public:
+        bool await_ready() const noexcept { return batch_.empty(); }
+
+        void await_suspend(std::coroutine_handle<> awaiting)
+        {
+            awaiting_ = awaiting;
+            decoder_.enqueue(this);
+        }
+
+        DecodedBatch await_resume()
+        {
+#ifndef CAYENE_NO_EXCEPTIONS
+            if (exception_)
+            {
+                std::rethrow_exception(exception_);
+            }
+#endif
+            return std::move(result_);
+        }
+
+    private:
+        friend class AsyncDecoder;
+
+        DecodeOperation(AsyncDecoder& decoder, std::span<const PayloadRef> batch,
+                        const RecordFilter& filter) noexcept
+            : decoder_(decoder), batch_(batch), filter_(filter)
+        {
+        }
+
+        AsyncDecoder& decoder_;
+        std::span<const PayloadRef> batch_;
+        RecordFilter filter_;
+        DecodedBatch result_;
+        std::coroutine_handle<> awaiting_;
+#ifndef CAYENE_NO_EXCEPTIONS
+        std::exception_ptr exception_;  ///< Thrown on the decode thread, rethrown to the awaiter
+#endif
+    };
+
+    /**
+     * @brief Start the decode threads
+     *
+     * @param decoder Decoder shared by the threads; must not be modified while in use
+     * @param threads Number of decode threads, at least 1
+     * @param scheduler Resumes an awaiting coroutine on the caller's event loop
+     * @param placement Pinning of the decode threads, spread over the NUMA nodes
+     *                  like Pipeline workers
+     */
+    explicit AsyncDecoder(const Decoder& decoder, std::size_t threads = 1,
+                          Scheduler scheduler = {},
+                          CpuPlacement placement = CpuPlacement::None)
+        : decoder_(decoder), scheduler_(std::move(scheduler))
+    {
+        threads = threads == 0 ? 1 : threads;
+        const CpuTopology topology =
+            placement == CpuPlacement::None ? CpuTopology{} : CpuTopology::detect();
+        for (std::size_t i = 0; i < threads; ++i)
+        {
+            threads_.emplace_back(
+                [this, cpus = topology.cpus_for(i, threads, placement)]()
+                {
+                    if (!cpus.empty() && !pin_current_thread(cpus))
+                    {
+                        unpinned_.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    run();
+                });
+        }
+    }
+
+    AsyncDecoder(const AsyncDecoder&) = delete;
+    AsyncDecoder& operator=(const AsyncDecoder&) = delete;
+
+    /**
+     * @brief Finish the queued batches and join the threads
+     */
+    ~AsyncDecoder()
+    {
+        {
+            const std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        ready_.notify_all();
+        for (std::thread& thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    /**
+     * @brief Decode a batch off the calling thread
+     *
+     * The batch and its payload bytes must stay valid until the returned
+     * batch is destroyed.
+     */
+    [[nodiscard]] DecodeOperation decode_async(std::span<const PayloadRef> batch,
+                                               const RecordFilter& filter = {}) noexcept
+    {
+        return DecodeOperation(*this, batch, filter);
+    }
+
+    /**
+     * @brief Decode a batch and hand it to an async sink
+     *
+     * @return Number of payloads in the batch that did not decode cleanly
+     */
+    Task<std::size_t> decode_to(std::span<const PayloadRef> batch, AsyncSink& sink,
+                                RecordFilter filter = {})
+    {
+        const DecodedBatch decoded = co_await decode_async(batch, filter);
+        co_await sink.consume(decoded);
+        co_return decoded.failures();
+    }
+
+    [[nodiscard]] std::size_t thread_count() const noexcept { return threads_.size(); }
+
+    /**
+     * @brief Decode threads that could not be pinned as requested
+     */
+    [[nodiscard]] std::size_t unpinned_count() const noexcept
+    {
+        return unpinned_.load(std::memory_order_relaxed);
+    }
+
+private:
+    void enqueue(DecodeOperation* operation)
+    {
+        {
+            const std::lock_guard lock(mutex_);
+            queue_.push_back(operation);
+        }
+        ready_.notify_one();
+    }
+
+    void run()
+    {
+        while (true)
+        {
+            DecodeOperation* operation = nullptr;
+            {
+                std::unique_lock lock(mutex_);
+                ready_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+                if (queue_.empty())
+                {
+                    return;
+                }
+                operation = queue_.front();
+                queue_.pop_front();
+            }
+
+#ifndef CAYENE_NO_EXCEPTIONS
+            // Failures (e.g. bad_alloc growing the records) go to the awaiter, like Task's
+            try
+            {
+                operation->result_.decode(decoder_, operation->batch_, operation->filter_);
+            }
+            catch (...)
+            {
+                operation->exception_ = std::current_exception();
+            }
+            if (scheduler_)
+            {
+                try
+                {
+                    scheduler_(operation->awaiting_);
+                    continue;
+                }
+                catch (...)
+                {
+                    // Not scheduled: report the failure by resuming here instead
+                    if (!operation->exception_)
+                    {
+                        operation->exception_ = std::current_exception();
+                    }
+                }
+            }
+            operation->awaiting_.resume();
+#else
+            operation->result_.decode(decoder_, operation->batch_, operation->filter_);
+            if (scheduler_)
+            {
+                scheduler_(operation->awaiting_);
+            }
+            else
+            {
+                operation->awaiting_.resume();
+            }
+#endif
+        }
+    }
+
+    const Decoder& decoder_;
+    Scheduler scheduler_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<DecodeOperation*> queue_;
+    bool stopping_{false};
+    std::atomic<std::size_t> unpinned_{0};
+    std::vector<std::thread> threads_;
+};
+
+}  // namespace cayene
+
+#endif  // CAYENE_ASYNC_HPP
@@ -0,0 +1,194 @@
+#ifndef CAYENE_C_API_H
+#define CAYENE_C_API_H
+
+/**
+ * @file c_api.h
+ * @brief C ABI for the Cayene Decoder library
+ *
+ * Plain C interface for FFI callers (Go, Rust, Python ctypes...). Decoders
+ * are opaque handles, every call reports a cayene_status, and all output
+ * goes into caller-provided record arrays or text buffers, so nothing
+ * allocated by the library crosses the boundary. The batch entry points
+ * decode many payloads per call to amortize the FFI overhead.
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Opaque decoder handle
+ */
+typedef struct cayene_decoder cayene_decoder;
+
+/**
+ * @brief Status codes, matching cayene::ErrorCode for the shared values
+ */
+typedef enum cayene_status
+{
+    CAYENE_OK = 0,
+    CAYENE_PAYLOAD_EMPTY = 1,
+    CAYENE_UNKNOWN_DATA_TYPE = 2,
+    CAYENE_BAD_PAYLOAD_FORMAT = 3,
+    CAYENE_UNEXPECTED = 4,
+    CAYENE_BUFFER_TOO_SMALL = 5,
+    CAYENE_INVALID_ARGUMENT = 6
+} cayene_status;
+
+/**
+ * @brief A decoded record
+ *
+ * Standard types carry their raw fixed-point values and the scaled values;
+ * custom types only expose where their bytes are (value_count is 0).
+ */
+typedef struct cayene_record
+{
+    uint8_t channel;
+    uint8_t type_id;
+    uint8_t value_count;
+    uint8_t reserved;
+    uint32_t data_size;   /**< Number of data bytes */
+    uint64_t data_offset; /**< Offset of the record data within the input buffer */
+    int32_t raw[3];
+    double value[3];
+} cayene_record;
+
+/**
+ * @brief Outcome of a single-payload call
+ */
+typedef struct cayene_result
+{
+    cayene_status status;
+    uint8_t type_id; /**< Type id of the failing record, if any */
+    size_t offset;   /**< Byte offset of the failing record, or payload size on success */
+    size_t count;    /**< Records produced (bytes written for text output) */
+} cayene_result;
+
+/**
+ * @brief Outcome of a batch call
+ *
+ * A batch stops early only when the output buffer is full; payloads that
+ * fail to decode are reported per payload and produce no output.
+ */
+typedef struct cayene_batch_result
+{
+    cayene_status status; /**< CAYENE_OK, CAYENE_BUFFER_TOO_SMALL or CAYENE_INVALID_ARGUMENT */
+    size_t payloads;      /**< Payloads processed; resume from this index after BUFFER_TOO_SMALL */
+    size_t produced;      /**< Records (or bytes) written */
+    size_t failed;        /**< Processed payloads that failed to decode */
+} cayene_batch_result;
+
+/**
+ * @brief Custom type decoder callback
+ *
+ * Writes the JSON text for one value into json_out and returns its length.
+ * If the returned length exceeds json_capacity the callback is invoked again
+ * with a larger buffer. Only used by the JSON output functions.
+ */
+typedef size_t (*cayene_custom_decode_fn)(void* user_data, const uint8_t* data, size_t size,
+                                          char* json_out, size_t json_capacity);
+
+/**
+ * @brief Create a decoder with all standard types registered
+ *
+ * @return The decoder, or NULL on allocation failure
+ */
+cayene_decoder* cayene_decoder_new(void);
+
+/**
+ * @brief Destroy a decoder (NULL is ignored)
+ */
+void cayene_decoder_free(cayene_decoder* decoder);
+
+/**
+ * @brief Register a custom data type
+ *
+ * @return CAYENE_OK, or CAYENE_INVALID_ARGUMENT if the id is taken, the size is 0
+ *         or the callback is NULL
+ */
+cayene_status cayene_decoder_add_custom_type(cayene_decoder* decoder, uint8_t type_id,
+                                             const char* name, size_t size,
+                                             cayene_custom_decode_fn decode_fn, void* user_data);
+
+/**
+ * @brief Remove a custom data type
+ *
+ * @return 1 if removed, 0 if it was a standard type or did not exist
+ */
+int cayene_decoder_remove_custom_type(cayene_decoder* decoder, uint8_t type_id);
+
+/**
+ * @brief Check if a data type is registered
+ *
+ * @return 1 if registered, 0 otherwise
+ */
+int cayene_decoder_has_type(const cayene_decoder* decoder, uint8_t type_id);
+
+/**
+ * @brief Get a short description of a status code
+ */
+const char* cayene_status_message(cayene_status status);
+
+/**
+ * @brief Check that a payload is well formed
+ */
+cayene_result cayene_validate(const cayene_decoder* decoder, const uint8_t* payload,
+                              size_t payload_size);
+
+/**
+ * @brief Decode a payload into a caller-provided record array
+ */
+cayene_result cayene_decode_records(const cayene_decoder* decoder, const uint8_t* payload,
+                                    size_t payload_size, cayene_record* records,
+                                    size_t record_capacity);
+
+/**
+ * @brief Decode a payload into a caller-provided JSON text buffer (not NUL-terminated)
+ */
+cayene_result cayene_decode_json(const cayene_decoder* decoder, const uint8_t* payload,
+                                 size_t payload_size, char* json_out, size_t json_capacity);
+
+/**
+ * @brief Decode many payloads into one record array
+ *
+ * Payload i spans data[payload_offsets[i], payload_offsets[i + 1]), so
+ * payload_offsets holds payload_count + 1 entries. Record data offsets are
+ * relative to data.
+ *
+ * @param record_offsets Optional, payload_count + 1 entries: records of payload i are
+ *        records[record_offsets[i], record_offsets[i + 1])
+ * @param statuses Optional, payload_count entries receiving each payload's status
+ */
+cayene_batch_result cayene_decode_records_batch(const cayene_decoder* decoder,
+                                                const uint8_t* data,
+                                                const size_t* payload_offsets,
+                                                size_t payload_count, cayene_record* records,
+                                                size_t record_capacity, size_t* record_offsets,
+                                                cayene_status* statuses);
+
+/**
+ * @brief Decode many payloads into newline-delimited JSON
+ *
+ * Same input layout as cayene_decode_records_batch. Each successfully
+ * decoded payload appends one JSON object followed by '\n'.
+ *
+ * @param text_offsets Optional, payload_count + 1 entries: the text of payload i is
+ *        json_out[text_offsets[i], text_offsets[i + 1]) (empty if it failed)
+ * @param statuses Optional, payload_count entries receiving each payload's status
+ */
+cayene_batch_result cayene_decode_json_batch(const cayene_decoder* decoder, const uint8_t* data,
+                                             const size_t* payload_offsets, size_t payload_count,
+                                             char* json_out, size_t json_capacity,
+                                             size_t* text_offsets, cayene_status* statuses);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CAYENE_C_API_H
@@ -0,0 +1,259 @@
+#ifndef CAYENE_CHANGE_FILTER_HPP
+#define CAYENE_CHANGE_FILTER_HPP
+
+/**
+ * @file change_filter.hpp
+ * @brief Report-on-change suppression of repeated record values
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "decoder.hpp"
+#include "detail/open_addressing.hpp"
+#include "filter.hpp"
+#include "record.hpp"
+
+namespace cayene
+{
+
+/**
+ * @brief Counters of a ChangeFilter
+ */
+struct ChangeStats
+{
+    std::uint64_t emitted{0};     ///< Records reported as changed (including first sightings)
+    std::uint64_t suppressed{0};  ///< Records dropped as repeats
+};
+
+/**
+ * @brief Stateful filter passing only records whose value changed
+ *
+ * Keeps the last reported raw values of every (device, channel, type) seen
+ * in an open-addressed table with linear probing. A record is reported when
+ * its key is new or when any of its raw values differs from the last
+ * reported one by more than the deadband of its type; otherwise it is
+ * suppressed and the stored values are left alone, so slow drift is still
+ * reported once it exceeds the deadband.
+ *
+ * Values are compared as raw fixed-point integers before scaling, so a
+ * deadband is given in the type's wire units (e.g. 5 for 0.5 °C on
+ * temperature). Custom types carry no typed values and are always reported.
+ *
+ * The table only allocates when it grows; reserve() the expected number of
+ * keys to keep steady-state filtering allocation-free. Not thread-safe.
+ */
+class ChangeFilter
+{
+public:
+    /**
+     * @brief Create a filter with room for a number of keys
+     */
+    explicit ChangeFilter(std::size_t expected_keys = 0) { reserve(expected_keys); }
+
+    /**
+     * @brief Set the deadband of a type, in raw units (0 reports any change)
+     */
+    ChangeFilter& set_deadband(std::uint8_t type_id, std::uint32_t raw_deadband) noexcept
+    {
+        deadband_[type_id] = raw_deadband;
+        return *this;
+    }
+
+    /**
+     * @brief Set the same deadband for every type
+     */
+    ChangeFilter& set_deadband(std::uint32_t raw_deadband) noexcept
+    {
+        deadband_.fill(raw_deadband);
+        return *this;
+    }
+
+    [[nodiscard]] std::uint32_t deadband(std::uint8_t type_id) const noexcept
+    {
+        return deadband_[type_id];
+    }
+
+    /**
+     * @brief Check a record against the stored state, updating it when reported
+     *
+     * @param device Caller-defined device identifier
+     * @param record Decoded record
+     * @return true if the record should be reported
+     */
+    bool update(std::uint32_t device, const Record& record)
+    {
+        if (record.value_count == 0)
+        {
+            ++stats_.emitted;
+            return true;
+        }
+
+        const std::uint64_t key = make_key(device, record.channel, record.type_id);
+        Slot* slot = find(key);
+        if (slot->key != key)
+        {
+            // Only inserts can push the table past its load factor
+            if (detail::exceeds_load(size_, slots_.size()))
+            {
+                grow();
+                slot = find(key);
+            }
+            slot->key = key;
+            slot->raw = record.raw;
+            ++size_;
+            ++stats_.emitted;
+            return true;
+        }
+
+        const std::int64_t deadband = deadband_[record.type_id];
+        for (std::size_t i = 0; i < record.value_count; ++i)
+        {
+            const std::int64_t delta = std::int64_t{record.raw[i]} - slot->raw[i];
+            if (delta > deadband || -delta > deadband)
+            {
+                slot->raw = record.raw;
+                ++stats_.emitted;
+                return true;
+            }
+        }
+        ++stats_.suppressed;
+        return false;
+    }
+
+    /**
+     * @brief Decode a payload and call a visitor for each changed record
+     *
+     * @param decoder Decoder used to walk the payload
+     * @param device Device that sent the payload
+     * @param encoded_payload The raw payload bytes
+     * @param visitor Callable invoked as visitor(const Record&)
+     * @return Status of the decode, with the number of records decoded
+     */
+    template <typename Visitor>
+    DecodeStatus visit_changes(const Decoder& decoder, std::uint32_t device,
+                               std::span<const std::uint8_t> encoded_payload, Visitor&& visitor)
+    {
+        return visit_changes(decoder, device, encoded_payload, RecordFilter{},
+                             std::forward<Visitor>(visitor));
+    }
+
+    /**
+     * @brief Decode the records selected by a filter and visit the changed ones
+     */
+    template <typename Visitor>
+    DecodeStatus visit_changes(const Decoder& decoder, std::uint32_t device,
+                               std::span<const std::uint8_t> encoded_payload,
+                               const RecordFilter& filter, Visitor&& visitor)
+    {
+        return decoder.visit(encoded_payload, filter,
+                             [this, device, &visitor](const Record& record)
+                             {
+                                 if (update(device, record))
+                                 {
+                                     visitor(record);
+                                 }
+                             });
+    }
+
+    /**
+     * @brief Make room for a number of keys without rehashing
+     */
+    void reserve(std::size_t keys)
+    {
+        const std::size_t wanted = detail::capacity_for(keys);
+        if (wanted > slots_.size())
+        {
+            rehash(wanted);
+        }
+    }
+
+    /**
+     * @brief Forget all stored values; the next record of every key is reported
+     */
+    void clear() noexcept
+    {
+        for (Slot& slot : slots_)
+        {
+            slot.key = kEmpty;
+        }
+        size_ = 0;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] std::size_t capacity() const noexcept { return slots_.size(); }
+    [[nodiscard]] const ChangeStats& stats() const noexcept { return stats_; }
+    void reset_stats() noexcept { stats_ = {}; }
+
+private:
+    struct Slot
+    {
+        std::uint64_t key{0};
+        std::array<std::int32_t, kMaxRecordValues> raw{};
+    };
+
+    static constexpr std::uint64_t kEmpty = detail::kEmptyKey;
+
+    [[nodiscard]] static constexpr std::uint64_t make_key(std::uint32_t device,
+                                                          std::uint8_t channel,
+                                                          std::uint8_t type_id) noexcept
+    {
+        return detail::record_key(device, channel, type_id);
+    }
+
+    [[nodiscard]] std::size_t index_of(std::uint64_t key) const noexcept
+    {
+        return detail::slot_index(key, shift_);
+    }
+
+    // Slot holding key, or the empty slot where it would be inserted
+    [[nodiscard]] Slot* find(std::uint64_t key) noexcept
+    {
+        Slot* slot = &slots_[index_of(key)];
+        while (slot->key != key && slot->key != kEmpty)
+        {
+            slot = slot == &slots_.back() ? slots_.data() : slot + 1;
+        }
+        return slot;
+    }
+
+    void grow() { rehash(slots_.empty() ? 16 : slots_.size() * 2); }
+
+    void rehash(std::size_t capacity)
+    {
+        std::vector<Slot> previous(capacity);
+        previous.swap(slots_);
+        shift_ = detail::index_shift(capacity);
+        for (const Slot& slot : previous)
+        {
+            if (slot.key == kEmpty)
+            {
+                continue;
+            }
+            std::size_t index = index_of(slot.key);
+            while (slots_[index].key != kEmpty)
+            {
+                index = (index + 1) & (capacity - 1);
+            }
+            slots_[index] = slot;
+        }
+    }
+
+    std::vector<Slot> slots_;
+    std::size_t size_{0};
+    unsigned shift_{64};
+    std::array<std::uint32_t, 256> deadband_{};
+    ChangeStats stats_;
+};
+
+}  // namespace cayene
+
+#endif  // CAYENE_CHANGE_FILTER_HPP
@@ -0,0 +1,489 @@
+#ifndef CAYENE_DEAD_LETTER_HPP
+#define CAYENE_DEAD_LETTER_HPP
+
+/**
+ * @file dead_letter.hpp
+ * @brief Dead-letter capture of payloads that failed to decode
+ *
+ * File layout (version 1, all integers little-endian):
+ *
+ *     "CAYDEAD1"                                          8-byte file header
+ *     length u32 | device u32 | timestamp u64 | code u8 |  one entry per failure;
+ *     type_id u8 | offset u16 | payload_size u32 | bytes   length counts from device on
+ *
+ * bytes holds the first kMaxPipelinePayload bytes of the payload, so
+ * payload_size may exceed their number. A queue writes the file header
+ * when it starts; read_dead_letters() skips repeated headers, so several
+ * runs may append to the same file.
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "error.hpp"
+#include "pipeline.hpp"
+#include "spsc_ring.hpp"
+
+namespace cayene
+{
+
+inline constexpr std::array<std::uint8_t, 8> kDeadLetterMagic = {'C', 'A', 'Y', 'D',
+                                                                 'E', 'A', 'D', '1'};
+
+/**
+ * @brief Bytes of an entry from device through payload_size (the length field excluded)
+ */
+inline constexpr std::size_t kDeadLetterHeaderSize = 20;
+
+/**
+ * @brief One failed payload, as read back from a dead-letter file
+ */
+struct DeadLetterRecord
+{
+    std::uint32_t device{0};
+    std::uint64_t timestamp{0};
+    ErrorCode code{ErrorCode::Ok};
+    std::uint8_t type_id{0};                ///< Type id of the failing record, if any
+    std::uint16_t offset{0};                ///< Byte offset of the failing record
+    std::uint32_t payload_size{0};          ///< Size of the original payload
+    std::span<const std::uint8_t> payload;  ///< Captured bytes (possibly a prefix)
+};
+
+/**
+ * @brief Read every entry of a dead-letter file held in memory
+ *
+ * @param visitor Callable invoked as visitor(const DeadLetterRecord&)
+ * @return false if the data is not a dead-letter file or ends mid-entry
+ */
+template <typename Visitor>
+bool read_dead_letters(std::span<const std::uint8_t> file, Visitor&& visitor)
+{
+    auto read = [](std::span<const std::uint8_t> bytes, std::size_t size)
+    {
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            value |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+        }
+        return value;
+    };
+    auto at_magic = [&file]()
+    {
+        return file.size() >= kDeadLetterMagic.size() &&
+               std::equal(kDeadLetterMagic.begin(), kDeadLetterMagic.end(), file.begin());
+    };
+
+    if (!at_magic())
+    {
+        return false;
+    }
+    while (!file.empty())
+    {
+        if (at_magic())
+        {
+            file = file.subspan(kDeadLetterMagic.size());
+            continue;
+        }
+        if (file.size() < 4)
+        {
+            return false;
+        }
+        const auto length = static_cast<std::size_t>(read(file, 4));
+        if (length < kDeadLetterHeaderSize || file.size() - 4 < length)
+        {
+            return false;
+        }
+        const std::span<const std::uint8_t> entry = file.subspan(4, length);
+        DeadLetterRecord record;
+        record.device = static_cast<std::uint32_t>(read(entry, 4));
+        record.timestamp = read(entry.subspan(4), 8);
+        record.code = static_cast<ErrorCode>(entry[12]);
+        record.type_id = entry[13];
+        record.offset = static_cast<std::uint16_t>(read(entry.subspan(14), 2));
+        record.payload_size = static_cast<std::uint32_t>(read(entry.subspan(16), 4));
+        record.payload = entry.subspan(kDeadLetterHeaderSize);
+        visitor(record);
+        file = file.subspan(4 + length);
+    }
+    return true;
+}
+
+/**
+ * @brief Sizing and admission limits of a DeadLetterQueue
+ */
+struct DeadLetterConfig
+{
+    std::size_t threads{1};           ///< Capturing threads, each using its own index
+    std::size_t ring_capacity{256};   ///< Failures buffered per thread before dropping
+    std::uint32_t sample_every{1};    ///< Keep one failure in N per thread (1 keeps all)
+    std::uint32_t max_per_second{0};  ///< Failures kept per thread and second (0: no limit)
+    std::chrono::milliseconds flush_interval{50};  ///< How often the spill thread drains
+};
+
+/**
+ * @brief Counters of a dead-letter queue, summed over threads
+ */
+struct DeadLetterStats
+{
+    std::uint64_t failures{0};      ///< Failed payloads offered
+    std::uint64_t sampled_out{0};   ///< ... skipped by sampling
+    std::uint64_t rate_limited{0};  ///< ... skipped by the rate limit
+    std::uint64_t dropped{0};       ///< ... lost to a full ring, a bad thread index or the file
+    std::uint64_t written{0};       ///< Entries written to the file
+    std::uint64_t write_errors{0};  ///< Spill passes that failed to write (at most one)
+};
+
+/**
+ * @brief Captures failed payloads into per-thread rings spilled to a file
+ *
+ * Decoding threads offer() every status they get; successful ones return
+ * at once. A failure that passes sampling and the rate limit is copied,
+ * with its device, error code, offset and type id, into the calling
+ * thread's lock-free SPSC ring. A background spill thread drains the rings
+ * every flush_interval and appends length-prefixed entries to the output.
+ *
+ * Nothing on the decode side blocks, allocates or takes a lock: when a
+ * ring is full the failure is counted as dropped. Each thread index must
+ * be used by one thread at a time (e.g. a pipeline worker index).
+ *
+ * A failed write may leave the file ending mid-entry, so the queue stops
+ * writing after the first one: the entries of that pass and every later
+ * failure are counted as dropped.
+ */
+class DeadLetterQueue
+{
+public:
+    /**
+     * @param out Destination, typically a std::ofstream opened in binary
+     *            mode; must outlive the queue and is only written by it
+     * @param config Thread count, ring size and admission limits
+     */
+    explicit DeadLetterQueue(std::ostream& out, const DeadLetterConfig& config = {})
+        : out_(out), config_(config)
+    {
+        config_.threads = std::max<std::size_t>(config_.threads, 1);
+        config_.sample_every = std::max<std::uint32_t>(config_.sample_every, 1);
+        threads_ = std::make_unique<ThreadState[]>(config_.threads);
+        for (std::size_t i = 0; i < config_.threads; ++i)
+        {
+            rings_.push_back(std::make_unique<SpscRing<Letter>>(config_.ring_capacity));
+        }
+        out_.write(reinterpret_cast<const char*>(kDeadLetterMagic.data()),
+                   static_cast<std::streamsize>(kDeadLetterMagic.size()));
+        spill_thread_ = std::thread([this]() { spill(); });
+    }
+
+    DeadLetterQueue(const DeadLetterQueue&) = delete;
+    DeadLetterQueue& operator=(const DeadLetterQueue&) = delete;
+
+    /**
+     * @brief Write out everything captured and stop the spill thread
+     *
+     * Capturing threads must have stopped offering.
+     */
+    ~DeadLetterQueue()
+    {
+        {
+            const std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        spill_thread_.join();
+    }
+
+    /**
+     * @brief Capture a payload if its decode failed
+     *
+     * @param thread Index of the calling thread, below config.threads
+     * @return true if the failure was queued for the file
+     */
+    bool offer(std::size_t thread, std::uint32_t device, std::uint64_t timestamp,
+               std::span<const std::uint8_t> payload, const DecodeStatus& status) noexcept
+    {
+        if (status.ok())
+        {
+            return false;
+        }
+        if (thread >= config_.threads)
+        {
+            invalid_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return capture(thread, device, timestamp, payload, status);
+    }
+
+    /**
+     * @brief Wait until everything offered so far is written and flushed
+     */
+    void flush()
+    {
+        std::unique_lock lock(mutex_);
+        const std::uint64_t ticket = ++flush_requested_;
+        wake_.notify_all();
+        flushed_.wait(lock, [this, ticket]() { return flush_completed_ >= ticket; });
+    }
+
+    /**
+     * @brief Snapshot of the counters; safe to call at any time
+     */
+    [[nodiscard]] DeadLetterStats stats() const noexcept
+    {
+        DeadLetterStats stats;
+        for (std::size_t i = 0; i < config_.threads; ++i)
+        {
+            const ThreadState& state = threads_[i];
+            stats.failures += state.failures.load(std::memory_order_relaxed);
+            stats.sampled_out += state.sampled_out.load(std::memory_order_relaxed);
+            stats.rate_limited += state.rate_limited.load(std::memory_order_relaxed);
+            stats.dropped += state.dropped.load(std::memory_order_relaxed);
+        }
+        stats.dropped += invalid_.load(std::memory_order_relaxed);
+        stats.dropped += lost_.load(std::memory_order_relaxed);
+        stats.written = written_.load(std::memory_order_relaxed);
+        stats.write_errors = write_errors_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    [[nodiscard]] std::size_t thread_count() const noexcept { return config_.threads; }
+
+private:
+    struct Letter
+    {
+        std::uint64_t timestamp{0};
+        std::uint32_t device{0};
+        std::uint32_t payload_size{0};
+        std::uint16_t offset{0};
+        ErrorCode code{ErrorCode::Ok};
+        std::uint8_t type_id{0};
+        std::uint16_t size{0};
+        std::array<std::uint8_t, kMaxPipelinePayload> bytes{};
+    };
+
+    // Counters written by the owning thread only, read by stats()
+    struct alignas(64) ThreadState
+    {
+        std::atomic<std::uint64_t> failures{0};
+        std::atomic<std::uint64_t> sampled_out{0};
+        std::atomic<std::uint64_t> rate_limited{0};
+        std::atomic<std::uint64_t> dropped{0};
+        std::chrono::steady_clock::time_point window{};
+        std::uint32_t window_count{0};
+    };
+
+    static void bump(std::atomic<std::uint64_t>& counter) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    bool capture(std::size_t thread, std::uint32_t device, std::uint64_t timestamp,
+                 std::span<const std::uint8_t> payload, const DecodeStatus& status) noexcept
+    {
+        ThreadState& state = threads_[thread];
+        const std::uint64_t seen = state.failures.load(std::memory_order_relaxed);
+        bump(state.failures);
+        if (seen % config_.sample_every != 0)
+        {
+            bump(state.sampled_out);
+            return false;
+        }
+        if (config_.max_per_second != 0)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            if (now - state.window >= std::chrono::seconds(1))
+            {
+                state.window = now;
+                state.window_count = 0;
+            }
+            if (state.window_count == config_.max_per_second)
+            {
+                bump(state.rate_limited);
+                return false;
+            }
+            ++state.window_count;
+        }
+
+        SpscRing<Letter>& ring = *rings_[thread];
+        Letter* letter = ring.claim();
+        if (letter == nullptr)
+        {
+            bump(state.dropped);
+            return false;
+        }
+        letter->timestamp = timestamp;
+        letter->device = device;
+        letter->payload_size = static_cast<std::uint32_t>(payload.size());
+        letter->offset = static_cast<std::uint16_t>(std::min<std::size_t>(status.offset, 0xFFFF));
+        letter->code = status.code;
+        letter->type_id = status.type_id;
+        letter->size = static_cast<std::uint16_t>(std::min(payload.size(), kMaxPipelinePayload));
+        if (letter->size != 0)
+        {
+            std::memcpy(letter->bytes.data(), payload.data(), letter->size);
+        }
+        ring.publish();
+        return true;
+    }
+
+    // Appends every buffered letter to the output; returns false on a write error
+    bool drain(std::vector<std::uint8_t>& buffer)
+    {
+        if (failed_)
+        {
+            discard();
+            return true;
+        }
+
+        auto put = [&buffer](std::uint64_t value, std::size_t size)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                buffer.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+            }
+        };
+
+        std::uint64_t entries = 0;
+        buffer.clear();
+        for (const auto& ring : rings_)
+        {
+            for (const Letter* letter = ring->front(); letter != nullptr; letter = ring->front())
+            {
+                put(kDeadLetterHeaderSize + letter->size, 4);
+                put(letter->device, 4);
+                put(letter->timestamp, 8);
+                put(static_cast<std::uint8_t>(letter->code), 1);
+                put(letter->type_id, 1);
+                put(letter->offset, 2);
+                put(letter->payload_size, 4);
+                buffer.insert(buffer.end(), letter->bytes.begin(),
+                              letter->bytes.begin() + letter->size);
+                ring->pop();
+                ++entries;
+            }
+        }
+        if (entries == 0)
+        {
+            return true;
+        }
+        out_.write(reinterpret_cast<const char*>(buffer.data()),
+                   static_cast<std::streamsize>(buffer.size()));
+        out_.flush();
+        if (!out_)
+        {
+            failed_ = true;
+            lost_.fetch_add(entries, std::memory_order_relaxed);
+            return false;
+        }
+        written_.fetch_add(entries, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Empties the rings without writing, once the output has failed
+    void discard() noexcept
+    {
+        std::uint64_t entries = 0;
+        for (const auto& ring : rings_)
+        {
+            for (; ring->front() != nullptr; ring->pop())
+            {
+                ++entries;
+            }
+        }
+        lost_.fetch_add(entries, std::memory_order_relaxed);
+    }
+
+    void spill()
+    {
+        std::vector<std::uint8_t> buffer;
+        std::unique_lock lock(mutex_);
+        while (true)
+        {
+            wake_.wait_for(lock, config_.flush_interval,
+                           [this]() { return stopping_ || flush_requested_ > flush_completed_; });
+            const bool stopping = stopping_;
+            const std::uint64_t requested = flush_requested_;
+            lock.unlock();
+
+            if (!drain(buffer))
+            {
+                write_errors_.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            lock.lock();
+            flush_completed_ = std::max(flush_completed_, requested);
+            flushed_.notify_all();
+            if (stopping)
+            {
+                return;
+            }
+        }
+    }
+
+    std::ostream& out_;
+    DeadLetterConfig config_;
+    std::unique_ptr<ThreadState[]> threads_;
+    std::vector<std::unique_ptr<SpscRing<Letter>>> rings_;
+    std::atomic<std::uint64_t> invalid_{0};
+    std::atomic<std::uint64_t> lost_{0};  ///< Letters not written because the output failed
+    std::atomic<std::uint64_t> written_{0};
+    std::atomic<std::uint64_t> write_errors_{0};
+    bool failed_{false};  ///< The output failed; only touched by the spill thread
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable flushed_;
+    bool stopping_{false};
+    std::uint64_t flush_requested_{0};
+    std::uint64_t flush_completed_{0};
+    std::thread spill_thread_;
+};
+
+/**
+ * @brief Pipeline sink forwarding to another sink and dead-lettering failures
+ *
+ * Wraps the application's sink: every payload is passed on unchanged, and
+ * those that did not decode cleanly are also offered to the queue under
+ * the worker's index, so the queue needs at least as many threads as the
+ * pipeline has workers.
+ */
+class DeadLetterSink final : public PipelineSink
+{
+public:
+    DeadLetterSink(PipelineSink& next, DeadLetterQueue& queue) noexcept
+        : next_(next), queue_(queue)
+    {
+    }
+
+    void consume(std::size_t worker, const DecodedPayload& result) override
+    {
+        if (!result.status.ok())
+        {
+            queue_.offer(worker, result.device, result.timestamp, result.payload, result.status);
+        }
+        next_.consume(worker, result);
+    }
+
+    void flush(std::size_t worker) override { next_.flush(worker); }
+
+private:
+    PipelineSink& next_;
+    DeadLetterQueue& queue_;
+};
+
+}  // namespace cayene
+
+#endif  // CAYENE_DEAD_LETTER_HPP
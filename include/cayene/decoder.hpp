@@ -15,11 +15,37 @@
 #include <span>
 #include <string>
 #include <unordered_map>
+#include <utility>
 
 #include <nlohmann/json.hpp>
 
 #include "data_type.hpp"
 #include "error.hpp"
+#include "filter.hpp"
+#include "flat_object.hpp"
+#include "record.hpp"
+
+/**
+ * @brief Linkage of the Decoder member definitions
+ *
+ * Defining CAYENE_HEADER_ONLY (or configuring with -DCAYENE_HEADER_ONLY=ON)
+ * makes every Decoder member inline and visible in this header, so that it
+ * can be used without linking the library and fully inlined into callers.
+ */
+#ifdef CAYENE_HEADER_ONLY
+    #define CAYENE_INLINE inline
+#else
+    #define CAYENE_INLINE
+#endif
+
+/**
+ * @brief Marks error paths, which the compiler then moves out of callers' hot code
+ */
+#if defined(__GNUC__) || defined(__clang__)
+    #define CAYENE_COLD __attribute__((cold))
+#else
+    #define CAYENE_COLD
+#endif
 
 namespace cayene
 {
@@ -51,9 +77,12 @@ public:
     Decoder(Decoder&&) noexcept = default;
     Decoder& operator=(Decoder&&) noexcept = default;
 
+#ifndef CAYENE_NO_EXCEPTIONS
     /**
      * @brief Decode a Cayene LPP encoded payload
      *
+     * Not available when built with CAYENE_NO_EXCEPTIONS; use try_decode instead.
+     *
      * @param encoded_payload The raw payload bytes to decode
      * @return Decoded JSON object
      * @throws PayloadEmptyException if payload is empty
@@ -62,6 +91,163 @@ public:
      */
     [[nodiscard]] auto decode(std::span<const std::uint8_t> encoded_payload) -> Json;
 
+    /**
+     * @brief Decode only the records selected by a filter
+     *
+     * Other records are skipped by size; they must still be well formed.
+     *
+     * @param encoded_payload The raw payload bytes to decode
+     * @param filter Type ids and channels to decode
+     * @return Decoded JSON object holding the selected records
+     * @throws Same exceptions as decode(encoded_payload)
+     */
+    [[nodiscard]] auto decode(std::span<const std::uint8_t> encoded_payload,
+                              const RecordFilter& filter) -> Json;
+#endif
+
+    /**
+     * @brief Decode a Cayene LPP encoded payload, reporting errors as codes
+     *
+     * On failure the output holds the records decoded before the error.
+     *
+     * @param encoded_payload The raw payload bytes to decode
+     * @param decoded_json Receives the decoded JSON object
+     * @return Status with the number of records decoded
+     */
+    DecodeStatus try_decode(std::span<const std::uint8_t> encoded_payload,
+                            Json& decoded_json) const;
+
+    /**
+     * @brief Decode the records selected by a filter, reporting errors as codes
+     *
+     * @param encoded_payload The raw payload bytes to decode
+     * @param decoded_json Receives the decoded JSON object
+     * @param filter Type ids and channels to decode
+     * @return Status with the number of selected records decoded
+     */
+    DecodeStatus try_decode(std::span<const std::uint8_t> encoded_payload, Json& decoded_json,
+                            const RecordFilter& filter) const;
+
+    /**
+     * @brief Decode a payload into a flat, insertion-ordered object
+     *
+     * Avoids the per-record key string and tree node of the Json object;
+     * call FlatObject::to_json() to get the decode() result when needed.
+     * Never allocates for payloads of standard types with at most
+     * FlatObject::kInlineCapacity distinct records.
+     *
+     * @param encoded_payload The raw payload bytes to decode
+     * @param output Receives the records; cleared first
+     * @return Status with the number of records decoded
+     */
+    DecodeStatus decode_flat(std::span<const std::uint8_t> encoded_payload,
+                             FlatObject& output) const;
+
+    /**
+     * @brief Decode the records selected by a filter into a flat object
+     *
+     * @param encoded_payload The raw payload bytes to decode
+     * @param output Receives the records; cleared first
+     * @param filter Type ids and channels to decode
+     * @return Status with the number of selected records decoded
+     */
+    DecodeStatus decode_flat(std::span<const std::uint8_t> encoded_payload, FlatObject& output,
+                             const RecordFilter& filter) const;
+
+    /**
+     * @brief Check that a payload is well formed without decoding its values
+     *
+     * Never allocates.
+     *
+     * @param encoded_payload The raw payload bytes to check
+     * @return Status with the number of records on success
+     */
+    [[nodiscard]] DecodeStatus validate(
+        std::span<const std::uint8_t> encoded_payload) const noexcept;
+
+    /**
+     * @brief Decode a payload into caller-provided typed records
+     *
+     * Never allocates. Custom types are reported with their bytes only.
+     *
+     * @param encoded_payload The raw payload bytes to decode
+     * @param records Output array; fails with BufferTooSmall if it cannot hold every record
+     * @return Status with the number of records written
+     */
+    DecodeStatus decode_records(std::span<const std::uint8_t> encoded_payload,
+                                std::span<Record> records) const noexcept;
+
+    /**
+     * @brief Decode the records selected by a filter into caller-provided typed records
+     *
+     * @param encoded_payload The raw payload bytes to decode
+     * @param records Output array; must hold every selected record
+     * @param filter Type ids and channels to decode
+     * @return Status with the number of records written
+     */
+    DecodeStatus decode_records(std::span<const std::uint8_t> encoded_payload,
+                                std::span<Record> records,
+                                const RecordFilter& filter) const noexcept;
+
+    /**
+     * @brief Decode a payload, calling a visitor for each typed record
+     *
+     * Never allocates by itself. Records visited before an error are not rolled back.
+     *
+     * @param encoded_payload The raw payload bytes to decode
+     * @param visitor Callable invoked as visitor(const Record&)
+     * @return Status with the number of records visited
+     */
+    template <typename Visitor>
+    DecodeStatus visit(std::span<const std::uint8_t> encoded_payload, Visitor&& visitor) const
+    {
+        return visit(encoded_payload, RecordFilter{}, std::forward<Visitor>(visitor));
+    }
+
+    /**
+     * @brief Call a visitor for each record selected by a filter
+     *
+     * @param encoded_payload The raw payload bytes to decode
+     * @param filter Type ids and channels to visit
+     * @param visitor Callable invoked as visitor(const Record&)
+     * @return Status with the number of records visited
+     */
+    template <typename Visitor>
+    DecodeStatus visit(std::span<const std::uint8_t> encoded_payload, const RecordFilter& filter,
+                       Visitor&& visitor) const
+    {
+        return walk(encoded_payload, filter,
+                    [&visitor](const Record& record)
+                    {
+                        visitor(record);
+                        return true;
+                    });
+    }
+
+    /**
+     * @brief Decode a payload straight into a JSON text buffer
+     *
+     * Produces the same object as decode(payload).dump(), except that keys
+     * follow payload order. Never allocates for standard types.
+     *
+     * @param encoded_payload The raw payload bytes to decode
+     * @param output Destination buffer; fails with BufferTooSmall if it is too short
+     * @return Status with the number of bytes written (no terminating NUL)
+     */
+    DecodeStatus write_json(std::span<const std::uint8_t> encoded_payload,
+                            std::span<char> output) const;
+
+    /**
+     * @brief Write the records selected by a filter as JSON text
+     *
+     * @param encoded_payload The raw payload bytes to decode
+     * @param output Destination buffer; fails with BufferTooSmall if it is too short
+     * @param filter Type ids and channels to write
+     * @return Status with the number of bytes written (no terminating NUL)
+     */
+    DecodeStatus write_json(std::span<const std::uint8_t> encoded_payload, std::span<char> output,
+                            const RecordFilter& filter) const;
+
     /**
      * @brief Register a custom data type
      *
@@ -82,6 +268,14 @@ public:
      */
     [[nodiscard]] bool has_type(std::uint8_t type_id) const noexcept;
 
+    /**
+     * @brief Look up a registered data type
+     *
+     * @param type_id The type identifier to look up
+     * @return The data type, or nullptr if it is not registered
+     */
+    [[nodiscard]] const DataType* find_type(std::uint8_t type_id) const noexcept;
+
     /**
      * @brief Remove a custom data type
      *
@@ -93,6 +287,71 @@ public:
 private:
     std::unordered_map<std::uint8_t, DataType> data_types_;
 
+#ifndef CAYENE_NO_EXCEPTIONS
+    // Throws the exception matching a failed status; cold, so callers keep only the call
+    [[noreturn]] CAYENE_COLD static void raise(const DecodeStatus& status,
+                                               std::size_t payload_size);
+#endif
+
+    // Reads the record starting at index and advances index past it
+    ErrorCode read_record(std::span<const std::uint8_t> encoded_payload, std::size_t& index,
+                          Record& record) const noexcept;
+
+    // Advances index past the record starting there without reading its values
+    ErrorCode skip_record(std::span<const std::uint8_t> encoded_payload,
+                          std::size_t& index) const noexcept;
+
+    // Shared record loop; the sink returns false when it cannot accept more records
+    template <typename Sink>
+    DecodeStatus walk(std::span<const std::uint8_t> encoded_payload, const RecordFilter& filter,
+                      Sink&& sink) const
+    {
+        DecodeStatus status;
+        if (encoded_payload.empty())
+        {
+            status.code = ErrorCode::PayloadEmpty;
+            return status;
+        }
+
+        const bool projected = !filter.selects_all();
+        std::size_t current_index = 0;
+        Record record;
+        while (current_index + 2 <= encoded_payload.size())
+        {
+            const std::size_t record_start = current_index;
+            const bool selected =
+                !projected || filter.matches(encoded_payload[current_index],
+                                             encoded_payload[current_index + 1]);
+            if (selected)
+            {
+                status.code = read_record(encoded_payload, current_index, record);
+                if (status.code == ErrorCode::Ok && !sink(record))
+                {
+                    status.code = ErrorCode::BufferTooSmall;
+                }
+            }
+            else
+            {
+                status.code = skip_record(encoded_payload, current_index);
+            }
+            if (status.code != ErrorCode::Ok)
+            {
+                status.offset = record_start;
+                status.type_id = encoded_payload[record_start + 1];
+                return status;
+            }
+            status.count += selected ? 1U : 0U;
+        }
+
+        // If there are unprocessed bytes remaining
+        status.offset = current_index;
+        if (current_index != encoded_payload.size())
+        {
+            status.code = ErrorCode::BadPayloadFormat;
+        }
+        return status;
+    }
+
     // Byte conversion utilities
     [[nodiscard]] static std::int16_t bytes_to_int16(std::span<const std::uint8_t> data_span);
     [[nodiscard]] static std::uint16_t bytes_to_uint16(std::span<const std::uint8_t> data_span);
@@ -116,4 +375,8 @@ private:
 
 }  // namespace cayene
 
+#ifdef CAYENE_HEADER_ONLY
+    #include "detail/decoder_impl.hpp"
+#endif
+
 #endif  // CAYENE_DECODER_HPP
@@ -0,0 +1,684 @@
+#ifndef CAYENE_DETAIL_DECODER_IMPL_HPP
+#define CAYENE_DETAIL_DECODER_IMPL_HPP
+
+/**
+ * @file decoder_impl.hpp
+ * @brief Implementation of the Cayene Decoder
+ *
+ * Compiled once into the library by src/decoder.cpp, or included inline by
+ * decoder.hpp when CAYENE_HEADER_ONLY is defined so callers can inline the
+ * type dispatch and byte conversions into their own decode loops.
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "../decoder.hpp"
+#include "../trace.hpp"
+#include "v1_definitions.hpp"
+
+namespace cayene
+{
+
+namespace detail
+{
+
+/**
+ * @brief Bounded JSON text writer over a caller-provided buffer
+ */
+class BufferWriter
+{
+public:
+    explicit BufferWriter(std::span<char> output) noexcept : output_(output) {}
+
+    void put(char character) noexcept
+    {
+        if (position_ < output_.size())
+        {
+            output_[position_] = character;
+        }
+        ++position_;
+    }
+
+    void put(std::string_view text) noexcept
+    {
+        for (const char character : text)
+        {
+            put(character);
+        }
+    }
+
+    void put_escaped(std::string_view text) noexcept
+    {
+        static constexpr std::string_view hex = "0123456789abcdef";
+        for (const char character : text)
+        {
+            const auto byte = static_cast<unsigned char>(character);
+            if (character == '"' || character == '\\')
+            {
+                put('\\');
+                put(character);
+            }
+            else if (byte < 0x20U)
+            {
+                put("\\u00");
+                put(hex[byte >> 4U]);
+                put(hex[byte & 0xFU]);
+            }
+            else
+            {
+                put(character);
+            }
+        }
+    }
+
+    void put_integer(std::int64_t value) noexcept
+    {
+        std::array<char, 24> digits{};
+        const auto result = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+        put(std::string_view(digits.data(), static_cast<std::size_t>(result.ptr - digits.data())));
+    }
+
+    // Same text as nlohmann::json::dump() for the magnitudes Cayene LPP can encode
+    void put_double(double value) noexcept
+    {
+        std::array<char, 64> digits{};
+        const auto result = std::to_chars(digits.data(), digits.data() + digits.size(), value,
+                                          std::chars_format::fixed);
+        const std::string_view text(digits.data(),
+                                    static_cast<std::size_t>(result.ptr - digits.data()));
+        put(text);
+        if (text.find('.') == std::string_view::npos)
+        {
+            put(".0");
+        }
+    }
+
+    void put_value(const Record& record, std::size_t index) noexcept
+    {
+        if (standard_value_layout(record.type_id).divisor[index] == 1.0)
+        {
+            put_integer(record.raw[index]);
+        }
+        else
+        {
+            put_double(record.value(index));
+        }
+    }
+
+    [[nodiscard]] bool fits() const noexcept { return position_ <= output_.size(); }
+    [[nodiscard]] std::size_t size() const noexcept { return position_; }
+
+private:
+    std::span<char> output_;
+    std::size_t position_{0};
+};
+
+}  // namespace detail
+
+CAYENE_INLINE Decoder::Decoder()
+{
+    auto standard_data_types = definitions::get_v1_standard_data_types();
+
+    for (auto& data_type : standard_data_types)
+    {
+        data_types_.emplace(data_type.type_id, std::move(data_type));
+    }
+}
+
+CAYENE_INLINE Decoder::~Decoder() = default;
+
+#ifndef CAYENE_NO_EXCEPTIONS
+CAYENE_INLINE auto Decoder::decode(std::span<const std::uint8_t> encoded_payload) -> Json
+{
+    return decode(encoded_payload, RecordFilter{});
+}
+
+CAYENE_INLINE auto Decoder::decode(std::span<const std::uint8_t> encoded_payload,
+                                   const RecordFilter& filter) -> Json
+{
+    Json decoded_json;
+    const DecodeStatus status = try_decode(encoded_payload, decoded_json, filter);
+    if (!status)
+    {
+        raise(status, encoded_payload.size());
+    }
+    return decoded_json;
+}
+
+CAYENE_INLINE void Decoder::raise(const DecodeStatus& status, std::size_t payload_size)
+{
+    switch (status.code)
+    {
+        case ErrorCode::PayloadEmpty:
+            throw PayloadEmptyException();
+        case ErrorCode::UnknownDataType:
+            throw UnknownDataTypeException(status.type_id, status.offset, payload_size);
+        case ErrorCode::BadPayloadFormat:
+            // A lone trailing byte cannot start a record; anything longer is a truncated record
+            if (payload_size - status.offset < 2)
+            {
+                throw BadPayloadFormatException("Unprocessed bytes remaining", status.offset,
+                                                status.type_id, payload_size);
+            }
+            throw BadPayloadFormatException("Insufficient bytes for data type", status.offset,
+                                            status.type_id, payload_size);
+        case ErrorCode::Unexpected:
+            throw UnexpectedException("Custom type has no decoder function", status.offset,
+                                      status.type_id, payload_size);
+        default:
+            throw UnexpectedException(error_message(status.code), status.offset, status.type_id,
+                                      payload_size);
+    }
+}
+#endif
+
+CAYENE_INLINE DecodeStatus Decoder::try_decode(std::span<const std::uint8_t> encoded_payload,
+                                               Json& decoded_json) const
+{
+    return try_decode(encoded_payload, decoded_json, RecordFilter{});
+}
+
+CAYENE_INLINE DecodeStatus Decoder::try_decode(std::span<const std::uint8_t> encoded_payload,
+                                               Json& decoded_json,
+                                               const RecordFilter& filter) const
+{
+    CAYENE_TRACE_SCOPE(trace::Stage::LppDecode);
+
+    DecodeStatus status;
+    decoded_json = Json::object();
+
+    if (encoded_payload.empty())
+    {
+        status.code = ErrorCode::PayloadEmpty;
+        return status;
+    }
+
+    const bool projected = !filter.selects_all();
+    std::size_t current_index = 0;
+
+    while (current_index + 2 <= encoded_payload.size())
+    {
+        const std::size_t record_start = current_index;
+        const std::uint8_t channel = encoded_payload[current_index++];
+        const std::uint8_t type_id = encoded_payload[current_index++];
+
+        status.offset = record_start;
+        status.type_id = type_id;
+
+        // If the data type is not registered
+        const DataType* const found_type = find_type(type_id);
+        if (found_type == nullptr)
+        {
+            status.code = ErrorCode::UnknownDataType;
+            return status;
+        }
+
+        const DataType& data_type = *found_type;
+
+        // If remaining bytes are less than required by the data type
+        if (current_index + data_type.size > encoded_payload.size())
+        {
+            status.code = ErrorCode::BadPayloadFormat;
+            return status;
+        }
+
+        // Records outside the projection are skipped without building their key or value
+        if (projected && !filter.matches(channel, type_id))
+        {
+            current_index += data_type.size;
+            continue;
+        }
+
+        const auto data_span = encoded_payload.subspan(current_index, data_type.size);
+        const std::string key = data_type.name + "_" + std::to_string(channel);
+
+        if (!data_type.standard)
+        {
+            if (!data_type.decoder_function)
+            {
+                status.code = ErrorCode::Unexpected;
+                return status;
+            }
+            decoded_json[key] = data_type.decoder_function(data_span);
+            current_index += data_type.size;
+            ++status.count;
+            continue;
+        }
+
+        switch (type_id)
+        {
+            case 0x00:
+                decoded_json[key] = decode_digital_input(data_span);
+                break;
+            case 0x01:
+                decoded_json[key] = decode_digital_output(data_span);
+                break;
+            case 0x02:
+                decoded_json[key] = decode_analog_input(data_span);
+                break;
+            case 0x03:
+                decoded_json[key] = decode_analog_output(data_span);
+                break;
+            case 0x65:
+                decoded_json[key] = decode_luminosity(data_span);
+                break;
+            case 0x66:
+                decoded_json[key] = decode_presence(data_span);
+                break;
+            case 0x67:
+                decoded_json[key] = decode_temperature(data_span);
+                break;
+            case 0x68:
+                decoded_json[key] = decode_humidity(data_span);
+                break;
+            case 0x71:
+                decoded_json[key] = decode_accelerometer(data_span);
+                break;
+            case 0x73:
+                decoded_json[key] = decode_barometer(data_span);
+                break;
+            case 0x86:
+                decoded_json[key] = decode_gyrometer(data_span);
+                break;
+            case 0x88:
+                decoded_json[key] = decode_gps(data_span);
+                break;
+            default:
+                status.code = ErrorCode::UnknownDataType;
+                return status;
+        }
+
+        current_index += data_type.size;
+        ++status.count;
+    }
+
+    status.offset = current_index;
+    status.type_id = 0;
+
+    // If there are unprocessed bytes remaining
+    if (current_index != encoded_payload.size())
+    {
+        status.code = ErrorCode::BadPayloadFormat;
+    }
+
+    return status;
+}
+
+CAYENE_INLINE DecodeStatus Decoder::decode_flat(std::span<const std::uint8_t> encoded_payload,
+                                                FlatObject& output) const
+{
+    return decode_flat(encoded_payload, output, RecordFilter{});
+}
+
+CAYENE_INLINE DecodeStatus Decoder::decode_flat(std::span<const std::uint8_t> encoded_payload,
+                                                FlatObject& output,
+                                                const RecordFilter& filter) const
+{
+    CAYENE_TRACE_SCOPE(trace::Stage::LppDecode);
+
+    output.clear();
+    return walk(encoded_payload, filter,
+                [this, &output](const Record& record)
+                {
+                    const DataType& data_type = *find_type(record.type_id);
+                    FlatEntry& entry = output.insert(data_type.name, record.channel);
+                    entry.record = record;
+                    if (!data_type.standard)
+                    {
+                        entry.custom = data_type.decoder_function(record.data);
+                    }
+                    return true;
+                });
+}
+
+CAYENE_INLINE DecodeStatus
+Decoder::validate(std::span<const std::uint8_t> encoded_payload) const noexcept
+{
+    return walk(encoded_payload, RecordFilter{}, [](const Record&) { return true; });
+}
+
+CAYENE_INLINE DecodeStatus Decoder::decode_records(std::span<const std::uint8_t> encoded_payload,
+                                                   std::span<Record> records) const noexcept
+{
+    return decode_records(encoded_payload, records, RecordFilter{});
+}
+
+CAYENE_INLINE DecodeStatus Decoder::decode_records(std::span<const std::uint8_t> encoded_payload,
+                                                   std::span<Record> records,
+                                                   const RecordFilter& filter) const noexcept
+{
+    CAYENE_TRACE_SCOPE(trace::Stage::LppDecode);
+    std::size_t written = 0;
+    return walk(encoded_payload, filter,
+                [&records, &written](const Record& record)
+                {
+                    if (written == records.size())
+                    {
+                        return false;
+                    }
+                    records[written++] = record;
+                    return true;
+                });
+}
+
+CAYENE_INLINE DecodeStatus Decoder::write_json(std::span<const std::uint8_t> encoded_payload,
+                                               std::span<char> output) const
+{
+    return write_json(encoded_payload, output, RecordFilter{});
+}
+
+CAYENE_INLINE DecodeStatus Decoder::write_json(std::span<const std::uint8_t> encoded_payload,
+                                               std::span<char> output,
+                                               const RecordFilter& filter) const
+{
+    CAYENE_TRACE_SCOPE(trace::Stage::Serialize);
+    detail::BufferWriter writer(output);
+    bool first = true;
+
+    writer.put('{');
+    DecodeStatus status = walk(
+        encoded_payload, filter,
+        [this, &writer, &first](const Record& record)
+        {
+            const DataType& data_type = *find_type(record.type_id);
+
+            if (!first)
+            {
+                writer.put(',');
+            }
+            first = false;
+
+            writer.put('"');
+            writer.put_escaped(data_type.name);
+            writer.put('_');
+            writer.put_integer(record.channel);
+            writer.put("\":");
+
+            if (!data_type.standard)
+            {
+                writer.put(data_type.decoder_function(record.data).dump());
+            }
+            else if (record.type_id == 0x71 || record.type_id == 0x86)
+            {
+                writer.put("{\"x\":");
+                writer.put_value(record, 0);
+                writer.put(",\"y\":");
+                writer.put_value(record, 1);
+                writer.put(",\"z\":");
+                writer.put_value(record, 2);
+                writer.put('}');
+            }
+            else if (record.type_id == 0x88)
+            {
+                // Same key order as the std::map backing Json objects
+                writer.put("{\"altitude\":");
+                writer.put_value(record, 2);
+                writer.put(",\"latitude\":");
+                writer.put_value(record, 0);
+                writer.put(",\"longitude\":");
+                writer.put_value(record, 1);
+                writer.put('}');
+            }
+            else
+            {
+                writer.put_value(record, 0);
+            }
+
+            return writer.fits();
+        });
+    writer.put('}');
+
+    if (status.ok() && !writer.fits())
+    {
+        status.code = ErrorCode::BufferTooSmall;
+        status.offset = encoded_payload.size();
+    }
+    status.count = status.ok() ? writer.size() : 0;
+    return status;
+}
+
+CAYENE_INLINE bool Decoder::add_custom_type(std::uint8_t type_id, std::string name,
+                                            std::size_t size, DecoderFunction decoder_function)
+{
+    if (data_types_.contains(type_id))
+    {
+        return false;
+    }
+
+    if (!decoder_function)
+    {
+        return false;
+    }
+
+    if (size == 0)
+    {
+        return false;
+    }
+
+    data_types_.emplace(
+        type_id, DataType(type_id, std::move(name), size, false, std::move(decoder_function)));
+    return true;
+}
+
+CAYENE_INLINE bool Decoder::has_type(std::uint8_t type_id) const noexcept
+{
+    return data_types_.contains(type_id);
+}
+
+CAYENE_INLINE const DataType* Decoder::find_type(std::uint8_t type_id) const noexcept
+{
+    const auto iter = data_types_.find(type_id);
+    return iter == data_types_.end() ? nullptr : &iter->second;
+}
+
+CAYENE_INLINE bool Decoder::remove_custom_type(std::uint8_t type_id)
+{
+    auto iter = data_types_.find(type_id);
+    if (iter == data_types_.end())
+    {
+        return false;
+    }
+
+    // Cannot remove standard types
+    if (iter->second.standard)
+    {
+        return false;
+    }
+
+    data_types_.erase(iter);
+    return true;
+}
+
+CAYENE_INLINE ErrorCode Decoder::skip_record(std::span<const std::uint8_t> encoded_payload,
+                                             std::size_t& index) const noexcept
+{
+    const auto iter = data_types_.find(encoded_payload[index + 1]);
+    if (iter == data_types_.end())
+    {
+        return ErrorCode::UnknownDataType;
+    }
+
+    const std::size_t size = iter->second.size;
+    if (index + 2 + size > encoded_payload.size())
+    {
+        return ErrorCode::BadPayloadFormat;
+    }
+
+    index += 2 + size;
+    return ErrorCode::Ok;
+}
+
+CAYENE_INLINE ErrorCode Decoder::read_record(std::span<const std::uint8_t> encoded_payload,
+                                             std::size_t& index, Record& record) const noexcept
+{
+    const std::uint8_t channel = encoded_payload[index];
+    const std::uint8_t type_id = encoded_payload[index + 1];
+
+    const auto iter = data_types_.find(type_id);
+    if (iter == data_types_.end())
+    {
+        return ErrorCode::UnknownDataType;
+    }
+
+    const DataType& data_type = iter->second;
+    if (index + 2 + data_type.size > encoded_payload.size())
+    {
+        return ErrorCode::BadPayloadFormat;
+    }
+
+    record.channel = channel;
+    record.type_id = type_id;
+    record.data = encoded_payload.subspan(index + 2, data_type.size);
+    record.value_count =
+        data_type.standard ? read_raw_values(type_id, record.data, record.raw) : std::uint8_t{0};
+
+    index += 2 + data_type.size;
+    return ErrorCode::Ok;
+}
+
+CAYENE_INLINE std::uint16_t Decoder::bytes_to_uint16(std::span<const std::uint8_t> data_span)
+{
+    return static_cast<std::uint16_t>((static_cast<std::uint16_t>(data_span[0]) << 8U) |
+                                      static_cast<std::uint16_t>(data_span[1]));
+}
+
+CAYENE_INLINE std::int16_t Decoder::bytes_to_int16(std::span<const std::uint8_t> data_span)
+{
+    const std::uint16_t unsigned_value = bytes_to_uint16(data_span);
+    // If the value is greater than the max positive int16_t, it's negative
+    if (unsigned_value > 0x7FFFU)
+    {
+        return static_cast<std::int16_t>(static_cast<std::int32_t>(unsigned_value) - 0x10000);
+    }
+
+    return static_cast<std::int16_t>(unsigned_value);
+}
+
+CAYENE_INLINE std::uint32_t Decoder::bytes_to_uint24(std::span<const std::uint8_t> data_span)
+{
+    return ((static_cast<std::uint32_t>(data_span[0]) << 16U) |
+            (static_cast<std::uint32_t>(data_span[1]) << 8U) |
+            static_cast<std::uint32_t>(data_span[2])) &
+           0x00FFFFFFU;
+}
+
+CAYENE_INLINE std::int32_t Decoder::bytes_to_int24(std::span<const std::uint8_t> data_span)
+{
+    const std::uint32_t unsigned_value = bytes_to_uint24(data_span);
+    // If the value is greater than the max positive 24-bit int, it's negative
+    if (unsigned_value > 0x7FFFFFU)
+    {
+        return static_cast<std::int32_t>(unsigned_value) - 0x1000000;
+    }
+
+    return static_cast<std::int32_t>(unsigned_value);
+}
+
+CAYENE_INLINE Json Decoder::decode_digital_input(std::span<const std::uint8_t> data_span)
+{
+    return Json(data_span[0]);
+}
+
+CAYENE_INLINE Json Decoder::decode_digital_output(std::span<const std::uint8_t> data_span)
+{
+    return Json(data_span[0]);
+}
+
+CAYENE_INLINE Json Decoder::decode_analog_input(std::span<const std::uint8_t> data_span)
+{
+    const std::int16_t raw_value = bytes_to_int16(data_span);
+    return Json(raw_value / 100.0);
+}
+
+CAYENE_INLINE Json Decoder::decode_analog_output(std::span<const std::uint8_t> data_span)
+{
+    const std::int16_t raw_value = bytes_to_int16(data_span);
+    return Json(raw_value / 100.0);
+}
+
+CAYENE_INLINE Json Decoder::decode_luminosity(std::span<const std::uint8_t> data_span)
+{
+    return Json(bytes_to_uint16(data_span));
+}
+
+CAYENE_INLINE Json Decoder::decode_presence(std::span<const std::uint8_t> data_span)
+{
+    return Json(data_span[0]);
+}
+
+CAYENE_INLINE Json Decoder::decode_temperature(std::span<const std::uint8_t> data_span)
+{
+    const std::int16_t raw_value = bytes_to_int16(data_span);
+    return Json(raw_value / 10.0);
+}
+
+CAYENE_INLINE Json Decoder::decode_humidity(std::span<const std::uint8_t> data_span)
+{
+    const std::uint16_t raw_value = bytes_to_uint16(data_span);
+    return Json(raw_value / 10.0);
+}
+
+CAYENE_INLINE Json Decoder::decode_accelerometer(std::span<const std::uint8_t> data_span)
+{
+    Json accel_json = Json::object();
+
+    const std::int16_t x_raw = bytes_to_int16(data_span.subspan(0, 2));
+    const std::int16_t y_raw = bytes_to_int16(data_span.subspan(2, 2));
+    const std::int16_t z_raw = bytes_to_int16(data_span.subspan(4, 2));
+
+    accel_json["x"] = x_raw / 1000.0;
+    accel_json["y"] = y_raw / 1000.0;
+    accel_json["z"] = z_raw / 1000.0;
+
+    return accel_json;
+}
+
+CAYENE_INLINE Json Decoder::decode_barometer(std::span<const std::uint8_t> data_span)
+{
+    const std::uint16_t raw_value = bytes_to_uint16(data_span);
+    return Json(raw_value / 10.0);
+}
+
+CAYENE_INLINE Json Decoder::decode_gyrometer(std::span<const std::uint8_t> data_span)
+{
+    Json gyro_json = Json::object();
+
+    const std::int16_t x_raw = bytes_to_int16(data_span.subspan(0, 2));
+    const std::int16_t y_raw = bytes_to_int16(data_span.subspan(2, 2));
+    const std::int16_t z_raw = bytes_to_int16(data_span.subspan(4, 2));
+
+    gyro_json["x"] = x_raw / 100.0;
+    gyro_json["y"] = y_raw / 100.0;
+    gyro_json["z"] = z_raw / 100.0;
+
+    return gyro_json;
+}
+
+CAYENE_INLINE Json Decoder::decode_gps(std::span<const std::uint8_t> data_span)
+{
+    Json gps_json = Json::object();
+
+    const std::int32_t lat_raw = bytes_to_int24(data_span.subspan(0, 3));
+    const std::int32_t lon_raw = bytes_to_int24(data_span.subspan(3, 3));
+    const std::int32_t alt_raw = bytes_to_int24(data_span.subspan(6, 3));
+
+    gps_json["latitude"] = lat_raw / 10000.0;
+    gps_json["longitude"] = lon_raw / 10000.0;
+    gps_json["altitude"] = alt_raw / 100.0;
+
+    return gps_json;
+}
+
+}  // namespace cayene
+
+#endif  // CAYENE_DETAIL_DECODER_IMPL_HPP
@@ -0,0 +1,86 @@
+#ifndef CAYENE_DETAIL_OPEN_ADDRESSING_HPP
+#define CAYENE_DETAIL_OPEN_ADDRESSING_HPP
+
+/**
+ * @file open_addressing.hpp
+ * @brief Key packing, hashing and sizing shared by the open-addressed tables
+ *
+ * ChangeFilter, AggregationShard and ShadowTable all key records by
+ * (device, channel, type) in power-of-two tables with linear probing,
+ * kept at most three quarters full.
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace cayene::detail
+{
+
+/**
+ * @brief Key of an empty slot
+ */
+inline constexpr std::uint64_t kEmptyKey = 0;
+
+/**
+ * @brief Marker bit of occupied keys, so that device 0, channel 0, type 0 is not empty
+ */
+inline constexpr std::uint64_t kOccupiedKey = std::uint64_t{1} << 48U;
+
+/**
+ * @brief Multiplier of the golden ratio, used unless a table needs its own
+ */
+inline constexpr std::uint64_t kFibonacciMultiplier = 0x9E3779B97F4A7C15ULL;
+
+/**
+ * @brief Pack a (device, channel, type) into a non-empty key
+ */
+[[nodiscard]] constexpr std::uint64_t record_key(std::uint32_t device, std::uint8_t channel,
+                                                 std::uint8_t type_id) noexcept
+{
+    return kOccupiedKey | (std::uint64_t{device} << 16U) | (std::uint64_t{channel} << 8U) |
+           type_id;
+}
+
+/**
+ * @brief Right shift that maps a 64-bit hash onto a power-of-two capacity
+ */
+[[nodiscard]] constexpr unsigned index_shift(std::size_t capacity) noexcept
+{
+    return 64U - static_cast<unsigned>(std::countr_zero(capacity));
+}
+
+/**
+ * @brief Slot index of a key by Fibonacci hashing
+ *
+ * The high bits of the product are well mixed, so they are the ones kept.
+ */
+[[nodiscard]] constexpr std::size_t slot_index(
+    std::uint64_t key, unsigned shift, std::uint64_t multiplier = kFibonacciMultiplier) noexcept
+{
+    return static_cast<std::size_t>((key * multiplier) >> shift);
+}
+
+/**
+ * @brief Check whether inserting one more key would exceed the load factor of 3/4
+ */
+[[nodiscard]] constexpr bool exceeds_load(std::size_t size, std::size_t capacity) noexcept
+{
+    return (size + 1) * 4 > capacity * 3;
+}
+
+/**
+ * @brief Smallest power-of-two capacity (at least 16) holding keys within the load factor
+ */
+[[nodiscard]] constexpr std::size_t capacity_for(std::size_t keys) noexcept
+{
+    return std::bit_ceil(std::max<std::size_t>((keys * 4 / 3) + 1, 16));
+}
+
+}  // namespace cayene::detail
+
+#endif  // CAYENE_DETAIL_OPEN_ADDRESSING_HPP
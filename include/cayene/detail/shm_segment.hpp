@@ -0,0 +1,66 @@
+#ifndef CAYENE_DETAIL_SHM_SEGMENT_HPP
+#define CAYENE_DETAIL_SHM_SEGMENT_HPP
+
+/**
+ * @file shm_segment.hpp
+ * @brief Creation, mapping and removal of the shared-memory segments (POSIX)
+ *
+ * Shared by SharedShadowTable and SharedUplinkRing. Functions return
+ * nullptr on failure with errno set.
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <string>
+
+namespace cayene::detail
+{
+
+/**
+ * @brief Identity of a segment, to tell it from a later one of the same name
+ */
+struct ShmSegmentId
+{
+    dev_t device{};
+    ino_t inode{};
+};
+
+/**
+ * @brief Create a zero-filled segment of size bytes under name and map it read-write
+ *
+ * An existing segment of the same name is unlinked, not reused, so
+ * processes that still map it keep their mapping, which is never truncated
+ * under them. The segment is only accessible to the creating user (0600).
+ */
+[[nodiscard]] void* create_shm(const std::string& name, std::size_t size,
+                               ShmSegmentId& segment) noexcept;
+
+/**
+ * @brief Size a new, empty descriptor to size bytes and map it read-write
+ */
+[[nodiscard]] void* map_new_shm(int fd, std::size_t size) noexcept;
+
+/**
+ * @brief Map the whole object behind fd, failing with EINVAL below min_size bytes
+ */
+[[nodiscard]] void* map_shm(int fd, bool writable, std::size_t min_size,
+                            std::size_t& size) noexcept;
+
+/**
+ * @brief Open the segment called name and map it as map_shm() does
+ */
+[[nodiscard]] void* open_shm(const std::string& name, bool writable, std::size_t min_size,
+                             std::size_t& size) noexcept;
+
+/**
+ * @brief Unlink name, unless it now names a segment other than the given one
+ */
+void unlink_shm(const std::string& name, const ShmSegmentId& segment) noexcept;
+
+}  // namespace cayene::detail
+
+#endif  // CAYENE_DETAIL_SHM_SEGMENT_HPP
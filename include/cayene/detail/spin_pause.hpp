@@ -0,0 +1,32 @@
+#ifndef CAYENE_DETAIL_SPIN_PAUSE_HPP
+#define CAYENE_DETAIL_SPIN_PAUSE_HPP
+
+/**
+ * @file spin_pause.hpp
+ * @brief CPU hint for the body of a spin-wait loop
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+namespace cayene::detail
+{
+
+/**
+ * @brief Tell the CPU the caller is spinning
+ *
+ * Lowers the power draw of the loop and frees pipeline resources for a
+ * sibling hyperthread, which may be the one the loop is waiting for.
+ */
+inline void spin_pause() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+}  // namespace cayene::detail
+
+#endif  // CAYENE_DETAIL_SPIN_PAUSE_HPP
@@ -1,11 +1,11 @@
 
 
-#ifndef CAYENE_V1_DEFINITIONS_HPP
-#define CAYENE_V1_DEFINITIONS_HPP
+#ifndef CAYENE_DETAIL_V1_DEFINITIONS_HPP
+#define CAYENE_DETAIL_V1_DEFINITIONS_HPP
 
 #include <vector>
 
-#include "cayene/data_type.hpp"
+#include "../data_type.hpp"
 namespace cayene::definitions
 {
 
@@ -23,4 +23,4 @@ inline std::vector<DataType> get_v1_standard_data_types()
 
 }  // namespace cayene::definitions
 
-#endif  // CAYENE_V1_DEFINITIONS_HPP
\ No newline at end of file
+#endif  // CAYENE_DETAIL_V1_DEFINITIONS_HPP
\ No newline at end of file
@@ -9,19 +9,182 @@
  * See LICENSE file for details.
  */
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
 
 namespace cayene
 {
 
+/**
+ * @brief Error codes reported by the non-throwing decode APIs
+ *
+ * Each failure code matches one exception type of the throwing API
+ * (see DecoderException::code()); BufferTooSmall only arises from APIs
+ * writing into caller-provided buffers. Builds with CAYENE_NO_EXCEPTIONS
+ * only expose these codes.
+ */
+enum class ErrorCode : std::uint8_t
+{
+    Ok = 0,
+    PayloadEmpty,
+    UnknownDataType,
+    BadPayloadFormat,
+    Unexpected,
+    BufferTooSmall,
+};
+
+/**
+ * @brief Get a short description of an error code
+ */
+[[nodiscard]] constexpr const char* error_message(ErrorCode code) noexcept
+{
+    switch (code)
+    {
+        case ErrorCode::Ok:
+            return "Ok";
+        case ErrorCode::PayloadEmpty:
+            return "Payload is empty";
+        case ErrorCode::UnknownDataType:
+            return "Unknown data type";
+        case ErrorCode::BadPayloadFormat:
+            return "Bad payload format";
+        case ErrorCode::Unexpected:
+            return "Unexpected error";
+        case ErrorCode::BufferTooSmall:
+            return "Output buffer too small";
+    }
+    return "Unknown error";
+}
+
+/**
+ * @brief Outcome of a non-throwing decode call
+ */
+struct DecodeStatus
+{
+    ErrorCode code{ErrorCode::Ok};
+    std::size_t offset{0};      ///< Byte offset of the failing record, or payload size on success
+    std::uint8_t type_id{0};    ///< Type id of the failing record, if any
+    std::size_t count{0};       ///< Records produced (bytes written for writers)
+
+    [[nodiscard]] constexpr bool ok() const noexcept { return code == ErrorCode::Ok; }
+    explicit constexpr operator bool() const noexcept { return ok(); }
+};
+
+#ifndef CAYENE_NO_EXCEPTIONS
+
 /**
  * @brief Base exception for Cayene decoder errors
+ *
+ * Errors raised by the decoder carry the failure as structured fields
+ * (code, byte offset, type id, payload size) and format their text into an
+ * inline buffer, so throwing one allocates nothing beyond the exception
+ * object. Exceptions built from a message string, e.g. by a custom type's
+ * decoder function, keep that message as given.
  */
 class DecoderException : public std::runtime_error
 {
 public:
-    explicit DecoderException(const std::string& message) : std::runtime_error(message) {}
+    explicit DecoderException(const std::string& message,
+                              ErrorCode error_code = ErrorCode::Unexpected)
+        : std::runtime_error(message), code_(error_code)
+    {
+    }
+
+    /**
+     * @brief Describe the error
+     */
+    [[nodiscard]] const char* what() const noexcept override
+    {
+        return text_[0] != '\0' ? text_.data() : std::runtime_error::what();
+    }
+
+    /**
+     * @brief Error code reported for the same failure by the non-throwing APIs
+     */
+    [[nodiscard]] ErrorCode code() const noexcept { return code_; }
+
+    /**
+     * @brief Byte offset of the failing record (0 when not raised by the decoder)
+     */
+    [[nodiscard]] std::size_t offset() const noexcept { return offset_; }
+
+    /**
+     * @brief Type id of the failing record, if any
+     */
+    [[nodiscard]] std::uint8_t type_id() const noexcept { return type_id_; }
+
+    /**
+     * @brief Size of the payload being decoded (0 when not raised by the decoder)
+     */
+    [[nodiscard]] std::size_t payload_size() const noexcept { return payload_size_; }
+
+protected:
+    /**
+     * @brief Structured error; reason must be a string literal (or otherwise static)
+     *
+     * The base gets an empty message, which needs no allocation; the text
+     * lives in text_ instead.
+     */
+    DecoderException(ErrorCode error_code, const char* reason, std::size_t offset,
+                     std::uint8_t type_id, std::size_t payload_size) noexcept
+        : std::runtime_error(""),
+          code_(error_code),
+          offset_(offset),
+          type_id_(type_id),
+          payload_size_(payload_size)
+    {
+        format(reason);
+    }
+
+private:
+    // Writes the message into text_, truncating an over-long reason
+    void format(const char* reason) noexcept
+    {
+        std::size_t length = 0;
+        auto append = [this, &length](const char* text)
+        {
+            for (; *text != '\0' && length + 1 < text_.size(); ++text)
+            {
+                text_[length++] = *text;
+            }
+        };
+
+        switch (code_)
+        {
+            case ErrorCode::UnknownDataType:
+            {
+                constexpr const char* hex = "0123456789ABCDEF";
+                const std::array<char, 3> digits = {hex[type_id_ >> 4U], hex[type_id_ & 0xFU],
+                                                    '\0'};
+                append("Unknown data type: 0x");
+                append(digits.data());
+                break;
+            }
+            case ErrorCode::BadPayloadFormat:
+                append("Bad payload format: ");
+                break;
+            case ErrorCode::Unexpected:
+                append("Unexpected error: ");
+                break;
+            default:
+                append(error_message(code_));
+                break;
+        }
+        if (reason != nullptr && code_ != ErrorCode::UnknownDataType)
+        {
+            append(reason);
+        }
+        text_[length] = '\0';
+    }
+
+    ErrorCode code_;
+    std::size_t offset_{0};
+    std::uint8_t type_id_{0};
+    std::size_t payload_size_{0};
+    std::array<char, 80> text_{};  ///< Message of a structured error; empty otherwise
 };
 
 /**
@@ -30,7 +193,10 @@ public:
 class PayloadEmptyException : public DecoderException
 {
 public:
-    PayloadEmptyException() : DecoderException("Payload is empty") {}
+    PayloadEmptyException() noexcept
+        : DecoderException(ErrorCode::PayloadEmpty, nullptr, 0, 0, 0)
+    {
+    }
 };
 
 /**
@@ -39,16 +205,15 @@ public:
 class UnknownDataTypeException : public DecoderException
 {
 public:
-    explicit UnknownDataTypeException(unsigned char type)
-        : DecoderException("Unknown data type: 0x" + to_hex(type))
-    {
-    }
-
-private:
-    static std::string to_hex(unsigned char c)
+    /**
+     * @param type Unregistered type id
+     * @param offset Byte offset of the record carrying it
+     * @param payload_size Size of the payload
+     */
+    explicit UnknownDataTypeException(unsigned char type, std::size_t offset = 0,
+                                      std::size_t payload_size = 0) noexcept
+        : DecoderException(ErrorCode::UnknownDataType, nullptr, offset, type, payload_size)
     {
-        const char* hex = "0123456789ABCDEF";
-        return std::string() + hex[c >> 4] + hex[c & 0xF];
     }
 };
 
@@ -59,7 +224,16 @@ class BadPayloadFormatException : public DecoderException
 {
 public:
     explicit BadPayloadFormatException(const std::string& reason)
-        : DecoderException("Bad payload format: " + reason)
+        : DecoderException("Bad payload format: " + reason, ErrorCode::BadPayloadFormat)
+    {
+    }
+
+    /**
+     * @brief Structured form used by the decoder; reason must be static text
+     */
+    BadPayloadFormatException(const char* reason, std::size_t offset, std::uint8_t type_id,
+                              std::size_t payload_size) noexcept
+        : DecoderException(ErrorCode::BadPayloadFormat, reason, offset, type_id, payload_size)
     {
     }
 };
@@ -71,11 +245,22 @@ class UnexpectedException : public DecoderException
 {
 public:
     explicit UnexpectedException(const std::string& reason)
-        : DecoderException("Unexpected error: " + reason)
+        : DecoderException("Unexpected error: " + reason, ErrorCode::Unexpected)
+    {
+    }
+
+    /**
+     * @brief Structured form used by the decoder; reason must be static text
+     */
+    UnexpectedException(const char* reason, std::size_t offset, std::uint8_t type_id,
+                        std::size_t payload_size) noexcept
+        : DecoderException(ErrorCode::Unexpected, reason, offset, type_id, payload_size)
     {
     }
 };
 
+#endif  // CAYENE_NO_EXCEPTIONS
+
 }  // namespace cayene
 
 #endif  // CAYENE_DECODER_ERROR_HPP
\ No newline at end of file
@@ -0,0 +1,117 @@
+#ifndef CAYENE_FILTER_HPP
+#define CAYENE_FILTER_HPP
+
+/**
+ * @file filter.hpp
+ * @brief Record selection by type id and channel for projected decoding
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+namespace cayene
+{
+
+/**
+ * @brief Set of type ids and channels a decode should produce
+ *
+ * A record is selected when its type id is in the type set and its channel
+ * is in the channel set; an empty set selects everything. Records that are
+ * not selected are skipped by their size without decoding their values.
+ */
+class RecordFilter
+{
+public:
+    /**
+     * @brief Create a filter selecting every record
+     */
+    constexpr RecordFilter() noexcept = default;
+
+    /**
+     * @brief Create a filter selecting the given type ids on any channel
+     */
+    [[nodiscard]] static constexpr RecordFilter types(
+        std::initializer_list<std::uint8_t> type_ids) noexcept
+    {
+        RecordFilter filter;
+        for (const std::uint8_t type_id : type_ids)
+        {
+            filter.allow_type(type_id);
+        }
+        return filter;
+    }
+
+    /**
+     * @brief Create a filter selecting any type on the given channels
+     */
+    [[nodiscard]] static constexpr RecordFilter channels(
+        std::initializer_list<std::uint8_t> channels) noexcept
+    {
+        RecordFilter filter;
+        for (const std::uint8_t channel : channels)
+        {
+            filter.allow_channel(channel);
+        }
+        return filter;
+    }
+
+    /**
+     * @brief Add a type id to the selection
+     */
+    constexpr RecordFilter& allow_type(std::uint8_t type_id) noexcept
+    {
+        set(types_, type_id);
+        any_type_ = false;
+        return *this;
+    }
+
+    /**
+     * @brief Add a channel to the selection
+     */
+    constexpr RecordFilter& allow_channel(std::uint8_t channel) noexcept
+    {
+        set(channels_, channel);
+        any_channel_ = false;
+        return *this;
+    }
+
+    /**
+     * @brief Check whether a record is selected
+     */
+    [[nodiscard]] constexpr bool matches(std::uint8_t channel, std::uint8_t type_id) const noexcept
+    {
+        return (any_type_ || test(types_, type_id)) && (any_channel_ || test(channels_, channel));
+    }
+
+    /**
+     * @brief Check whether the filter selects every record
+     */
+    [[nodiscard]] constexpr bool selects_all() const noexcept { return any_type_ && any_channel_; }
+
+private:
+    using Mask = std::array<std::uint64_t, 4>;
+
+    static constexpr void set(Mask& mask, std::uint8_t bit) noexcept
+    {
+        mask[bit >> 6U] |= std::uint64_t{1} << (bit & 63U);
+    }
+
+    [[nodiscard]] static constexpr bool test(const Mask& mask, std::uint8_t bit) noexcept
+    {
+        return ((mask[bit >> 6U] >> (bit & 63U)) & 1U) != 0;
+    }
+
+    Mask types_{};
+    Mask channels_{};
+    bool any_type_{true};
+    bool any_channel_{true};
+};
+
+}  // namespace cayene
+
+#endif  // CAYENE_FILTER_HPP
@@ -0,0 +1,218 @@
+#ifndef CAYENE_FLAT_OBJECT_HPP
+#define CAYENE_FLAT_OBJECT_HPP
+
+/**
+ * @file flat_object.hpp
+ * @brief Flat, insertion-ordered decode output
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "record.hpp"
+
+namespace cayene
+{
+
+/**
+ * @brief One decoded record of a FlatObject
+ */
+struct FlatEntry
+{
+    std::string_view name;  ///< Data type name, owned by the decoder
+    Record record;          ///< Raw values for standard types; data points into the payload
+    nlohmann::json custom;  ///< Decoded value of a custom type, null for standard types
+
+    [[nodiscard]] std::uint8_t channel() const noexcept { return record.channel; }
+    [[nodiscard]] std::uint8_t type_id() const noexcept { return record.type_id; }
+
+    /**
+     * @brief Get a scaled physical value of a standard type
+     */
+    [[nodiscard]] double value(std::size_t index = 0) const noexcept
+    {
+        return record.value(index);
+    }
+
+    /**
+     * @brief Build the key used in the Json output ("<name>_<channel>")
+     */
+    [[nodiscard]] std::string key() const
+    {
+        return std::string(name) + "_" + std::to_string(record.channel);
+    }
+
+    /**
+     * @brief Build the Json value decode() produces for this record
+     */
+    [[nodiscard]] nlohmann::json to_json() const
+    {
+        if (record.value_count == 0)
+        {
+            return custom;
+        }
+        if (record.value_count == 1)
+        {
+            // Types with a divisor of 1 are unsigned integers in the Json output
+            return standard_value_layout(record.type_id).divisor[0] == 1.0
+                       ? nlohmann::json(static_cast<std::uint32_t>(record.raw[0]))
+                       : nlohmann::json(record.value(0));
+        }
+
+        nlohmann::json object = nlohmann::json::object();
+        if (record.type_id == 0x88)
+        {
+            object["latitude"] = record.value(0);
+            object["longitude"] = record.value(1);
+            object["altitude"] = record.value(2);
+        }
+        else
+        {
+            object["x"] = record.value(0);
+            object["y"] = record.value(1);
+            object["z"] = record.value(2);
+        }
+        return object;
+    }
+};
+
+/**
+ * @brief Decode output kept as a flat array of records in payload order
+ *
+ * The first kInlineCapacity entries live inside the object; larger payloads
+ * spill to the heap. A record whose key repeats an earlier one replaces it
+ * in place, matching the Json output of decode(). Reusing one FlatObject
+ * across payloads keeps any spilled capacity.
+ *
+ * Entry names refer to the decoder's types and record data to the payload,
+ * so the object is only valid while both are.
+ */
+class FlatObject
+{
+public:
+    static constexpr std::size_t kInlineCapacity = 8;
+
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+    /**
+     * @brief Records in payload order
+     */
+    [[nodiscard]] std::span<const FlatEntry> entries() const noexcept
+    {
+        return spilled() ? std::span<const FlatEntry>(heap_)
+                         : std::span<const FlatEntry>(inline_.data(), size_);
+    }
+
+    [[nodiscard]] auto begin() const noexcept { return entries().begin(); }
+    [[nodiscard]] auto end() const noexcept { return entries().end(); }
+    [[nodiscard]] const FlatEntry& operator[](std::size_t index) const noexcept
+    {
+        return entries()[index];
+    }
+
+    /**
+     * @brief Find the record stored under "<name>_<channel>"
+     *
+     * @return The entry, or nullptr if there is none
+     */
+    [[nodiscard]] const FlatEntry* find(std::string_view name, std::uint8_t channel) const noexcept
+    {
+        for (const FlatEntry& entry : entries())
+        {
+            if (entry.record.channel == channel && entry.name == name)
+            {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Convert to the Json object decode() returns
+     */
+    [[nodiscard]] nlohmann::json to_json() const
+    {
+        nlohmann::json object = nlohmann::json::object();
+        for (const FlatEntry& entry : entries())
+        {
+            object[entry.key()] = entry.to_json();
+        }
+        return object;
+    }
+
+    /**
+     * @brief Remove every entry
+     */
+    void clear() noexcept
+    {
+        size_ = 0;
+        heap_.clear();
+    }
+
+    /**
+     * @brief Get the entry for a key, appending a new one if it does not exist
+     */
+    FlatEntry& insert(std::string_view name, std::uint8_t channel)
+    {
+        for (FlatEntry& entry : mutable_entries())
+        {
+            if (entry.record.channel == channel && entry.name == name)
+            {
+                return entry;
+            }
+        }
+
+        FlatEntry* entry = nullptr;
+        if (!spilled() && size_ < kInlineCapacity)
+        {
+            entry = &inline_[size_];
+            *entry = FlatEntry{};
+        }
+        else
+        {
+            if (!spilled())
+            {
+                heap_.reserve(2 * kInlineCapacity);
+                for (std::size_t i = 0; i < size_; ++i)
+                {
+                    heap_.push_back(std::move(inline_[i]));
+                }
+            }
+            entry = &heap_.emplace_back();
+        }
+
+        ++size_;
+        entry->name = name;
+        entry->record.channel = channel;
+        return *entry;
+    }
+
+private:
+    [[nodiscard]] bool spilled() const noexcept { return !heap_.empty(); }
+
+    [[nodiscard]] std::span<FlatEntry> mutable_entries() noexcept
+    {
+        return spilled() ? std::span<FlatEntry>(heap_)
+                         : std::span<FlatEntry>(inline_.data(), size_);
+    }
+
+    std::array<FlatEntry, kInlineCapacity> inline_{};
+    std::vector<FlatEntry> heap_;
+    std::size_t size_{0};
+};
+
+}  // namespace cayene
+
+#endif  // CAYENE_FLAT_OBJECT_HPP
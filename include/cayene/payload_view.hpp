@@ -0,0 +1,180 @@
+#ifndef CAYENE_PAYLOAD_VIEW_HPP
+#define CAYENE_PAYLOAD_VIEW_HPP
+
+/**
+ * @file payload_view.hpp
+ * @brief Lazy range of the raw records of a payload
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <span>
+
+#include "decoder.hpp"
+#include "error.hpp"
+#include "record.hpp"
+
+namespace cayene
+{
+
+/**
+ * @brief A record as it appears on the wire, with its values decoded on demand
+ */
+struct RawRecord
+{
+    std::uint8_t channel{0};
+    std::uint8_t type_id{0};
+    std::span<const std::uint8_t> data;
+
+    /**
+     * @brief Decode the typed values of the record
+     *
+     * @return Record whose value_count is 0 for custom types
+     */
+    [[nodiscard]] constexpr Record decode() const noexcept
+    {
+        Record record;
+        record.channel = channel;
+        record.type_id = type_id;
+        record.data = data;
+        record.value_count = read_raw_values(type_id, data, record.raw);
+        return record;
+    }
+
+    /**
+     * @brief Decode one scaled physical value
+     *
+     * @param index Value index (0 for scalar types, 0-2 for x/y/z and lat/lon/alt)
+     */
+    [[nodiscard]] constexpr double value(std::size_t index = 0) const noexcept
+    {
+        return decode().value(index);
+    }
+};
+
+/**
+ * @brief Forward range over the records of a validated payload
+ *
+ * The payload is validated once on construction; iterating only reads the
+ * two header bytes of each record and steps over its data. An invalid
+ * payload yields an empty range and reports why through status().
+ *
+ * The view refers to the payload and the decoder without owning them: both
+ * must outlive it, and no custom type may be added or removed meanwhile.
+ */
+class PayloadView : public std::ranges::view_interface<PayloadView>
+{
+public:
+    class Iterator
+    {
+    public:
+        using iterator_concept = std::forward_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = RawRecord;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        [[nodiscard]] RawRecord operator*() const noexcept
+        {
+            return {payload_[offset_], payload_[offset_ + 1],
+                    payload_.subspan(offset_ + 2, next_ - offset_ - 2)};
+        }
+
+        Iterator& operator++() noexcept
+        {
+            offset_ = next_;
+            next_ = record_end(offset_);
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept
+        {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        [[nodiscard]] friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept
+        {
+            return lhs.offset_ == rhs.offset_;
+        }
+
+    private:
+        friend class PayloadView;
+
+        Iterator(const Decoder* decoder, std::span<const std::uint8_t> payload,
+                 std::size_t offset) noexcept
+            : decoder_(decoder), payload_(payload), offset_(offset), next_(record_end(offset))
+        {
+        }
+
+        // Only called on validated payloads, so every type is known and complete
+        [[nodiscard]] std::size_t record_end(std::size_t offset) const noexcept
+        {
+            return offset < payload_.size()
+                       ? offset + 2 + decoder_->find_type(payload_[offset + 1])->size
+                       : offset;
+        }
+
+        const Decoder* decoder_{nullptr};
+        std::span<const std::uint8_t> payload_;
+        std::size_t offset_{0};
+        std::size_t next_{0};
+    };
+
+    PayloadView() = default;
+
+    /**
+     * @brief Validate a payload and view its records
+     *
+     * @param decoder Decoder providing the registered type sizes
+     * @param encoded_payload The raw payload bytes
+     */
+    PayloadView(const Decoder& decoder, std::span<const std::uint8_t> encoded_payload) noexcept
+        : decoder_(&decoder),
+          payload_(encoded_payload),
+          status_(decoder.validate(encoded_payload))
+    {
+        if (!status_)
+        {
+            payload_ = {};
+        }
+    }
+
+    [[nodiscard]] Iterator begin() const noexcept { return {decoder_, payload_, 0}; }
+    [[nodiscard]] Iterator end() const noexcept { return {decoder_, payload_, payload_.size()}; }
+
+    /**
+     * @brief Number of records (0 if the payload is invalid)
+     */
+    [[nodiscard]] std::size_t size() const noexcept { return status_ ? status_.count : 0; }
+
+    /**
+     * @brief Validation result, with the offset and type id of the first bad record
+     */
+    [[nodiscard]] const DecodeStatus& status() const noexcept { return status_; }
+
+    /**
+     * @brief Check whether the payload is well formed
+     */
+    [[nodiscard]] bool valid() const noexcept { return status_.ok(); }
+
+private:
+    const Decoder* decoder_{nullptr};
+    std::span<const std::uint8_t> payload_;
+    DecodeStatus status_{.code = ErrorCode::PayloadEmpty};
+};
+
+}  // namespace cayene
+
+// Iterators point into the payload, not into the view, so they outlive it
+template <>
+inline constexpr bool std::ranges::enable_borrowed_range<cayene::PayloadView> = true;
+
+#endif  // CAYENE_PAYLOAD_VIEW_HPP
@@ -0,0 +1,749 @@
+#ifndef CAYENE_PIPELINE_HPP
+#define CAYENE_PIPELINE_HPP
+
+/**
+ * @file pipeline.hpp
+ * @brief Sharded multi-threaded ingest/decode pipeline over SPSC rings
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "affinity.hpp"
+#include "decoder.hpp"
+#include "filter.hpp"
+#include "record.hpp"
+#include "spsc_ring.hpp"
+#include "trace.hpp"
+
+namespace cayene
+{
+
+/**
+ * @brief Largest payload a pipeline accepts (LoRaWAN application payloads are at most 242)
+ */
+inline constexpr std::size_t kMaxPipelinePayload = 256;
+
+/**
+ * @brief An encoded payload and where it came from; does not own the bytes
+ */
+struct PayloadRef
+{
+    std::uint32_t device{0};
+    std::uint64_t timestamp{0};
+    std::span<const std::uint8_t> payload;
+};
+
+/**
+ * @brief A decoded payload handed to a sink
+ *
+ * The payload bytes and the records' data only live for the duration of
+ * the sink call.
+ */
+struct DecodedPayload
+{
+    std::uint32_t device{0};
+    std::uint64_t timestamp{0};
+    std::span<const std::uint8_t> payload;
+    std::span<const Record> records;  ///< Records decoded before any error
+    DecodeStatus status;
+};
+
+/**
+ * @brief Destination of decoded payloads
+ *
+ * consume() is called concurrently from every worker thread, each passing
+ * its own index, so per-worker state needs no locking.
+ */
+class PipelineSink
+{
+public:
+    virtual ~PipelineSink() = default;
+
+    /**
+     * @brief Receive one decoded payload on worker thread worker
+     */
+    virtual void consume(std::size_t worker, const DecodedPayload& result) = 0;
+
+    /**
+     * @brief Called by each worker once its rings are drained on stop()
+     */
+    virtual void flush(std::size_t /*worker*/) {}
+};
+
+/**
+ * @brief Sink counting payloads, records and failures per worker
+ *
+ * Read the totals once the pipeline is stopped.
+ */
+class CountingSink final : public PipelineSink
+{
+public:
+    explicit CountingSink(std::size_t workers) : counters_(workers) {}
+
+    void consume(std::size_t worker, const DecodedPayload& result) override
+    {
+        Counters& counters = counters_[worker];
+        ++counters.payloads;
+        counters.records += result.records.size();
+        counters.failures += result.status.ok() ? 0U : 1U;
+    }
+
+    [[nodiscard]] std::uint64_t payloads() const noexcept { return sum(&Counters::payloads); }
+    [[nodiscard]] std::uint64_t records() const noexcept { return sum(&Counters::records); }
+    [[nodiscard]] std::uint64_t failures() const noexcept { return sum(&Counters::failures); }
+
+    /**
+     * @brief Payloads consumed by one worker
+     */
+    [[nodiscard]] std::uint64_t payloads(std::size_t worker) const noexcept
+    {
+        return counters_[worker].payloads;
+    }
+
+private:
+    struct alignas(64) Counters
+    {
+        std::uint64_t payloads{0};
+        std::uint64_t records{0};
+        std::uint64_t failures{0};
+    };
+
+    [[nodiscard]] std::uint64_t sum(std::uint64_t Counters::*field) const noexcept
+    {
+        std::uint64_t total = 0;
+        for (const Counters& counters : counters_)
+        {
+            total += counters.*field;
+        }
+        return total;
+    }
+
+    std::vector<Counters> counters_;
+};
+
+/**
+ * @brief Sink forwarding every payload to a callable
+ *
+ * The callable runs on the worker threads and must be safe to call
+ * concurrently for different worker indices.
+ */
+class FunctionSink final : public PipelineSink
+{
+public:
+    using Function = std::function<void(std::size_t, const DecodedPayload&)>;
+
+    explicit FunctionSink(Function function) : function_(std::move(function)) {}
+
+    void consume(std::size_t worker, const DecodedPayload& result) override
+    {
+        function_(worker, result);
+    }
+
+private:
+    Function function_;
+};
+
+/**
+ * @brief Pipeline sizing
+ */
+struct PipelineConfig
+{
+    std::size_t producers{1};         ///< Ingest threads, each using its own producer()
+    std::size_t workers{1};           ///< Decode threads
+    std::size_t ring_capacity{1024};  ///< Payloads per producer/worker ring
+    std::size_t max_records{64};      ///< Records decoded per payload before BufferTooSmall
+    RecordFilter filter{};            ///< Records to decode
+    CpuPlacement placement{CpuPlacement::None};  ///< Pinning of the decode threads
+    CpuTopology topology{};  ///< Nodes to place workers on; detected when empty and pinning
+};
+
+/**
+ * @brief Outcome of submitting a payload
+ */
+enum class SubmitStatus : std::uint8_t
+{
+    Accepted,  ///< Queued for decoding
+    Full,      ///< The target ring is full (try_submit only)
+    TooLarge,  ///< Larger than kMaxPipelinePayload; never queued
+};
+
+/**
+ * @brief Counters of a pipeline, summed over producers and workers
+ */
+struct PipelineStats
+{
+    std::uint64_t submitted{0};     ///< Payloads accepted
+    std::uint64_t rejected{0};      ///< try_submit calls refused because a ring was full
+    std::uint64_t too_large{0};     ///< Payloads refused for their size
+    std::uint64_t backpressure{0};  ///< submit calls that had to wait for ring space
+    std::uint64_t decoded{0};       ///< Payloads handed to the sink
+    std::uint64_t failed{0};        ///< ... of which did not decode cleanly
+    std::uint64_t unpinned{0};      ///< Workers that could not be pinned as configured
+};
+
+/**
+ * @brief Load of one worker's partition
+ */
+struct WorkerLoad
+{
+    std::uint64_t decoded{0};       ///< Payloads decoded so far
+    std::size_t queued{0};          ///< Payloads waiting in the worker's rings now
+    std::size_t peak_queued{0};     ///< Largest backlog the worker has found when polling
+    std::uint32_t top_device{0};    ///< Device with the most payloads (estimate)
+    std::uint64_t top_payloads{0};  ///< Its payload count (upper bound)
+    bool hot{false};                ///< decoded exceeds the mean by the hot factor
+};
+
+/**
+ * @brief Distribution of load over the worker partitions
+ */
+struct PartitionSkew
+{
+    std::vector<WorkerLoad> workers;
+    double mean{0.0};          ///< Mean payloads decoded per worker
+    std::uint64_t max{0};      ///< Payloads decoded by the busiest worker
+    std::size_t busiest{0};    ///< Index of the busiest worker
+    double imbalance{1.0};     ///< max / mean; 1.0 is a perfectly even split
+    std::size_t hot_count{0};  ///< Workers flagged hot
+};
+
+/**
+ * @brief Sharded ingest/decode runtime
+ *
+ * Each of the P ingest threads owns one Producer; each of the W workers
+ * owns a decode thread. Every (producer, worker) pair has its own bounded
+ * single-producer/single-consumer ring, so no two threads ever contend for
+ * a ring index. A payload goes to the worker chosen by worker_of(device),
+ * which keeps a device's payloads in order and on one worker (and matches
+ * ShadowTable::shard_of() when the shard and worker counts are equal).
+ *
+ * Partitioning by device, rather than stealing work, is what lets sinks
+ * keep per-device state (deltas, report-on-change, shadows) without locks.
+ * The price is that one busy device loads one worker; skew() reports the
+ * load of each partition, its backlog and its heaviest device.
+ *
+ * Memory is bounded by P * W * ring_capacity fixed-size slots. When a ring
+ * is full, try_submit() reports it and submit() waits: producers are slowed
+ * to the decode rate instead of queuing without limit.
+ *
+ * With a CpuPlacement, workers are spread over the NUMA nodes in
+ * contiguous blocks and pinned, and each worker's rings, counters and
+ * record buffer are allocated on its node. Producers are counted onto the
+ * nodes the same way: an ingest thread calls Producer::pin() and, to stay
+ * on one socket end to end, submits only devices whose node_of() matches.
+ * The Decoder stays shared; it is only read while running, so each socket
+ * keeps its own cached copy of its tables without coherence traffic.
+ */
+class Pipeline
+{
+    struct Message
+    {
+        std::uint64_t timestamp{0};
+        std::uint32_t device{0};
+        std::uint16_t size{0};
+        std::array<std::uint8_t, kMaxPipelinePayload> bytes{};
+    };
+
+    // Counter written by a single thread and read by any
+    class Counter
+    {
+    public:
+        void increment() noexcept
+        {
+            value_.store(value_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        void store(std::uint64_t value) noexcept
+        {
+            value_.store(value, std::memory_order_relaxed);
+        }
+        [[nodiscard]] std::uint64_t load() const noexcept
+        {
+            return value_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<std::uint64_t> value_{0};
+    };
+
+public:
+    /**
+     * @brief Submission handle of one ingest thread
+     */
+    class Producer
+    {
+    public:
+        /**
+         * @brief Queue a payload without waiting
+         */
+        SubmitStatus try_submit(std::uint32_t device, std::uint64_t timestamp,
+                                std::span<const std::uint8_t> payload) noexcept
+        {
+            CAYENE_TRACE_SCOPE(trace::Stage::Ingest);
+            const SubmitStatus status = enqueue(device, timestamp, payload);
+            if (status == SubmitStatus::Full)
+            {
+                rejected_.increment();
+            }
+            return status;
+        }
+
+        /**
+         * @brief Queue a payload, waiting while its worker's ring is full
+         *
+         * @return Accepted, or TooLarge
+         */
+        SubmitStatus submit(std::uint32_t device, std::uint64_t timestamp,
+                            std::span<const std::uint8_t> payload) noexcept
+        {
+            // One span per submission, covering any wait for a full ring
+            CAYENE_TRACE_SCOPE(trace::Stage::Ingest);
+            SubmitStatus status = enqueue(device, timestamp, payload);
+            if (status == SubmitStatus::Full)
+            {
+                backpressure_.increment();
+                do
+                {
+                    std::this_thread::yield();
+                    status = enqueue(device, timestamp, payload);
+                } while (status == SubmitStatus::Full);
+            }
+            return status;
+        }
+
+        /**
+         * @brief Pin the calling ingest thread to the CPUs of node()
+         *
+         * @return false with errno set if it could not be pinned (EINVAL
+         *         when the pipeline was built without placement)
+         */
+        bool pin() noexcept
+        {
+            if (pipeline_.config_.placement == CpuPlacement::None)
+            {
+                errno = EINVAL;
+                return false;
+            }
+            return pin_current_thread(pipeline_.config_.topology.nodes[node()]);
+        }
+
+        /**
+         * @brief NUMA node this producer is placed on, counted like the workers'
+         */
+        [[nodiscard]] std::size_t node() const noexcept
+        {
+            return pipeline_.config_.topology.node_of(index_, pipeline_.config_.producers);
+        }
+
+    private:
+        friend class Pipeline;
+
+        Producer(Pipeline& pipeline, std::size_t index) : pipeline_(pipeline), index_(index) {}
+
+        SubmitStatus enqueue(std::uint32_t device, std::uint64_t timestamp,
+                             std::span<const std::uint8_t> payload) noexcept
+        {
+            if (payload.size() > kMaxPipelinePayload)
+            {
+                too_large_.increment();
+                return SubmitStatus::TooLarge;
+            }
+            SpscRing<Message>& ring = pipeline_.ring(index_, pipeline_.worker_of(device));
+            Message* message = ring.claim();
+            if (message == nullptr)
+            {
+                return SubmitStatus::Full;
+            }
+            message->timestamp = timestamp;
+            message->device = device;
+            message->size = static_cast<std::uint16_t>(payload.size());
+            if (!payload.empty())
+            {
+                std::memcpy(message->bytes.data(), payload.data(), payload.size());
+            }
+            ring.publish();
+            submitted_.increment();
+            return SubmitStatus::Accepted;
+        }
+
+        Pipeline& pipeline_;
+        std::size_t index_;
+        Counter submitted_;
+        Counter rejected_;
+        Counter too_large_;
+        Counter backpressure_;
+    };
+
+    /**
+     * @brief Create a stopped pipeline
+     *
+     * @param decoder Decoder shared by the workers; must not be modified while running
+     * @param sink Destination of every decoded payload
+     * @param config Thread counts and ring sizes
+     */
+    Pipeline(const Decoder& decoder, PipelineSink& sink, const PipelineConfig& config = {})
+        : decoder_(decoder), sink_(sink), config_(config)
+    {
+        config_.producers = std::max<std::size_t>(config_.producers, 1);
+        config_.workers = std::max<std::size_t>(config_.workers, 1);
+        config_.max_records = std::max<std::size_t>(config_.max_records, 1);
+
+        if (config_.placement != CpuPlacement::None && config_.topology.nodes.empty())
+        {
+            config_.topology = CpuTopology::detect();
+        }
+
+        rings_.resize(config_.producers * config_.workers);
+        workers_.resize(config_.workers);
+        if (config_.placement == CpuPlacement::None)
+        {
+            for (std::size_t worker = 0; worker < config_.workers; ++worker)
+            {
+                allocate_worker(worker);
+            }
+        }
+        else
+        {
+            // A worker's rings and counters are first touched on its node, so
+            // the decode side of every ring is local memory
+            for (std::size_t node = 0; node < config_.topology.node_count(); ++node)
+            {
+                run_on_cpus(config_.topology.nodes[node],
+                            [this, node]()
+                            {
+                                for (std::size_t worker = 0; worker < config_.workers; ++worker)
+                                {
+                                    if (node_of_worker(worker) == node)
+                                    {
+                                        allocate_worker(worker);
+                                    }
+                                }
+                            });
+            }
+        }
+        for (std::size_t p = 0; p < config_.producers; ++p)
+        {
+            producers_.push_back(std::unique_ptr<Producer>(new Producer(*this, p)));
+        }
+    }
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    ~Pipeline() { stop(); }
+
+    /**
+     * @brief Start the worker threads
+     */
+    void start()
+    {
+        if (!threads_.empty())
+        {
+            return;
+        }
+        stopping_.store(false, std::memory_order_relaxed);
+        for (std::size_t worker = 0; worker < config_.workers; ++worker)
+        {
+            threads_.emplace_back([this, worker]() { run(worker); });
+        }
+    }
+
+    /**
+     * @brief Decode everything queued, flush the sink and join the workers
+     *
+     * Producers must have stopped submitting before this is called.
+     */
+    void stop()
+    {
+        stopping_.store(true, std::memory_order_release);
+        for (std::thread& thread : threads_)
+        {
+            thread.join();
+        }
+        threads_.clear();
+    }
+
+    [[nodiscard]] std::size_t producer_count() const noexcept { return config_.producers; }
+    [[nodiscard]] std::size_t worker_count() const noexcept { return config_.workers; }
+
+    /**
+     * @brief Get the submission handle of ingest thread index
+     */
+    [[nodiscard]] Producer& producer(std::size_t index) noexcept { return *producers_[index]; }
+
+    /**
+     * @brief Get the worker that decodes a device's payloads
+     */
+    [[nodiscard]] std::size_t worker_of(std::uint32_t device) const noexcept
+    {
+        return static_cast<std::size_t>(((device * 0x9E3779B97F4A7C15ULL) >> 32U) %
+                                        config_.workers);
+    }
+
+    /**
+     * @brief Nodes the threads are placed on; empty without placement
+     */
+    [[nodiscard]] const CpuTopology& topology() const noexcept { return config_.topology; }
+
+    /**
+     * @brief NUMA node a worker is placed on (0 without placement)
+     */
+    [[nodiscard]] std::size_t node_of_worker(std::size_t worker) const noexcept
+    {
+        return config_.topology.node_of(worker, config_.workers);
+    }
+
+    /**
+     * @brief NUMA node that decodes a device's payloads
+     *
+     * Submitting a device's payloads from a producer on this node keeps the
+     * whole path, ring included, on one socket.
+     */
+    [[nodiscard]] std::size_t node_of(std::uint32_t device) const noexcept
+    {
+        return node_of_worker(worker_of(device));
+    }
+
+    /**
+     * @brief Snapshot of the per-worker load; safe to call while running
+     *
+     * @param hot_factor A worker is hot when it decoded more than hot_factor
+     *                   times the mean
+     */
+    [[nodiscard]] PartitionSkew skew(double hot_factor = 1.5) const
+    {
+        PartitionSkew skew;
+        skew.workers.resize(config_.workers);
+        std::uint64_t total = 0;
+        for (std::size_t worker = 0; worker < config_.workers; ++worker)
+        {
+            const WorkerState& state = *workers_[worker];
+            WorkerLoad& load = skew.workers[worker];
+            load.decoded = state.decoded.load();
+            load.peak_queued = static_cast<std::size_t>(state.peak_queued.load());
+            for (std::size_t p = 0; p < config_.producers; ++p)
+            {
+                load.queued += rings_[(p * config_.workers) + worker]->size();
+            }
+            for (const TrackedDevice& tracked : state.devices)
+            {
+                if (tracked.payloads.load() > load.top_payloads)
+                {
+                    load.top_payloads = tracked.payloads.load();
+                    load.top_device = tracked.device.load(std::memory_order_relaxed);
+                }
+            }
+            total += load.decoded;
+            if (load.decoded > skew.max)
+            {
+                skew.max = load.decoded;
+                skew.busiest = worker;
+            }
+        }
+
+        skew.mean = static_cast<double>(total) / static_cast<double>(config_.workers);
+        if (total != 0)
+        {
+            skew.imbalance = static_cast<double>(skew.max) / skew.mean;
+        }
+        for (WorkerLoad& load : skew.workers)
+        {
+            load.hot = total != 0 && static_cast<double>(load.decoded) > hot_factor * skew.mean;
+            if (load.hot)
+            {
+                ++skew.hot_count;
+            }
+        }
+        return skew;
+    }
+
+    /**
+     * @brief Snapshot of the counters; safe to call while running
+     */
+    [[nodiscard]] PipelineStats stats() const noexcept
+    {
+        PipelineStats stats;
+        for (const auto& producer : producers_)
+        {
+            stats.submitted += producer->submitted_.load();
+            stats.rejected += producer->rejected_.load();
+            stats.too_large += producer->too_large_.load();
+            stats.backpressure += producer->backpressure_.load();
+        }
+        for (std::size_t worker = 0; worker < config_.workers; ++worker)
+        {
+            stats.decoded += workers_[worker]->decoded.load();
+            stats.failed += workers_[worker]->failed.load();
+        }
+        stats.unpinned = unpinned_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    // Devices whose payload counts a worker tracks to name the source of its load
+    static constexpr std::size_t kTrackedDevices = 4;
+
+    struct TrackedDevice
+    {
+        std::atomic<std::uint32_t> device{0};
+        Counter payloads;
+    };
+
+    // Written by its worker thread only
+    struct alignas(64) WorkerState
+    {
+        Counter decoded;
+        Counter failed;
+        Counter peak_queued;
+        std::array<TrackedDevice, kTrackedDevices> devices{};
+
+        // Space-saving heavy-hitter count: an untracked device takes over the
+        // least counted slot and inherits its count, so a device's count never
+        // under-estimates it and any device above 1/kTrackedDevices of the load
+        // is tracked
+        void count_device(std::uint32_t device) noexcept
+        {
+            TrackedDevice* least = &devices[0];
+            for (TrackedDevice& tracked : devices)
+            {
+                if (tracked.payloads.load() != 0 &&
+                    tracked.device.load(std::memory_order_relaxed) == device)
+                {
+                    tracked.payloads.increment();
+                    return;
+                }
+                if (tracked.payloads.load() < least->payloads.load())
+                {
+                    least = &tracked;
+                }
+            }
+            least->device.store(device, std::memory_order_relaxed);
+            least->payloads.increment();
+        }
+    };
+
+    // Rings are laid out producer-major: producer p owns [p * W, (p + 1) * W)
+    SpscRing<Message>& ring(std::size_t producer, std::size_t worker) noexcept
+    {
+        return *rings_[(producer * config_.workers) + worker];
+    }
+
+    void allocate_worker(std::size_t worker)
+    {
+        for (std::size_t p = 0; p < config_.producers; ++p)
+        {
+            rings_[(p * config_.workers) + worker] =
+                std::make_unique<SpscRing<Message>>(config_.ring_capacity);
+        }
+        workers_[worker] = std::make_unique<WorkerState>();
+    }
+
+    // Drains up to one batch from each of the worker's rings; returns false if all were empty
+    bool poll(std::size_t worker, std::vector<Record>& records)
+    {
+        constexpr std::size_t kBatch = 32;
+        WorkerState& state = *workers_[worker];
+        bool any = false;
+        std::size_t queued = 0;
+        for (std::size_t p = 0; p < config_.producers; ++p)
+        {
+            SpscRing<Message>& ring = this->ring(p, worker);
+            for (std::size_t n = 0; n < kBatch; ++n)
+            {
+                const Message* message = ring.front();
+                if (n == 0)
+                {
+                    // The backlog the first front() saw, without another load of the tail
+                    queued += ring.known_size();
+                }
+                if (message == nullptr)
+                {
+                    break;
+                }
+                any = true;
+
+                DecodedPayload result;
+                result.device = message->device;
+                result.timestamp = message->timestamp;
+                result.payload = std::span(message->bytes.data(), message->size);
+                result.status = decoder_.decode_records(result.payload, records, config_.filter);
+                result.records = std::span<const Record>(records).first(
+                    std::min<std::size_t>(result.status.count, records.size()));
+
+                {
+                    CAYENE_TRACE_SCOPE(trace::Stage::SinkWrite);
+                    sink_.consume(worker, result);
+                }
+                state.decoded.increment();
+                state.count_device(result.device);
+                if (!result.status.ok())
+                {
+                    state.failed.increment();
+                }
+                ring.pop();
+            }
+        }
+        if (queued > state.peak_queued.load())
+        {
+            state.peak_queued.store(queued);
+        }
+        return any;
+    }
+
+    void run(std::size_t worker)
+    {
+        if (config_.placement != CpuPlacement::None &&
+            !pin_current_thread(
+                config_.topology.cpus_for(worker, config_.workers, config_.placement)))
+        {
+            unpinned_.fetch_add(1, std::memory_order_relaxed);
+        }
+        // Allocated after pinning, so the record buffer is local too
+        std::vector<Record> records(config_.max_records);
+        while (true)
+        {
+            if (poll(worker, records))
+            {
+                continue;
+            }
+            if (stopping_.load(std::memory_order_acquire))
+            {
+                // Producers are done: one last pass drains anything published before stop()
+                while (poll(worker, records))
+                {
+                }
+                break;
+            }
+            std::this_thread::yield();
+        }
+        sink_.flush(worker);
+    }
+
+    const Decoder& decoder_;
+    PipelineSink& sink_;
+    PipelineConfig config_;
+    std::vector<std::unique_ptr<SpscRing<Message>>> rings_;
+    std::vector<std::unique_ptr<Producer>> producers_;
+    std::vector<std::unique_ptr<WorkerState>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<std::uint64_t> unpinned_{0};
+};
+
+}  // namespace cayene
+
+#endif  // CAYENE_PIPELINE_HPP
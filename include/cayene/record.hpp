@@ -0,0 +1,143 @@
+#ifndef CAYENE_RECORD_HPP
+#define CAYENE_RECORD_HPP
+
+/**
+ * @file record.hpp
+ * @brief Typed, allocation-free representation of decoded records
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace cayene
+{
+
+/**
+ * @brief Maximum number of values carried by a standard data type (x/y/z, lat/lon/alt)
+ */
+inline constexpr std::size_t kMaxRecordValues = 3;
+
+/**
+ * @brief Wire layout of the values of a standard data type
+ *
+ * Values are big-endian integers of @c width bytes; the physical value is
+ * the raw integer divided by the matching divisor.
+ */
+struct ValueLayout
+{
+    std::uint8_t count{0};
+    std::uint8_t width{0};
+    bool is_signed{false};
+    std::array<double, kMaxRecordValues> divisor{1.0, 1.0, 1.0};
+};
+
+/**
+ * @brief Get the value layout of a standard data type
+ *
+ * @param type_id The type identifier
+ * @return Layout of the type, with a count of 0 for non-standard types
+ */
+[[nodiscard]] constexpr ValueLayout standard_value_layout(std::uint8_t type_id) noexcept
+{
+    switch (type_id)
+    {
+        case 0x00:  // Digital Input
+        case 0x01:  // Digital Output
+        case 0x66:  // Presence
+            return {1, 1, false, {1.0, 1.0, 1.0}};
+        case 0x02:  // Analog Input
+        case 0x03:  // Analog Output
+            return {1, 2, true, {100.0, 1.0, 1.0}};
+        case 0x65:  // Luminosity
+            return {1, 2, false, {1.0, 1.0, 1.0}};
+        case 0x67:  // Temperature
+            return {1, 2, true, {10.0, 1.0, 1.0}};
+        case 0x68:  // Humidity
+        case 0x73:  // Barometer
+            return {1, 2, false, {10.0, 1.0, 1.0}};
+        case 0x71:  // Accelerometer
+            return {3, 2, true, {1000.0, 1000.0, 1000.0}};
+        case 0x86:  // Gyrometer
+            return {3, 2, true, {100.0, 100.0, 100.0}};
+        case 0x88:  // GPS
+            return {3, 3, true, {10000.0, 10000.0, 100.0}};
+        default:
+            return {};
+    }
+}
+
+/**
+ * @brief Read the raw values of a standard type from its big-endian data bytes
+ *
+ * @param type_id The type identifier
+ * @param data Record data, at least count * width bytes long
+ * @param raw Receives the raw fixed-point values
+ * @return Number of values read (0 for non-standard types)
+ */
+constexpr std::uint8_t read_raw_values(std::uint8_t type_id, std::span<const std::uint8_t> data,
+                                       std::array<std::int32_t, kMaxRecordValues>& raw) noexcept
+{
+    const ValueLayout layout = standard_value_layout(type_id);
+    for (std::size_t i = 0; i < layout.count; ++i)
+    {
+        const std::uint8_t* field = data.data() + (i * layout.width);
+        switch (layout.width)
+        {
+            case 1:
+                raw[i] = field[0];
+                break;
+            case 2:
+            {
+                const auto bits = static_cast<std::uint16_t>((field[0] << 8U) | field[1]);
+                raw[i] = layout.is_signed ? std::int32_t{static_cast<std::int16_t>(bits)}
+                                          : std::int32_t{bits};
+                break;
+            }
+            default:
+            {
+                const auto bits = (std::uint32_t{field[0]} << 16U) |
+                                  (std::uint32_t{field[1]} << 8U) | field[2];
+                // Sign-extend from 24 bits
+                raw[i] = layout.is_signed ? static_cast<std::int32_t>(bits << 8U) >> 8U
+                                          : static_cast<std::int32_t>(bits);
+                break;
+            }
+        }
+    }
+    return layout.count;
+}
+
+/**
+ * @brief A single decoded record
+ *
+ * Standard types carry their raw fixed-point values; custom types only
+ * expose their bytes (value_count is 0) since their decoders produce JSON.
+ * The data span points into the decoded payload and shares its lifetime.
+ */
+struct Record
+{
+    std::uint8_t channel{0};
+    std::uint8_t type_id{0};
+    std::uint8_t value_count{0};
+    std::span<const std::uint8_t> data;
+    std::array<std::int32_t, kMaxRecordValues> raw{};
+
+    /**
+     * @brief Get a scaled physical value
+     *
+     * @param index Value index (0 for scalar types, 0-2 for x/y/z and lat/lon/alt)
+     */
+    [[nodiscard]] constexpr double value(std::size_t index = 0) const noexcept
+    {
+        return static_cast<double>(raw[index]) / standard_value_layout(type_id).divisor[index];
+    }
+};
+
+}  // namespace cayene
+
+#endif  // CAYENE_RECORD_HPP
@@ -0,0 +1,431 @@
+#ifndef CAYENE_SERIES_STORE_HPP
+#define CAYENE_SERIES_STORE_HPP
+
+/**
+ * @file series_store.hpp
+ * @brief Compressed in-memory time series of decoded raw values
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "decoder.hpp"
+#include "filter.hpp"
+#include "record.hpp"
+
+namespace cayene
+{
+
+/**
+ * @brief One point of a CompressedSeries
+ */
+struct SeriesPoint
+{
+    std::uint64_t timestamp{0};
+    std::uint8_t type_id{0};
+    std::array<std::int32_t, kMaxRecordValues> raw{};
+
+    /**
+     * @brief Get a scaled physical value
+     */
+    [[nodiscard]] constexpr double value(std::size_t index = 0) const noexcept
+    {
+        return static_cast<double>(raw[index]) / standard_value_layout(type_id).divisor[index];
+    }
+};
+
+/**
+ * @brief Append-only series of the raw values of one standard type
+ *
+ * Points are packed into a bit stream: timestamps as zigzag-encoded
+ * delta-of-deltas and values as zigzag-encoded deltas of the raw fixed-point
+ * integers, each with a short prefix selecting the field width. A regular
+ * reporting interval and a slowly moving value cost about 2 bits per point.
+ *
+ * The stream is cut into blocks of kBlockPoints points that each start from
+ * an uncompressed point, so old data can be dropped a block at a time.
+ */
+class CompressedSeries
+{
+public:
+    static constexpr std::size_t kBlockPoints = 512;
+
+    /**
+     * @brief Create an empty series of a standard type
+     */
+    explicit CompressedSeries(std::uint8_t type_id = 0) noexcept
+        : type_id_(type_id), value_count_(standard_value_layout(type_id).count)
+    {
+    }
+
+    /**
+     * @brief Append a point
+     *
+     * @param timestamp Timestamp in any unit; out-of-order points are stored as given
+     * @param raw Raw values, of which the type's value count are used
+     */
+    void append(std::uint64_t timestamp, const std::array<std::int32_t, kMaxRecordValues>& raw)
+    {
+        if (blocks_.empty() || blocks_.back().count == kBlockPoints)
+        {
+            if (!blocks_.empty())
+            {
+                blocks_.back().words.shrink_to_fit();
+            }
+            Block& block = blocks_.emplace_back();
+            block.first_timestamp = timestamp;
+            block.write(timestamp, 64);
+            for (std::size_t i = 0; i < value_count_; ++i)
+            {
+                block.write(zigzag(raw[i]), 32);
+            }
+        }
+        else
+        {
+            Block& block = blocks_.back();
+            // Unsigned arithmetic wraps, so any pair of timestamps round-trips
+            const std::uint64_t delta = timestamp - block.last_timestamp;
+            block.write_classed(zigzag(static_cast<std::int64_t>(delta - block.last_delta)),
+                                kTimestampWidths);
+            block.last_delta = delta;
+            for (std::size_t i = 0; i < value_count_; ++i)
+            {
+                block.write_classed(zigzag(std::int64_t{raw[i]} - block.last_raw[i]),
+                                    kValueWidths);
+            }
+        }
+
+        Block& block = blocks_.back();
+        block.last_timestamp = timestamp;
+        block.last_raw = raw;
+        ++block.count;
+        ++size_;
+    }
+
+    /**
+     * @brief Call a visitor for every point, oldest first
+     *
+     * @param visitor Callable invoked as visitor(const SeriesPoint&)
+     */
+    template <typename Visitor>
+    void for_each(Visitor&& visitor) const
+    {
+        for (const Block& block : blocks_)
+        {
+            decode_block(block, visitor);
+        }
+    }
+
+    /**
+     * @brief Call a visitor for every point with from <= timestamp < to
+     *
+     * Blocks entirely outside the range are skipped without decoding, which
+     * assumes timestamps were appended in order.
+     */
+    template <typename Visitor>
+    void for_each(std::uint64_t from, std::uint64_t to, Visitor&& visitor) const
+    {
+        for (const Block& block : blocks_)
+        {
+            if (block.last_timestamp < from || block.first_timestamp >= to)
+            {
+                continue;
+            }
+            decode_block(block,
+                         [from, to, &visitor](const SeriesPoint& point)
+                         {
+                             if (point.timestamp >= from && point.timestamp < to)
+                             {
+                                 visitor(point);
+                             }
+                         });
+        }
+    }
+
+    /**
+     * @brief Drop every block whose points are all older than a cutoff
+     *
+     * @return Number of points dropped
+     */
+    std::size_t drop_before(std::uint64_t cutoff)
+    {
+        std::size_t dropped = 0;
+        while (!blocks_.empty() && blocks_.front().last_timestamp < cutoff)
+        {
+            dropped += blocks_.front().count;
+            blocks_.pop_front();
+        }
+        size_ -= dropped;
+        return dropped;
+    }
+
+    [[nodiscard]] std::uint8_t type_id() const noexcept { return type_id_; }
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+    /**
+     * @brief Heap and object memory used by the series, in bytes
+     */
+    [[nodiscard]] std::size_t memory_bytes() const noexcept
+    {
+        std::size_t bytes = sizeof(*this);
+        for (const Block& block : blocks_)
+        {
+            bytes += sizeof(Block) + (block.words.capacity() * sizeof(std::uint64_t));
+        }
+        return bytes;
+    }
+
+private:
+    // Field widths by prefix class: class k is written as k one bits, a zero
+    // bit unless k is the last class, then widths[k] bits of zigzag payload
+    static constexpr std::array<unsigned, 5> kTimestampWidths{0, 7, 12, 20, 64};
+    static constexpr std::array<unsigned, 5> kValueWidths{0, 7, 15, 24, 33};
+
+    struct Block
+    {
+        std::vector<std::uint64_t> words;
+        std::size_t bits{0};
+        std::uint32_t count{0};
+        std::uint64_t first_timestamp{0};
+        std::uint64_t last_timestamp{0};
+        std::uint64_t last_delta{0};
+        std::array<std::int32_t, kMaxRecordValues> last_raw{};
+
+        // Appends the low 'width' bits of value, least significant first
+        void write(std::uint64_t value, unsigned width)
+        {
+            const std::size_t offset = bits % 64;
+            if (offset == 0)
+            {
+                words.push_back(0);
+            }
+            words.back() |= value << offset;
+            if (offset + width > 64)
+            {
+                words.push_back(value >> (64 - offset));
+            }
+            bits += width;
+        }
+
+        void write_classed(std::uint64_t value, const std::array<unsigned, 5>& widths)
+        {
+            std::size_t width_class = 0;
+            while (width_class + 1 < widths.size() && (value >> widths[width_class]) != 0)
+            {
+                ++width_class;
+            }
+            // Prefix of width_class one bits, terminated by a zero bit
+            write((std::uint64_t{1} << width_class) - 1,
+                  static_cast<unsigned>(width_class + (width_class + 1 < widths.size() ? 1 : 0)));
+            if (widths[width_class] != 0)
+            {
+                write(value, widths[width_class]);
+            }
+        }
+    };
+
+    class BitReader
+    {
+    public:
+        explicit BitReader(const std::vector<std::uint64_t>& words) noexcept : words_(words) {}
+
+        std::uint64_t read(unsigned width) noexcept
+        {
+            const std::size_t offset = position_ % 64;
+            const std::size_t word = position_ / 64;
+            std::uint64_t value = words_[word] >> offset;
+            if (offset + width > 64)
+            {
+                value |= words_[word + 1] << (64 - offset);
+            }
+            position_ += width;
+            return width == 64 ? value : value & ((std::uint64_t{1} << width) - 1);
+        }
+
+        std::uint64_t read_classed(const std::array<unsigned, 5>& widths) noexcept
+        {
+            std::size_t width_class = 0;
+            while (width_class + 1 < widths.size() && read(1) != 0)
+            {
+                ++width_class;
+            }
+            return widths[width_class] == 0 ? 0 : read(widths[width_class]);
+        }
+
+    private:
+        const std::vector<std::uint64_t>& words_;
+        std::size_t position_{0};
+    };
+
+    [[nodiscard]] static constexpr std::uint64_t zigzag(std::int64_t value) noexcept
+    {
+        return (static_cast<std::uint64_t>(value) << 1U) ^
+               static_cast<std::uint64_t>(value >> 63U);
+    }
+
+    [[nodiscard]] static constexpr std::int64_t unzigzag(std::uint64_t value) noexcept
+    {
+        return static_cast<std::int64_t>(value >> 1U) ^ -static_cast<std::int64_t>(value & 1U);
+    }
+
+    template <typename Visitor>
+    void decode_block(const Block& block, Visitor&& visitor) const
+    {
+        BitReader reader(block.words);
+        SeriesPoint point;
+        point.type_id = type_id_;
+        std::uint64_t delta = 0;
+        for (std::uint32_t n = 0; n < block.count; ++n)
+        {
+            if (n == 0)
+            {
+                point.timestamp = reader.read(64);
+                for (std::size_t i = 0; i < value_count_; ++i)
+                {
+                    point.raw[i] = static_cast<std::int32_t>(unzigzag(reader.read(32)));
+                }
+            }
+            else
+            {
+                const std::int64_t delta_of_delta = unzigzag(reader.read_classed(kTimestampWidths));
+                delta += static_cast<std::uint64_t>(delta_of_delta);
+                point.timestamp += delta;
+                for (std::size_t i = 0; i < value_count_; ++i)
+                {
+                    point.raw[i] = static_cast<std::int32_t>(
+                        point.raw[i] + unzigzag(reader.read_classed(kValueWidths)));
+                }
+            }
+            visitor(point);
+        }
+    }
+
+    std::deque<Block> blocks_;
+    std::size_t size_{0};
+    std::uint8_t type_id_;
+    std::uint8_t value_count_;
+};
+
+/**
+ * @brief Compressed series for every (device, channel, type) appended to it
+ *
+ * Custom types carry no typed values and are not stored. Not thread-safe.
+ */
+class SeriesStore
+{
+public:
+    /**
+     * @brief Append the values of a record to its series
+     */
+    void append(std::uint32_t device, std::uint64_t timestamp, const Record& record)
+    {
+        if (record.value_count == 0)
+        {
+            return;
+        }
+        auto [it, inserted] = series_.try_emplace(make_key(device, record.channel, record.type_id),
+                                                  record.type_id);
+        it->second.append(timestamp, record.raw);
+        ++points_;
+    }
+
+    /**
+     * @brief Decode a payload and append every selected record
+     *
+     * @return Status of the decode, with the number of records decoded
+     */
+    DecodeStatus append_payload(const Decoder& decoder, std::uint32_t device,
+                                std::uint64_t timestamp,
+                                std::span<const std::uint8_t> encoded_payload,
+                                const RecordFilter& filter = {})
+    {
+        return decoder.visit(encoded_payload, filter,
+                             [this, device, timestamp](const Record& record)
+                             { append(device, timestamp, record); });
+    }
+
+    /**
+     * @brief Find the series of a key
+     *
+     * @return The series, or nullptr if nothing was stored for it
+     */
+    [[nodiscard]] const CompressedSeries* find(std::uint32_t device, std::uint8_t channel,
+                                               std::uint8_t type_id) const
+    {
+        const auto it = series_.find(make_key(device, channel, type_id));
+        return it == series_.end() ? nullptr : &it->second;
+    }
+
+    /**
+     * @brief Call a visitor for every series
+     *
+     * @param visitor Callable invoked as visitor(device, channel, type_id, const CompressedSeries&)
+     */
+    template <typename Visitor>
+    void for_each_series(Visitor&& visitor) const
+    {
+        for (const auto& [key, series] : series_)
+        {
+            visitor(static_cast<std::uint32_t>(key >> 16U), static_cast<std::uint8_t>(key >> 8U),
+                    static_cast<std::uint8_t>(key), series);
+        }
+    }
+
+    /**
+     * @brief Drop old blocks from every series, and series left empty
+     *
+     * @return Number of points dropped
+     */
+    std::size_t drop_before(std::uint64_t cutoff)
+    {
+        std::size_t dropped = 0;
+        for (auto it = series_.begin(); it != series_.end();)
+        {
+            dropped += it->second.drop_before(cutoff);
+            it = it->second.empty() ? series_.erase(it) : std::next(it);
+        }
+        points_ -= dropped;
+        return dropped;
+    }
+
+    [[nodiscard]] std::size_t series_count() const noexcept { return series_.size(); }
+    [[nodiscard]] std::size_t point_count() const noexcept { return points_; }
+
+    /**
+     * @brief Memory used by all series, in bytes (excluding the hash table itself)
+     */
+    [[nodiscard]] std::size_t memory_bytes() const noexcept
+    {
+        std::size_t bytes = 0;
+        for (const auto& [key, series] : series_)
+        {
+            bytes += series.memory_bytes();
+        }
+        return bytes;
+    }
+
+private:
+    [[nodiscard]] static constexpr std::uint64_t make_key(std::uint32_t device,
+                                                          std::uint8_t channel,
+                                                          std::uint8_t type_id) noexcept
+    {
+        return (std::uint64_t{device} << 16U) | (std::uint64_t{channel} << 8U) | type_id;
+    }
+
+    std::unordered_map<std::uint64_t, CompressedSeries> series_;
+    std::size_t points_{0};
+};
+
+}  // namespace cayene
+
+#endif  // CAYENE_SERIES_STORE_HPP
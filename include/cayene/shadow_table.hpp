@@ -0,0 +1,351 @@
+#ifndef CAYENE_SHADOW_TABLE_HPP
+#define CAYENE_SHADOW_TABLE_HPP
+
+/**
+ * @file shadow_table.hpp
+ * @brief Concurrent latest-value table ("device shadow") of decoded records
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+
+#include "decoder.hpp"
+#include "detail/open_addressing.hpp"
+#include "detail/spin_pause.hpp"
+#include "filter.hpp"
+#include "record.hpp"
+
+namespace cayene
+{
+
+/**
+ * @brief Latest value of one (device, channel, type)
+ */
+struct ShadowValue
+{
+    std::uint64_t timestamp{0};
+    std::uint32_t device{0};
+    std::uint8_t channel{0};
+    std::uint8_t type_id{0};
+    std::array<std::int32_t, kMaxRecordValues> raw{};
+
+    /**
+     * @brief Get a scaled physical value
+     */
+    [[nodiscard]] constexpr double value(std::size_t index = 0) const noexcept
+    {
+        return static_cast<double>(raw[index]) / standard_value_layout(type_id).divisor[index];
+    }
+};
+
+/**
+ * @brief One slot of a ShadowTable
+ *
+ * The layout is fixed (40 bytes, no implicit padding) since tables can live
+ * in memory shared with other processes. The sequence number is odd while a
+ * write is in progress; the fields are relaxed atomics so that a read racing
+ * a write is well defined and simply retried.
+ *
+ * Retries are bounded: a writer process that dies between the two sequence
+ * stores leaves the sequence odd for good, and the slot then stays
+ * unreadable instead of hanging every reader.
+ */
+struct ShadowSlot
+{
+    /**
+     * @brief Attempts load() makes before giving up on a slot that stays odd
+     *
+     * A store takes nanoseconds, so a live writer never holds a slot for
+     * this many paused attempts.
+     */
+    static constexpr std::uint32_t kMaxReadAttempts = 1U << 16U;
+
+    std::atomic<std::uint32_t> sequence{0};
+    std::uint32_t reserved{0};
+    std::atomic<std::uint64_t> key{0};  ///< 0 when empty, see ShadowTable
+    std::atomic<std::uint64_t> timestamp{0};
+    std::array<std::atomic<std::int32_t>, kMaxRecordValues> raw{};
+    std::uint32_t reserved_tail{0};
+
+    void store(std::uint64_t new_timestamp,
+               const std::array<std::int32_t, kMaxRecordValues>& values) noexcept
+    {
+        const std::uint32_t start = sequence.load(std::memory_order_relaxed);
+        sequence.store(start + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        timestamp.store(new_timestamp, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < kMaxRecordValues; ++i)
+        {
+            raw[i].store(values[i], std::memory_order_relaxed);
+        }
+        sequence.store(start + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Read a consistent value
+     *
+     * @return false if no consistent value was seen within kMaxReadAttempts
+     */
+    [[nodiscard]] bool load(std::uint64_t& out_timestamp,
+                            std::array<std::int32_t, kMaxRecordValues>& values) const noexcept
+    {
+        for (std::uint32_t attempt = 0; attempt < kMaxReadAttempts; ++attempt)
+        {
+            const std::uint32_t before = sequence.load(std::memory_order_acquire);
+            if ((before & 1U) == 0)
+            {
+                out_timestamp = timestamp.load(std::memory_order_relaxed);
+                for (std::size_t i = 0; i < kMaxRecordValues; ++i)
+                {
+                    values[i] = raw[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before)
+                {
+                    return true;
+                }
+            }
+            detail::spin_pause();
+        }
+        return false;
+    }
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free &&
+                  std::atomic<std::uint32_t>::is_always_lock_free,
+              "shadow slots must be usable across processes");
+static_assert(sizeof(ShadowSlot) == 40 && offsetof(ShadowSlot, key) == 8 &&
+                  offsetof(ShadowSlot, timestamp) == 16 && offsetof(ShadowSlot, raw) == 24,
+              "ShadowSlot layout is part of the shared-memory format");
+
+/**
+ * @brief Fixed-capacity latest-value table with one writer per shard
+ *
+ * Keys are split over shards by device; each shard is an open-addressed
+ * table written by a single thread, the one that decodes that shard's
+ * devices (see shard_of()). Any number of threads may read concurrently:
+ * every slot is guarded by a sequence lock, so readers never block the
+ * writer and only retry when they overlap a write of the same slot.
+ *
+ * Slots are never removed and the table never grows, so lookups need no
+ * coordination beyond the slot itself. Updates of new keys fail once a
+ * shard is three quarters full. Custom types carry no typed values and
+ * are not stored.
+ */
+class ShadowTable
+{
+public:
+    /**
+     * @brief Create a table
+     *
+     * @param shard_count Number of shards (writer threads), at least 1
+     * @param keys_per_shard Keys each shard must be able to hold
+     */
+    ShadowTable(std::size_t shard_count, std::size_t keys_per_shard)
+        : shard_count_(std::max<std::size_t>(shard_count, 1)),
+          shard_capacity_(shard_capacity_for(keys_per_shard)),
+          shift_(detail::index_shift(shard_capacity_)),
+          owned_slots_(std::make_unique<ShadowSlot[]>(shard_count_ * shard_capacity_)),
+          slots_(owned_slots_.get()),
+          shards_(std::make_unique<ShardState[]>(shard_count_))
+    {
+    }
+
+    /**
+     * @brief Create a table over caller-provided slots, e.g. in shared memory
+     *
+     * The slots must stay valid for the lifetime of the table. Keys already
+     * present, written by another table over the same slots, are kept.
+     *
+     * @param slots shard_count * shard_capacity slots, zeroed or previously used
+     * @param shard_count Number of shards, at least 1
+     * @param shard_capacity Slots per shard, a power of two
+     */
+    ShadowTable(std::span<ShadowSlot> slots, std::size_t shard_count,
+                std::size_t shard_capacity)
+        : shard_count_(shard_count),
+          shard_capacity_(shard_capacity),
+          shift_(detail::index_shift(shard_capacity_)),
+          slots_(slots.data()),
+          shards_(std::make_unique<ShardState[]>(shard_count_))
+    {
+        for (std::size_t shard = 0; shard < shard_count_; ++shard)
+        {
+            for (std::size_t index = 0; index < shard_capacity_; ++index)
+            {
+                const ShadowSlot& slot = slots_[(shard * shard_capacity_) + index];
+                if (slot.key.load(std::memory_order_relaxed) != kEmpty)
+                {
+                    ++shards_[shard].size;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Slots per shard needed to hold a number of keys
+     */
+    [[nodiscard]] static std::size_t shard_capacity_for(std::size_t keys_per_shard) noexcept
+    {
+        return detail::capacity_for(keys_per_shard);
+    }
+
+    [[nodiscard]] std::size_t shard_count() const noexcept { return shard_count_; }
+    [[nodiscard]] std::size_t shard_capacity() const noexcept { return shard_capacity_; }
+
+    /**
+     * @brief Get the shard, and so the writer thread, a device belongs to
+     */
+    [[nodiscard]] std::size_t shard_of(std::uint32_t device) const noexcept
+    {
+        return static_cast<std::size_t>(((device * 0x9E3779B97F4A7C15ULL) >> 32U) % shard_count_);
+    }
+
+    /**
+     * @brief Store the latest value of a record
+     *
+     * Must only be called by the writer of shard_of(device).
+     *
+     * @return false if the record is of a custom type or its shard is full
+     */
+    bool update(std::uint32_t device, std::uint64_t timestamp, const Record& record) noexcept
+    {
+        if (record.value_count == 0)
+        {
+            return false;
+        }
+
+        const std::size_t shard = shard_of(device);
+        const std::uint64_t key = make_key(device, record.channel, record.type_id);
+        ShadowSlot* const first = slots_ + (shard * shard_capacity_);
+        std::size_t index = index_of(key);
+        while (true)
+        {
+            ShadowSlot& slot = first[index];
+            const std::uint64_t current = slot.key.load(std::memory_order_relaxed);
+            if (current == key)
+            {
+                slot.store(timestamp, record.raw);
+                return true;
+            }
+            if (current == kEmpty)
+            {
+                if (detail::exceeds_load(shards_[shard].size, shard_capacity_))
+                {
+                    return false;
+                }
+                // The key is published last, so readers that find it see a complete value
+                slot.store(timestamp, record.raw);
+                slot.key.store(key, std::memory_order_release);
+                ++shards_[shard].size;
+                return true;
+            }
+            index = (index + 1) & (shard_capacity_ - 1);
+        }
+    }
+
+    /**
+     * @brief Decode a payload and store the latest value of every selected record
+     *
+     * Must only be called by the writer of shard_of(device).
+     *
+     * @return Status of the decode, with the number of records decoded
+     */
+    DecodeStatus update_payload(const Decoder& decoder, std::uint32_t device,
+                                std::uint64_t timestamp,
+                                std::span<const std::uint8_t> encoded_payload,
+                                const RecordFilter& filter = {})
+    {
+        return decoder.visit(encoded_payload, filter,
+                             [this, device, timestamp](const Record& record)
+                             { update(device, timestamp, record); });
+    }
+
+    /**
+     * @brief Read the latest value of a key from any thread
+     *
+     * @return The value, or nullopt if none was stored or its slot could not
+     *         be read (see ShadowSlot::load())
+     */
+    [[nodiscard]] std::optional<ShadowValue> read(std::uint32_t device, std::uint8_t channel,
+                                                  std::uint8_t type_id) const noexcept
+    {
+        const std::uint64_t key = make_key(device, channel, type_id);
+        const ShadowSlot* const first = slots_ + (shard_of(device) * shard_capacity_);
+        std::size_t index = index_of(key);
+        for (std::size_t probes = 0; probes < shard_capacity_; ++probes)
+        {
+            const ShadowSlot& slot = first[index];
+            const std::uint64_t current = slot.key.load(std::memory_order_acquire);
+            if (current == key)
+            {
+                ShadowValue value;
+                value.device = device;
+                value.channel = channel;
+                value.type_id = type_id;
+                if (!slot.load(value.timestamp, value.raw))
+                {
+                    return std::nullopt;
+                }
+                return value;
+            }
+            if (current == kEmpty)
+            {
+                break;
+            }
+            index = (index + 1) & (shard_capacity_ - 1);
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Number of keys stored by a shard (writer thread only)
+     */
+    [[nodiscard]] std::size_t size(std::size_t shard) const noexcept
+    {
+        return shards_[shard].size;
+    }
+
+private:
+    // Keys, hashes and shard_of() are part of the shared-memory format
+    static constexpr std::uint64_t kEmpty = detail::kEmptyKey;
+    static constexpr std::uint64_t kHashMultiplier = 0xC2B2AE3D27D4EB4FULL;
+
+    // Writer-local bookkeeping, one cache line per shard
+    struct alignas(64) ShardState
+    {
+        std::size_t size{0};
+    };
+
+    [[nodiscard]] static constexpr std::uint64_t make_key(std::uint32_t device,
+                                                          std::uint8_t channel,
+                                                          std::uint8_t type_id) noexcept
+    {
+        return detail::record_key(device, channel, type_id);
+    }
+
+    [[nodiscard]] std::size_t index_of(std::uint64_t key) const noexcept
+    {
+        return detail::slot_index(key, shift_, kHashMultiplier);
+    }
+
+    std::size_t shard_count_;
+    std::size_t shard_capacity_;
+    unsigned shift_;
+    std::unique_ptr<ShadowSlot[]> owned_slots_;
+    ShadowSlot* slots_;
+    std::unique_ptr<ShardState[]> shards_;
+};
+
+}  // namespace cayene
+
+#endif  // CAYENE_SHADOW_TABLE_HPP
@@ -0,0 +1,332 @@
+#ifndef CAYENE_SHARED_RING_HPP
+#define CAYENE_SHARED_RING_HPP
+
+/**
+ * @file shared_ring.hpp
+ * @brief Multi-producer/multi-consumer uplink ring in shared memory (POSIX)
+ *
+ * Segment layout (version 1, native endianness):
+ *
+ *     offset 0     SharedRingHeader (192 bytes: header line, tail line, head line)
+ *     offset 192   capacity SharedRingSlot entries (320 bytes each)
+ *
+ * capacity is a power of two. The ring is a bounded queue with a sequence
+ * number per slot: slot i starts at sequence i. A producer may fill slot
+ * (pos & mask) once its sequence equals pos, claims it by advancing tail
+ * from pos to pos + 1 (compare-and-swap), writes the entry and stores
+ * sequence pos + 1. A consumer may read it once its sequence equals
+ * pos + 1, claims it by advancing head, and releases it by storing
+ * sequence pos + capacity.
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "detail/shm_segment.hpp"
+#include "pipeline.hpp"
+
+namespace cayene
+{
+
+/**
+ * @brief Header at the start of a shared ring segment
+ *
+ * The producer and consumer positions live on cache lines of their own.
+ */
+struct SharedRingHeader
+{
+    static constexpr std::uint64_t kMagic = 0x31474E49'52594143ULL;  // "CAYRING1"
+    static constexpr std::uint32_t kVersion = 1;
+
+    std::atomic<std::uint64_t> magic{0};  ///< Written last, once the segment is initialized
+    std::uint32_t version{0};
+    std::uint32_t slot_size{0};
+    std::uint64_t capacity{0};
+    std::array<std::uint8_t, 40> reserved{};
+    alignas(64) std::atomic<std::uint64_t> tail{0};  ///< Next position to produce
+    alignas(64) std::atomic<std::uint64_t> head{0};  ///< Next position to consume
+};
+
+/**
+ * @brief One uplink of a shared ring, one slot per cache-line-aligned block
+ */
+struct alignas(64) SharedRingSlot
+{
+    std::atomic<std::uint64_t> sequence{0};
+    std::uint64_t timestamp{0};
+    std::uint32_t device{0};
+    std::uint16_t size{0};
+    std::uint16_t reserved{0};
+    std::array<std::uint8_t, kMaxPipelinePayload> bytes{};
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "ring positions must be usable across processes");
+static_assert(sizeof(SharedRingHeader) == 192 && offsetof(SharedRingHeader, tail) == 64 &&
+                  offsetof(SharedRingHeader, head) == 128,
+              "SharedRingHeader layout is part of the shared-memory format");
+static_assert(sizeof(SharedRingSlot) == 320 && offsetof(SharedRingSlot, timestamp) == 8 &&
+                  offsetof(SharedRingSlot, device) == 16 && offsetof(SharedRingSlot, size) == 20 &&
+                  offsetof(SharedRingSlot, bytes) == 24,
+              "SharedRingSlot layout is part of the shared-memory format");
+
+/**
+ * @brief Bounded uplink queue shared between processes
+ *
+ * Any number of producer processes (e.g. radio/gateway front ends) push
+ * raw uplinks; any number of consumer processes decode them straight out
+ * of the mapping: the PayloadRef handed to a consumer points into the
+ * slot, which is only released to producers once the consumer returns.
+ * Each uplink is copied exactly once, into the ring, with no system call.
+ *
+ * Neither side blocks: try_push() reports a full ring and consumers poll.
+ * A process that dies between claiming and finishing a slot leaves that
+ * slot, and so the ring behind it, stuck; recreate the segment to recover.
+ *
+ * Factories return nullopt on failure with errno set (EINVAL for a segment
+ * that is not a compatible ring).
+ */
+class SharedUplinkRing
+{
+public:
+    /**
+     * @brief Create (or replace) a named POSIX shared-memory ring
+     *
+     * An existing ring of the same name is unlinked, not reused: processes
+     * still mapping it keep using the old ring until they open() it again.
+     * The segment is only accessible to the creating user (mode 0600).
+     *
+     * @param name Shared-memory object name, e.g. "/cayene-uplinks"
+     * @param capacity Slots, rounded up to a power of two (at least 2)
+     */
+    [[nodiscard]] static std::optional<SharedUplinkRing> create(const std::string& name,
+                                                                std::size_t capacity);
+
+    /**
+     * @brief Map an existing named ring
+     */
+    [[nodiscard]] static std::optional<SharedUplinkRing> open(const std::string& name);
+
+    /**
+     * @brief Create an unnamed ring in a memfd (Linux)
+     *
+     * Share it by passing fd() to other processes, over fork() or a Unix
+     * socket (SCM_RIGHTS); the memory is freed when the last mapping and
+     * descriptor are gone.
+     */
+    [[nodiscard]] static std::optional<SharedUplinkRing> create_anonymous(std::size_t capacity);
+
+    /**
+     * @brief Map a ring from a descriptor received from its creator
+     *
+     * The descriptor is duplicated; the caller keeps ownership of fd.
+     */
+    [[nodiscard]] static std::optional<SharedUplinkRing> open_fd(int fd);
+
+    SharedUplinkRing(SharedUplinkRing&& other) noexcept;
+    SharedUplinkRing& operator=(SharedUplinkRing&& other) noexcept;
+    SharedUplinkRing(const SharedUplinkRing&) = delete;
+    SharedUplinkRing& operator=(const SharedUplinkRing&) = delete;
+    ~SharedUplinkRing();
+
+    // ---- Producer side ----
+
+    /**
+     * @brief Copy an uplink into the ring
+     *
+     * @return Accepted, Full, or TooLarge (over kMaxPipelinePayload bytes)
+     */
+    SubmitStatus try_push(std::uint32_t device, std::uint64_t timestamp,
+                          std::span<const std::uint8_t> payload) noexcept
+    {
+        if (payload.size() > kMaxPipelinePayload)
+        {
+            return SubmitStatus::TooLarge;
+        }
+        std::uint64_t position = header_->tail.load(std::memory_order_relaxed);
+        SharedRingSlot* slot = nullptr;
+        while (true)
+        {
+            slot = &slots_[position & mask_];
+            const std::uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<std::int64_t>(sequence - position);
+            if (lag == 0)
+            {
+                if (header_->tail.compare_exchange_weak(position, position + 1,
+                                                        std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (lag < 0)
+            {
+                return SubmitStatus::Full;  // The slot still holds an unconsumed uplink
+            }
+            else
+            {
+                position = header_->tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->timestamp = timestamp;
+        slot->device = device;
+        slot->size = static_cast<std::uint16_t>(payload.size());
+        if (!payload.empty())
+        {
+            std::memcpy(slot->bytes.data(), payload.data(), payload.size());
+        }
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return SubmitStatus::Accepted;
+    }
+
+    // ---- Consumer side ----
+
+    /**
+     * @brief Consume the oldest uplink in place
+     *
+     * @param visitor Callable invoked as visitor(const PayloadRef&); the
+     *                payload points into shared memory until it returns
+     * @return false if the ring was empty
+     */
+    template <typename Visitor>
+    bool try_consume(Visitor&& visitor)
+    {
+        std::array<PayloadRef, 1> ref;
+        return consume_batch(ref, [&visitor](std::span<const PayloadRef> batch)
+                             { visitor(batch.front()); }) != 0;
+    }
+
+    /**
+     * @brief Consume up to refs.size() consecutive uplinks in place, in one claim
+     *
+     * Fills refs with the uplinks and calls visitor(std::span<const
+     * PayloadRef>) once, e.g. to hand the batch to AsyncDecoder or a
+     * decode_records loop; the slots are released when it returns, also
+     * by throwing.
+     *
+     * @return Number of uplinks consumed, 0 if the ring was empty
+     */
+    template <typename Visitor>
+    std::size_t consume_batch(std::span<PayloadRef> refs, Visitor&& visitor)
+    {
+        if (refs.empty())
+        {
+            return 0;
+        }
+        std::uint64_t position = header_->head.load(std::memory_order_relaxed);
+        std::size_t count = 0;
+        while (true)
+        {
+            // Count the published slots from position on, then claim them together
+            count = 0;
+            while (count < refs.size())
+            {
+                const std::uint64_t sequence =
+                    slots_[(position + count) & mask_].sequence.load(std::memory_order_acquire);
+                if (sequence != position + count + 1)
+                {
+                    break;
+                }
+                ++count;
+            }
+            if (count == 0)
+            {
+                const std::uint64_t sequence =
+                    slots_[position & mask_].sequence.load(std::memory_order_relaxed);
+                if (static_cast<std::int64_t>(sequence - (position + 1)) < 0)
+                {
+                    return 0;  // Not yet produced
+                }
+                position = header_->head.load(std::memory_order_relaxed);  // Lost a race
+                continue;
+            }
+            if (header_->head.compare_exchange_weak(position, position + count,
+                                                    std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const SharedRingSlot& slot = slots_[(position + i) & mask_];
+            refs[i].device = slot.device;
+            refs[i].timestamp = slot.timestamp;
+            refs[i].payload = std::span(slot.bytes.data(), std::min<std::size_t>(
+                                                               slot.size, kMaxPipelinePayload));
+        }
+        // A slot that is never released would stall every producer behind it
+        struct Release
+        {
+            SharedUplinkRing& ring;
+            std::uint64_t position;
+            std::size_t count;
+
+            ~Release()
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    ring.slots_[(position + i) & ring.mask_].sequence.store(
+                        position + i + ring.capacity_, std::memory_order_release);
+                }
+            }
+        } const release{*this, position, count};
+        visitor(std::span<const PayloadRef>(refs.first(count)));
+        return count;
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+
+    /**
+     * @brief Uplinks produced but not yet consumed (approximate while in use)
+     */
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        const std::uint64_t head = header_->head.load(std::memory_order_acquire);
+        const std::uint64_t tail = header_->tail.load(std::memory_order_acquire);
+        return tail > head ? static_cast<std::size_t>(tail - head) : 0;
+    }
+
+    /**
+     * @brief Descriptor of the segment, to share an anonymous ring
+     */
+    [[nodiscard]] int fd() const noexcept { return fd_; }
+
+    [[nodiscard]] const std::string& name() const noexcept { return name_; }
+
+    /**
+     * @brief Size of the mapping in bytes
+     */
+    [[nodiscard]] std::size_t size_bytes() const noexcept { return size_; }
+
+private:
+    SharedUplinkRing(void* mapping, std::size_t size, int fd, std::string name, bool owner,
+                     detail::ShmSegmentId segment);
+
+    void release() noexcept;
+
+    void* mapping_;
+    std::size_t size_;
+    int fd_;
+    std::string name_;
+    bool owner_;
+    detail::ShmSegmentId segment_;
+    SharedRingHeader* header_;
+    SharedRingSlot* slots_;
+    std::size_t capacity_;
+    std::size_t mask_;
+};
+
+}  // namespace cayene
+
+#endif  // CAYENE_SHARED_RING_HPP
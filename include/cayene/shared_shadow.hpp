@@ -0,0 +1,182 @@
+#ifndef CAYENE_SHARED_SHADOW_HPP
+#define CAYENE_SHARED_SHADOW_HPP
+
+/**
+ * @file shared_shadow.hpp
+ * @brief Device shadow published in a named POSIX shared-memory segment
+ *
+ * Segment layout (version 1, native endianness):
+ *
+ *     offset 0    SharedShadowHeader (64 bytes)
+ *     offset 64   shard_count * shard_capacity ShadowSlot entries (40 bytes each)
+ *
+ * Slot keys are (1 << 48) | device << 16 | channel << 8 | type id, or 0 when
+ * empty. A key lives in shard ((device * 0x9E3779B97F4A7C15) >> 32) %
+ * shard_count, at slot (key * 0xC2B2AE3D27D4EB4F) >> (64 - log2(shard_capacity))
+ * of that shard, or a following one (linear probing). Values are read with
+ * the sequence lock protocol of ShadowSlot.
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "detail/shm_segment.hpp"
+#include "shadow_table.hpp"
+
+namespace cayene
+{
+
+/**
+ * @brief Header at the start of a shared shadow segment
+ */
+struct SharedShadowHeader
+{
+    static constexpr std::uint64_t kMagic = 0x31574448'53594143ULL;  // "CAYSHDW1"
+    static constexpr std::uint32_t kVersion = 1;
+
+    std::atomic<std::uint64_t> magic{0};  ///< Written last, once the header is complete
+    std::uint32_t version{0};
+    std::uint32_t slot_size{0};
+    std::uint64_t shard_count{0};
+    std::uint64_t shard_capacity{0};
+    std::array<std::uint8_t, 32> reserved{};
+};
+
+static_assert(sizeof(SharedShadowHeader) == 64 && offsetof(SharedShadowHeader, shard_count) == 16,
+              "SharedShadowHeader layout is part of the shared-memory format");
+
+namespace detail
+{
+
+/**
+ * @brief Mapping of a shadow segment, shared by SharedShadowTable and SharedShadowView
+ *
+ * Unmaps the segment when destroyed and, for the creator, unlinks its name.
+ */
+class ShadowMapping
+{
+public:
+    ShadowMapping(void* mapping, std::size_t size, std::string name, bool owner,
+                  ShmSegmentId segment);
+    ShadowMapping(ShadowMapping&& other) noexcept;
+    ShadowMapping& operator=(ShadowMapping&& other) noexcept;
+    ShadowMapping(const ShadowMapping&) = delete;
+    ShadowMapping& operator=(const ShadowMapping&) = delete;
+    ~ShadowMapping();
+
+    [[nodiscard]] ShadowTable& table() noexcept { return table_; }
+    [[nodiscard]] const ShadowTable& table() const noexcept { return table_; }
+    [[nodiscard]] const std::string& name() const noexcept { return name_; }
+    [[nodiscard]] std::size_t size_bytes() const noexcept { return size_; }
+
+private:
+    void release() noexcept;
+
+    void* mapping_;
+    std::size_t size_;
+    std::string name_;
+    bool owner_;
+    ShmSegmentId segment_;
+    ShadowTable table_;
+};
+
+}  // namespace detail
+
+/**
+ * @brief A ShadowTable published in a named shared-memory segment, for its writer
+ *
+ * The writer process create()s the segment and updates table() exactly as
+ * an in-process ShadowTable; reader processes map it with
+ * SharedShadowView::open(). The creator unlinks the name when it is
+ * destroyed; readers that already mapped it keep their mapping.
+ *
+ * A writer that dies in the middle of an update leaves that slot locked:
+ * read() returns nullopt for its key from then on. A restarted writer
+ * create()s a fresh segment, and readers open() it again to recover.
+ *
+ * create() returns nullopt on failure with errno set.
+ */
+class SharedShadowTable
+{
+public:
+    /**
+     * @brief Create (or replace) a segment and map it for writing
+     *
+     * An existing segment of the same name is unlinked, not reused, so
+     * processes that still map it keep its contents; they see the new
+     * segment once they open() it again. The segment is only accessible to
+     * the creating user (mode 0600).
+     *
+     * @param name Shared-memory object name, e.g. "/cayene-shadow"
+     * @param shard_count Number of shards (writer threads), at least 1
+     * @param keys_per_shard Keys each shard must be able to hold
+     */
+    [[nodiscard]] static std::optional<SharedShadowTable> create(const std::string& name,
+                                                                 std::size_t shard_count,
+                                                                 std::size_t keys_per_shard);
+
+    /**
+     * @brief The mapped table
+     */
+    [[nodiscard]] ShadowTable& table() noexcept { return mapping_.table(); }
+    [[nodiscard]] const ShadowTable& table() const noexcept { return mapping_.table(); }
+
+    [[nodiscard]] const std::string& name() const noexcept { return mapping_.name(); }
+
+    /**
+     * @brief Size of the mapping in bytes
+     */
+    [[nodiscard]] std::size_t size_bytes() const noexcept { return mapping_.size_bytes(); }
+
+private:
+    explicit SharedShadowTable(detail::ShadowMapping mapping) : mapping_(std::move(mapping)) {}
+
+    detail::ShadowMapping mapping_;
+};
+
+/**
+ * @brief A shared shadow mapped read-only by a reader process
+ *
+ * Only a const table() is handed out: the mapping is read-only, so an
+ * update through it would fault.
+ *
+ * open() returns nullopt on failure with errno set (EINVAL for a segment
+ * that is not a compatible shadow).
+ */
+class SharedShadowView
+{
+public:
+    /**
+     * @brief Map an existing segment for reading
+     */
+    [[nodiscard]] static std::optional<SharedShadowView> open(const std::string& name);
+
+    /**
+     * @brief The mapped table, to read() from
+     */
+    [[nodiscard]] const ShadowTable& table() const noexcept { return mapping_.table(); }
+
+    [[nodiscard]] const std::string& name() const noexcept { return mapping_.name(); }
+
+    /**
+     * @brief Size of the mapping in bytes
+     */
+    [[nodiscard]] std::size_t size_bytes() const noexcept { return mapping_.size_bytes(); }
+
+private:
+    explicit SharedShadowView(detail::ShadowMapping mapping) : mapping_(std::move(mapping)) {}
+
+    detail::ShadowMapping mapping_;
+};
+
+}  // namespace cayene
+
+#endif  // CAYENE_SHARED_SHADOW_HPP
@@ -0,0 +1,164 @@
+#ifndef CAYENE_SPSC_RING_HPP
+#define CAYENE_SPSC_RING_HPP
+
+/**
+ * @file spsc_ring.hpp
+ * @brief Bounded lock-free single-producer/single-consumer ring buffer
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace cayene
+{
+
+/**
+ * @brief Fixed-capacity ring between exactly one producer and one consumer thread
+ *
+ * Elements are written and read in place: the producer claim()s a slot,
+ * fills it and publish()es it; the consumer reads front() and pop()s it.
+ * Each side caches the other's index and only reloads it when the ring
+ * looks full (or empty), so an uncontended push or pop touches no shared
+ * cache line besides the slot itself.
+ */
+template <typename T>
+class SpscRing
+{
+public:
+    /**
+     * @brief Create a ring holding at least capacity elements
+     */
+    explicit SpscRing(std::size_t capacity)
+        : capacity_(std::bit_ceil(std::max<std::size_t>(capacity, 2))),
+          mask_(capacity_ - 1),
+          slots_(std::make_unique<T[]>(capacity_))
+    {
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+
+    // ---- Producer side ----
+
+    /**
+     * @brief Get the next free slot to fill, or nullptr if the ring is full
+     */
+    [[nodiscard]] T* claim() noexcept
+    {
+        const std::size_t tail = producer_.tail.load(std::memory_order_relaxed);
+        if (tail - producer_.cached_head == capacity_)
+        {
+            producer_.cached_head = consumer_.head.load(std::memory_order_acquire);
+            if (tail - producer_.cached_head == capacity_)
+            {
+                return nullptr;
+            }
+        }
+        return &slots_[tail & mask_];
+    }
+
+    /**
+     * @brief Make the slot returned by the last claim() visible to the consumer
+     */
+    void publish() noexcept
+    {
+        producer_.tail.store(producer_.tail.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy an element in
+     *
+     * @return false if the ring is full
+     */
+    bool try_push(const T& value) noexcept(std::is_nothrow_copy_assignable_v<T>)
+    {
+        T* slot = claim();
+        if (slot == nullptr)
+        {
+            return false;
+        }
+        *slot = value;
+        publish();
+        return true;
+    }
+
+    // ---- Consumer side ----
+
+    /**
+     * @brief Get the oldest published element, or nullptr if the ring is empty
+     */
+    [[nodiscard]] T* front() noexcept
+    {
+        const std::size_t head = consumer_.head.load(std::memory_order_relaxed);
+        if (head == consumer_.cached_tail)
+        {
+            consumer_.cached_tail = producer_.tail.load(std::memory_order_acquire);
+            if (head == consumer_.cached_tail)
+            {
+                return nullptr;
+            }
+        }
+        return &slots_[head & mask_];
+    }
+
+    /**
+     * @brief Release the element returned by front() back to the producer
+     */
+    void pop() noexcept
+    {
+        consumer_.head.store(consumer_.head.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_release);
+    }
+
+    /**
+     * @brief Elements the consumer knows are queued (consumer thread only)
+     *
+     * Read from the consumer's cached copy of the tail, so it touches no
+     * cache line the producer writes. Exact when front() last reloaded the
+     * tail, and a lower bound from then on.
+     */
+    [[nodiscard]] std::size_t known_size() const noexcept
+    {
+        return consumer_.cached_tail - consumer_.head.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Number of elements in the ring; exact only from a quiescent thread
+     */
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return producer_.tail.load(std::memory_order_acquire) -
+               consumer_.head.load(std::memory_order_acquire);
+    }
+
+private:
+    // Each side's index and its cached copy of the other's share a cache line
+    struct alignas(64) ProducerState
+    {
+        std::atomic<std::size_t> tail{0};
+        std::size_t cached_head{0};
+    };
+
+    struct alignas(64) ConsumerState
+    {
+        std::atomic<std::size_t> head{0};
+        std::size_t cached_tail{0};
+    };
+
+    std::size_t capacity_;
+    std::size_t mask_;
+    std::unique_ptr<T[]> slots_;
+    ProducerState producer_;
+    ConsumerState consumer_;
+};
+
+}  // namespace cayene
+
+#endif  // CAYENE_SPSC_RING_HPP
@@ -0,0 +1,139 @@
+#ifndef CAYENE_TRACE_HPP
+#define CAYENE_TRACE_HPP
+
+/**
+ * @file trace.hpp
+ * @brief Pipeline stage tracing with Chrome trace-event export
+ *
+ * Spans are recorded into per-thread lock-free ring buffers and can be dumped
+ * as Chrome trace-event JSON, which loads directly into Perfetto or
+ * chrome://tracing.
+ *
+ * A thread's buffer is handed to the next thread that starts tracing once
+ * it exits, so thread pools that churn threads do not grow memory; spans of
+ * exited threads stay exportable until the new owner overwrites them.
+ *
+ * The library only instruments its own stages when built with
+ * CAYENE_ENABLE_TRACING; the recording API itself is always available.
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace cayene::trace
+{
+
+/**
+ * @brief Pipeline stage a span belongs to
+ */
+enum class Stage : std::uint8_t
+{
+    Ingest,
+    Base64Decode,
+    LppDecode,
+    Serialize,
+    SinkWrite,
+};
+
+/**
+ * @brief Number of spans each thread keeps before overwriting the oldest
+ */
+inline constexpr std::size_t kThreadBufferCapacity = 16384;
+
+/**
+ * @brief Get the trace-event name of a stage
+ */
+[[nodiscard]] const char* stage_name(Stage stage) noexcept;
+
+/**
+ * @brief Monotonic timestamp in nanoseconds used for all spans
+ */
+[[nodiscard]] std::uint64_t now_ns() noexcept;
+
+/**
+ * @brief Enable or disable recording at runtime (enabled by default)
+ */
+void set_enabled(bool enabled) noexcept;
+
+/**
+ * @brief Check whether spans are currently being recorded
+ */
+[[nodiscard]] bool is_enabled() noexcept;
+
+/**
+ * @brief Record a finished span into the calling thread's ring buffer
+ *
+ * Never blocks and never allocates after the first call on a given thread,
+ * which reuses the buffer of an exited thread when there is one.
+ */
+void record(Stage stage, std::uint64_t start_ns, std::uint64_t end_ns) noexcept;
+
+/**
+ * @brief Write all buffered spans as Chrome trace-event JSON
+ *
+ * Safe to call while other threads keep recording; spans overwritten during
+ * the dump are skipped.
+ *
+ * @param output Stream receiving the JSON document
+ * @return Number of span events written
+ */
+std::size_t write_chrome_trace(std::ostream& output);
+
+/**
+ * @brief Discard all buffered spans
+ *
+ * Must not race with record(); call it while no thread is tracing.
+ */
+void clear() noexcept;
+
+/**
+ * @brief RAII span covering the lifetime of the object
+ */
+class ScopedSpan
+{
+public:
+    explicit ScopedSpan(Stage stage) noexcept
+        : stage_(stage), start_ns_(is_enabled() ? now_ns() : 0)
+    {
+    }
+
+    ~ScopedSpan()
+    {
+        if (start_ns_ != 0)
+        {
+            record(stage_, start_ns_, now_ns());
+        }
+    }
+
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan& operator=(const ScopedSpan&) = delete;
+    ScopedSpan(ScopedSpan&&) = delete;
+    ScopedSpan& operator=(ScopedSpan&&) = delete;
+
+private:
+    Stage stage_;
+    std::uint64_t start_ns_;
+};
+
+}  // namespace cayene::trace
+
+#define CAYENE_TRACE_CONCAT_IMPL(a, b) a##b
+#define CAYENE_TRACE_CONCAT(a, b) CAYENE_TRACE_CONCAT_IMPL(a, b)
+
+/**
+ * @brief Trace the enclosing scope as the given stage
+ *
+ * Expands to nothing unless CAYENE_ENABLE_TRACING is defined.
+ */
+#ifdef CAYENE_ENABLE_TRACING
+    #define CAYENE_TRACE_SCOPE(stage) \
+        const ::cayene::trace::ScopedSpan CAYENE_TRACE_CONCAT(cayene_trace_span_, __LINE__)(stage)
+#else
+    #define CAYENE_TRACE_SCOPE(stage) static_cast<void>(0)
+#endif
+
+#endif  // CAYENE_TRACE_HPP
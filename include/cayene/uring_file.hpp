@@ -0,0 +1,214 @@
+#ifndef CAYENE_URING_FILE_HPP
+#define CAYENE_URING_FILE_HPP
+
+/**
+ * @file uring_file.hpp
+ * @brief Sequential file reader and writer on io_uring with registered buffers (Linux)
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "decoder.hpp"
+#include "filter.hpp"
+#include "pipeline.hpp"
+
+namespace cayene
+{
+
+namespace detail
+{
+class UringQueue;
+}  // namespace detail
+
+/**
+ * @brief Buffer ring sizing of a UringFileReader or UringFileWriter
+ */
+struct UringConfig
+{
+    std::size_t queue_depth{8};           ///< Registered buffers, and so requests in flight
+    std::size_t buffer_size{256 * 1024};  ///< Bytes per buffer and per request
+    bool use_io_uring{true};              ///< false forces the pread()/pwrite() path
+};
+
+/**
+ * @brief Reads a file front to back through a ring of registered buffers
+ *
+ * Up to queue_depth reads are kept in flight, each into its own buffer
+ * registered with the kernel once (IORING_OP_READ_FIXED), and chunks are
+ * handed out in file order. Refills are submitted together with the wait
+ * for the next chunk, so a large file costs about one system call per
+ * buffer instead of one read() per buffer plus copies.
+ *
+ * When io_uring is unavailable (old kernel, or blocked by a seccomp
+ * policy) the same buffers are filled with pread() instead; uses_io_uring()
+ * tells which path is active.
+ *
+ * Factories and read_all() report failures as nullopt/false with errno set.
+ */
+class UringFileReader
+{
+public:
+    [[nodiscard]] static std::optional<UringFileReader> open(const std::string& path,
+                                                             const UringConfig& config = {});
+
+    UringFileReader(UringFileReader&& other) noexcept;
+    UringFileReader& operator=(UringFileReader&& other) noexcept;
+    UringFileReader(const UringFileReader&) = delete;
+    UringFileReader& operator=(const UringFileReader&) = delete;
+    ~UringFileReader();
+
+    /**
+     * @brief Read the whole file, passing each chunk to the callback in order
+     *
+     * A chunk is only valid during the call. Every chunk but the last is
+     * buffer_size bytes. Reads still in flight are completed before it
+     * returns, also when it fails or the callback throws. If they cannot be
+     * waited for, the reader stays failed and later calls return false
+     * with EIO.
+     */
+    bool read_all(const std::function<void(std::span<const std::uint8_t>)>& callback);
+
+    [[nodiscard]] std::uint64_t file_size() const noexcept { return size_; }
+    [[nodiscard]] bool uses_io_uring() const noexcept { return queue_ != nullptr; }
+
+private:
+    UringFileReader(int fd, std::uint64_t size, const UringConfig& config);
+
+    void release() noexcept;
+    void drain(std::size_t& outstanding) noexcept;
+
+    int fd_;
+    std::uint64_t size_;
+    UringConfig config_;
+    std::vector<std::unique_ptr<std::uint8_t[]>> buffers_;
+    std::unique_ptr<detail::UringQueue> queue_;
+    bool failed_{false};  ///< In-flight reads could not be drained
+};
+
+/**
+ * @brief Appends to a new file through a ring of registered buffers
+ *
+ * write() copies into the current buffer; a full buffer is queued as an
+ * IORING_OP_WRITE_FIXED and the next free one is used, so the caller only
+ * waits when every buffer is in flight. Queued writes are submitted in
+ * batches of half the queue depth. flush() submits the partial buffer and
+ * waits for every write. Falls back to pwrite() like UringFileReader.
+ */
+class UringFileWriter
+{
+public:
+    /**
+     * @brief Create (or truncate) a file for writing
+     */
+    [[nodiscard]] static std::optional<UringFileWriter> create(const std::string& path,
+                                                               const UringConfig& config = {});
+
+    UringFileWriter(UringFileWriter&& other) noexcept;
+    UringFileWriter& operator=(UringFileWriter&& other) noexcept;
+    UringFileWriter(const UringFileWriter&) = delete;
+    UringFileWriter& operator=(const UringFileWriter&) = delete;
+
+    /**
+     * @brief Flush and close; errors are lost, call flush() to see them
+     */
+    ~UringFileWriter();
+
+    /**
+     * @brief Append bytes
+     *
+     * @return false once any write failed (errno set)
+     */
+    bool write(std::span<const std::uint8_t> data);
+
+    /**
+     * @brief Write everything buffered and wait for it to complete
+     */
+    bool flush();
+
+    /**
+     * @brief Bytes accepted by write() so far
+     */
+    [[nodiscard]] std::uint64_t bytes_written() const noexcept { return offset_ + fill_; }
+    [[nodiscard]] bool uses_io_uring() const noexcept { return queue_ != nullptr; }
+
+private:
+    UringFileWriter(int fd, const UringConfig& config);
+
+    bool submit_current();
+    bool wait_for(std::size_t buffer);
+    bool reap(bool wait);
+    void release() noexcept;
+
+    int fd_;
+    UringConfig config_;
+    std::vector<std::unique_ptr<std::uint8_t[]>> buffers_;
+    std::vector<bool> in_flight_;
+    std::vector<std::size_t> lengths_;         ///< Bytes queued from each buffer
+    std::vector<std::uint64_t> offsets_;       ///< File offset each buffer is written at
+    std::unique_ptr<detail::UringQueue> queue_;
+    std::size_t current_{0};
+    std::size_t fill_{0};
+    std::uint64_t offset_{0};  ///< File offset of the current buffer
+    int error_{0};             ///< First failure (errno value), sticky
+};
+
+/**
+ * @brief Pipeline sink exporting every payload as one JSON line
+ *
+ * Lines look like {"device":7,"timestamp":1700000000,"data":{...}}, with
+ * "error":"..." instead of "data" for payloads that failed to decode.
+ * Workers format into their own 64 KiB buffers and append whole buffers
+ * to the shared writer, so the writer's lock is taken once per buffer.
+ */
+class JsonLinesSink final : public PipelineSink
+{
+public:
+    /**
+     * @param decoder Decoder used to render the JSON (re-decodes the payload)
+     * @param writer Destination; must outlive the sink
+     * @param workers Number of pipeline workers
+     * @param filter Records to include
+     */
+    JsonLinesSink(const Decoder& decoder, UringFileWriter& writer, std::size_t workers,
+                  const RecordFilter& filter = {});
+
+    void consume(std::size_t worker, const DecodedPayload& result) override;
+    void flush(std::size_t worker) override;
+
+    /**
+     * @brief False if any write to the file failed
+     */
+    [[nodiscard]] bool ok() const noexcept;
+
+private:
+    struct alignas(64) WorkerBuffer
+    {
+        std::vector<std::uint8_t> bytes;
+    };
+
+    void render(WorkerBuffer& buffer, const DecodedPayload& result);
+    void append(WorkerBuffer& buffer, std::span<const char> text);
+    void drain(WorkerBuffer& buffer);
+
+    const Decoder& decoder_;
+    UringFileWriter& writer_;
+    RecordFilter filter_;
+    std::vector<WorkerBuffer> buffers_;
+    mutable std::mutex mutex_;
+    bool failed_{false};
+};
+
+}  // namespace cayene
+
+#endif  // CAYENE_URING_FILE_HPP
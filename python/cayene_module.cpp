@@ -0,0 +1,639 @@
+/**
+ * @file cayene_module.cpp
+ * @brief CPython extension exposing batch decoding into columnar buffers
+ *
+ * Decoder.decode_batch() decodes a list of payloads (or one concatenated
+ * buffer plus offsets) with the GIL released and returns one Column per
+ * field. Columns export their storage through the buffer protocol, so
+ * numpy.asarray() and memoryview() wrap them without copying.
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <new>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cayene/decoder.hpp"
+
+namespace
+{
+
+static_assert(sizeof(unsigned int) == sizeof(std::uint32_t), "Column format 'I' must be 32-bit");
+
+// ============================================================================
+// Column
+// ============================================================================
+
+/**
+ * @brief Read-only one-dimensional array owning a std::vector
+ */
+struct ColumnObject
+{
+    PyObject_HEAD
+    void* data;
+    Py_ssize_t length;
+    Py_ssize_t itemsize;
+    const char* format;
+    void* storage;
+    void (*release)(void*);
+};
+
+PyTypeObject* g_column_type = nullptr;
+
+template <typename T>
+void release_storage(void* storage)
+{
+    delete static_cast<std::vector<T>*>(storage);
+}
+
+// Takes over the vector's buffer; the decoder filled it, Python only wraps it
+template <typename T>
+PyObject* make_column(std::vector<T>& values, const char* format)
+{
+    auto* storage = new (std::nothrow) std::vector<T>(std::move(values));
+    if (storage == nullptr)
+    {
+        return PyErr_NoMemory();
+    }
+
+    ColumnObject* column = PyObject_New(ColumnObject, g_column_type);
+    if (column == nullptr)
+    {
+        delete storage;
+        return nullptr;
+    }
+    column->data = storage->data();
+    column->length = static_cast<Py_ssize_t>(storage->size());
+    column->itemsize = static_cast<Py_ssize_t>(sizeof(T));
+    column->format = format;
+    column->storage = storage;
+    column->release = &release_storage<T>;
+    return reinterpret_cast<PyObject*>(column);
+}
+
+void column_dealloc(PyObject* self)
+{
+    auto* column = reinterpret_cast<ColumnObject*>(self);
+    if (column->release != nullptr)
+    {
+        column->release(column->storage);
+    }
+    PyTypeObject* type = Py_TYPE(self);
+    type->tp_free(self);
+    Py_DECREF(type);
+}
+
+int column_getbuffer(PyObject* self, Py_buffer* view, int flags)
+{
+    auto* column = reinterpret_cast<ColumnObject*>(self);
+    if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE)
+    {
+        PyErr_SetString(PyExc_BufferError, "Column is read-only");
+        return -1;
+    }
+
+    Py_INCREF(self);
+    view->obj = self;
+    view->buf = column->data;
+    view->len = column->length * column->itemsize;
+    view->readonly = 1;
+    view->itemsize = column->itemsize;
+    view->format = (flags & PyBUF_FORMAT) == PyBUF_FORMAT ? const_cast<char*>(column->format)
+                                                           : nullptr;
+    view->ndim = 1;
+    view->shape = (flags & PyBUF_ND) == PyBUF_ND ? &column->length : nullptr;
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &column->itemsize : nullptr;
+    view->suboffsets = nullptr;
+    view->internal = nullptr;
+    return 0;
+}
+
+Py_ssize_t column_length(PyObject* self)
+{
+    return reinterpret_cast<ColumnObject*>(self)->length;
+}
+
+PyObject* column_repr(PyObject* self)
+{
+    auto* column = reinterpret_cast<ColumnObject*>(self);
+    return PyUnicode_FromFormat("<cayene.Column format='%s' length=%zd>", column->format,
+                                column->length);
+}
+
+PyType_Slot g_column_slots[] = {
+    {Py_tp_dealloc, reinterpret_cast<void*>(&column_dealloc)},
+    {Py_tp_repr, reinterpret_cast<void*>(&column_repr)},
+    {Py_sq_length, reinterpret_cast<void*>(&column_length)},
+    {Py_bf_getbuffer, reinterpret_cast<void*>(&column_getbuffer)},
+    {Py_tp_doc, const_cast<char*>("Read-only decoded column supporting the buffer protocol")},
+    {0, nullptr},
+};
+
+PyType_Spec g_column_spec = {
+    "cayene.Column",
+    sizeof(ColumnObject),
+    0,
+#if PY_VERSION_HEX >= 0x030A0000
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+#else
+    Py_TPFLAGS_DEFAULT,
+#endif
+    g_column_slots,
+};
+
+// ============================================================================
+// Batch decoding
+// ============================================================================
+
+/**
+ * @brief Columnar decode output, one row per decoded value
+ */
+struct Columns
+{
+    std::vector<std::uint32_t> device;
+    std::vector<std::uint8_t> channel;
+    std::vector<std::uint8_t> type;
+    std::vector<std::uint8_t> component;
+    std::vector<double> value;
+    std::vector<std::uint8_t> status;
+};
+
+/**
+ * @brief Payload views pinned for the duration of a batch
+ */
+struct BatchInput
+{
+    BatchInput() = default;
+    BatchInput(const BatchInput&) = delete;
+    BatchInput& operator=(const BatchInput&) = delete;
+
+    // Runs with the GIL held
+    ~BatchInput()
+    {
+        for (Py_buffer& view : views)
+        {
+            PyBuffer_Release(&view);
+        }
+    }
+
+    bool pin(PyObject* object)
+    {
+        Py_buffer view;
+        if (PyObject_GetBuffer(object, &view, PyBUF_SIMPLE) != 0)
+        {
+            return false;
+        }
+        views.push_back(view);
+        return true;
+    }
+
+    std::vector<Py_buffer> views;
+    std::vector<std::span<const std::uint8_t>> payloads;
+    std::size_t total_size = 0;
+};
+
+std::span<const std::uint8_t> as_bytes(const Py_buffer& view, Py_ssize_t begin, Py_ssize_t end)
+{
+    return {static_cast<const std::uint8_t*>(view.buf) + begin,
+            static_cast<std::size_t>(end - begin)};
+}
+
+bool collect_list(PyObject* payloads, BatchInput& input)
+{
+    if (PyObject_CheckBuffer(payloads) != 0)
+    {
+        PyErr_SetString(PyExc_TypeError,
+                        "offsets are required when payloads is a single buffer");
+        return false;
+    }
+
+    PyObject* sequence = PySequence_Fast(payloads, "payloads must be a sequence of bytes-like "
+                                                   "objects or a buffer with offsets");
+    if (sequence == nullptr)
+    {
+        return false;
+    }
+
+    const Py_ssize_t count = PySequence_Fast_GET_SIZE(sequence);
+    PyObject** items = PySequence_Fast_ITEMS(sequence);
+    input.views.reserve(static_cast<std::size_t>(count));
+    input.payloads.reserve(static_cast<std::size_t>(count));
+    for (Py_ssize_t i = 0; i < count; ++i)
+    {
+        if (!input.pin(items[i]))
+        {
+            Py_DECREF(sequence);
+            return false;
+        }
+        const Py_buffer& view = input.views.back();
+        input.payloads.push_back(as_bytes(view, 0, view.len));
+        input.total_size += static_cast<std::size_t>(view.len);
+    }
+
+    Py_DECREF(sequence);
+    return true;
+}
+
+bool collect_concatenated(PyObject* data, PyObject* offsets, BatchInput& input)
+{
+    if (!input.pin(data))
+    {
+        return false;
+    }
+    const Py_buffer& view = input.views.back();
+
+    PyObject* sequence = PySequence_Fast(offsets, "offsets must be a sequence of integers");
+    if (sequence == nullptr)
+    {
+        return false;
+    }
+
+    const Py_ssize_t count = PySequence_Fast_GET_SIZE(sequence);
+    PyObject** items = PySequence_Fast_ITEMS(sequence);
+    if (count == 0)
+    {
+        Py_DECREF(sequence);
+        PyErr_SetString(PyExc_ValueError, "offsets must hold payload count + 1 entries");
+        return false;
+    }
+
+    input.payloads.reserve(static_cast<std::size_t>(count - 1));
+    Py_ssize_t previous = 0;
+    for (Py_ssize_t i = 0; i < count; ++i)
+    {
+        const Py_ssize_t offset = PyLong_AsSsize_t(items[i]);
+        if (offset == -1 && PyErr_Occurred() != nullptr)
+        {
+            Py_DECREF(sequence);
+            return false;
+        }
+        if (offset < previous || offset > view.len)
+        {
+            Py_DECREF(sequence);
+            PyErr_Format(PyExc_ValueError,
+                         "offsets must be non-decreasing and within the buffer (index %zd)", i);
+            return false;
+        }
+        if (i > 0)
+        {
+            input.payloads.push_back(as_bytes(view, previous, offset));
+        }
+        previous = offset;
+    }
+    input.total_size = static_cast<std::size_t>(previous);
+
+    Py_DECREF(sequence);
+    return true;
+}
+
+// Called without the GIL; failed payloads are rolled back and only get a status
+void decode_columns(const cayene::Decoder& decoder, const BatchInput& input, Columns& columns)
+{
+    // Every record takes at least three bytes and most carry a single value
+    const std::size_t estimate = input.total_size / 3;
+    columns.device.reserve(estimate);
+    columns.channel.reserve(estimate);
+    columns.type.reserve(estimate);
+    columns.component.reserve(estimate);
+    columns.value.reserve(estimate);
+    columns.status.reserve(input.payloads.size());
+
+    for (std::size_t index = 0; index < input.payloads.size(); ++index)
+    {
+        const std::size_t rows = columns.value.size();
+        const auto device = static_cast<std::uint32_t>(index);
+
+        const cayene::DecodeStatus status = decoder.visit(
+            input.payloads[index],
+            [&](const cayene::Record& record)
+            {
+                for (std::uint8_t i = 0; i < record.value_count; ++i)
+                {
+                    columns.device.push_back(device);
+                    columns.channel.push_back(record.channel);
+                    columns.type.push_back(record.type_id);
+                    columns.component.push_back(i);
+                    columns.value.push_back(record.value(i));
+                }
+            });
+
+        if (!status.ok())
+        {
+            columns.device.resize(rows);
+            columns.channel.resize(rows);
+            columns.type.resize(rows);
+            columns.component.resize(rows);
+            columns.value.resize(rows);
+        }
+        columns.status.push_back(static_cast<std::uint8_t>(status.code));
+    }
+}
+
+PyObject* make_result(Columns& columns)
+{
+    PyObject* result = PyDict_New();
+    if (result == nullptr)
+    {
+        return nullptr;
+    }
+
+    const std::pair<const char*, PyObject*> entries[] = {
+        {"device", make_column(columns.device, "I")},
+        {"channel", make_column(columns.channel, "B")},
+        {"type", make_column(columns.type, "B")},
+        {"component", make_column(columns.component, "B")},
+        {"value", make_column(columns.value, "d")},
+        {"status", make_column(columns.status, "B")},
+    };
+
+    bool ok = true;
+    for (const auto& [name, column] : entries)
+    {
+        ok = ok && column != nullptr && PyDict_SetItemString(result, name, column) == 0;
+        Py_XDECREF(column);
+    }
+    if (!ok)
+    {
+        Py_DECREF(result);
+        return nullptr;
+    }
+    return result;
+}
+
+// ============================================================================
+// Decoder
+// ============================================================================
+
+struct DecoderObject
+{
+    PyObject_HEAD
+    cayene::Decoder* decoder;
+    Py_ssize_t active_batches;
+};
+
+PyTypeObject* g_decoder_type = nullptr;
+
+PyObject* decoder_new(PyTypeObject* type, PyObject* args, PyObject* kwargs)
+{
+    if (!PyArg_ParseTuple(args, ":Decoder") || (kwargs != nullptr && PyDict_Size(kwargs) != 0))
+    {
+        if (!PyErr_Occurred())
+        {
+            PyErr_SetString(PyExc_TypeError, "Decoder() takes no arguments");
+        }
+        return nullptr;
+    }
+
+    auto* self = reinterpret_cast<DecoderObject*>(type->tp_alloc(type, 0));
+    if (self == nullptr)
+    {
+        return nullptr;
+    }
+    try
+    {
+        self->decoder = new cayene::Decoder();
+    }
+    catch (const std::bad_alloc&)
+    {
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+    return reinterpret_cast<PyObject*>(self);
+}
+
+void decoder_dealloc(PyObject* self)
+{
+    delete reinterpret_cast<DecoderObject*>(self)->decoder;
+    PyTypeObject* type = Py_TYPE(self);
+    type->tp_free(self);
+    Py_DECREF(type);
+}
+
+// Registrations would race with batches running without the GIL
+bool check_idle(const DecoderObject* self)
+{
+    if (self->active_batches != 0)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "Decoder is busy decoding in another thread");
+        return false;
+    }
+    return true;
+}
+
+PyObject* decoder_decode_batch(PyObject* object, PyObject* args)
+{
+    auto* self = reinterpret_cast<DecoderObject*>(object);
+    PyObject* payloads = nullptr;
+    PyObject* offsets = Py_None;
+    if (!PyArg_ParseTuple(args, "O|O:decode_batch", &payloads, &offsets))
+    {
+        return nullptr;
+    }
+
+    BatchInput input;
+    const bool collected = offsets == Py_None ? collect_list(payloads, input)
+                                              : collect_concatenated(payloads, offsets, input);
+    if (!collected)
+    {
+        return nullptr;
+    }
+
+    Columns columns;
+    std::exception_ptr failure;
+    ++self->active_batches;
+    Py_BEGIN_ALLOW_THREADS
+    try
+    {
+        decode_columns(*self->decoder, input, columns);
+    }
+    catch (...)
+    {
+        // No Python API without the GIL; raise once it is held again
+        failure = std::current_exception();
+    }
+    Py_END_ALLOW_THREADS
+    --self->active_batches;
+
+    if (failure)
+    {
+        try
+        {
+            std::rethrow_exception(failure);
+        }
+        catch (const std::bad_alloc&)
+        {
+            return PyErr_NoMemory();
+        }
+        catch (const std::exception& error)
+        {
+            PyErr_SetString(PyExc_RuntimeError, error.what());
+            return nullptr;
+        }
+        catch (...)
+        {
+            PyErr_SetString(PyExc_RuntimeError, "decode_batch failed");
+            return nullptr;
+        }
+    }
+    return make_result(columns);
+}
+
+PyObject* decoder_add_custom_type(PyObject* object, PyObject* args)
+{
+    auto* self = reinterpret_cast<DecoderObject*>(object);
+    unsigned char type_id = 0;
+    const char* name = nullptr;
+    Py_ssize_t size = 0;
+    if (!PyArg_ParseTuple(args, "bsn:add_custom_type", &type_id, &name, &size))
+    {
+        return nullptr;
+    }
+    if (size <= 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "size must be positive");
+        return nullptr;
+    }
+    if (!check_idle(self))
+    {
+        return nullptr;
+    }
+
+    // Columns only hold numeric values; custom records are skipped over by size
+    try
+    {
+        const bool added = self->decoder->add_custom_type(
+            type_id, name, static_cast<std::size_t>(size),
+            [](std::span<const std::uint8_t>) { return cayene::Json(nullptr); });
+        return PyBool_FromLong(added ? 1 : 0);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return PyErr_NoMemory();
+    }
+}
+
+PyObject* decoder_remove_custom_type(PyObject* object, PyObject* args)
+{
+    auto* self = reinterpret_cast<DecoderObject*>(object);
+    unsigned char type_id = 0;
+    if (!PyArg_ParseTuple(args, "b:remove_custom_type", &type_id) || !check_idle(self))
+    {
+        return nullptr;
+    }
+    return PyBool_FromLong(self->decoder->remove_custom_type(type_id) ? 1 : 0);
+}
+
+PyObject* decoder_has_type(PyObject* object, PyObject* args)
+{
+    auto* self = reinterpret_cast<DecoderObject*>(object);
+    unsigned char type_id = 0;
+    if (!PyArg_ParseTuple(args, "b:has_type", &type_id))
+    {
+        return nullptr;
+    }
+    return PyBool_FromLong(self->decoder->has_type(type_id) ? 1 : 0);
+}
+
+PyMethodDef g_decoder_methods[] = {
+    {"decode_batch", &decoder_decode_batch, METH_VARARGS,
+     "decode_batch(payloads[, offsets]) -> dict of Column\n\n"
+     "Decode a sequence of bytes-like payloads, or one buffer split at offsets\n"
+     "(payload count + 1 entries), into one row per value with the columns\n"
+     "device (payload index), channel, type, component, value; 'status' holds\n"
+     "one error code per payload. Failed payloads contribute no rows."},
+    {"add_custom_type", &decoder_add_custom_type, METH_VARARGS,
+     "add_custom_type(type_id, name, size) -> bool\n\n"
+     "Register a custom type so its records are skipped instead of failing."},
+    {"remove_custom_type", &decoder_remove_custom_type, METH_VARARGS,
+     "remove_custom_type(type_id) -> bool"},
+    {"has_type", &decoder_has_type, METH_VARARGS, "has_type(type_id) -> bool"},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyType_Slot g_decoder_slots[] = {
+    {Py_tp_new, reinterpret_cast<void*>(&decoder_new)},
+    {Py_tp_dealloc, reinterpret_cast<void*>(&decoder_dealloc)},
+    {Py_tp_methods, g_decoder_methods},
+    {Py_tp_doc, const_cast<char*>("Cayene LPP decoder with batch columnar output")},
+    {0, nullptr},
+};
+
+PyType_Spec g_decoder_spec = {
+    "cayene.Decoder",
+    sizeof(DecoderObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    g_decoder_slots,
+};
+
+// ============================================================================
+// Module
+// ============================================================================
+
+PyModuleDef g_module = {
+    PyModuleDef_HEAD_INIT,
+    "cayene",
+    "Cayene LPP batch decoding into columnar buffers",
+    -1,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+};
+
+bool add_type(PyObject* module, const char* name, PyType_Spec* spec, PyTypeObject*& type)
+{
+    type = reinterpret_cast<PyTypeObject*>(PyType_FromSpec(spec));
+    if (type == nullptr)
+    {
+        return false;
+    }
+    Py_INCREF(type);
+    if (PyModule_AddObject(module, name, reinterpret_cast<PyObject*>(type)) != 0)
+    {
+        Py_DECREF(type);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+PyMODINIT_FUNC PyInit_cayene()
+{
+    PyObject* module = PyModule_Create(&g_module);
+    if (module == nullptr)
+    {
+        return nullptr;
+    }
+
+    const bool ok =
+        add_type(module, "Column", &g_column_spec, g_column_type) &&
+        add_type(module, "Decoder", &g_decoder_spec, g_decoder_type) &&
+        PyModule_AddIntConstant(module, "OK", 0) == 0 &&
+        PyModule_AddIntConstant(module, "PAYLOAD_EMPTY",
+                                static_cast<long>(cayene::ErrorCode::PayloadEmpty)) == 0 &&
+        PyModule_AddIntConstant(module, "UNKNOWN_DATA_TYPE",
+                                static_cast<long>(cayene::ErrorCode::UnknownDataType)) == 0 &&
+        PyModule_AddIntConstant(module, "BAD_PAYLOAD_FORMAT",
+                                static_cast<long>(cayene::ErrorCode::BadPayloadFormat)) == 0 &&
+        PyModule_AddIntConstant(module, "UNEXPECTED",
+                                static_cast<long>(cayene::ErrorCode::Unexpected)) == 0;
+    if (!ok)
+    {
+        Py_DECREF(module);
+        return nullptr;
+    }
+    return module;
+}
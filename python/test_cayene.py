@@ -0,0 +1,94 @@
+"""Tests for the cayene CPython extension (run by ctest with the module on PYTHONPATH)."""
+
+import threading
+import unittest
+
+import cayene
+
+TEMPERATURE_HUMIDITY = bytes([0x01, 0x67, 0x01, 0x10, 0x02, 0x68, 0x02, 0x58])
+UNKNOWN_TYPE = bytes([0x03, 0xFF, 0x00])
+ACCELEROMETER = bytes([0x04, 0x71, 0x04, 0xD2, 0xFB, 0x2E, 0x00, 0x00])
+
+
+def columns_as_lists(columns):
+    return {name: memoryview(column).tolist() for name, column in columns.items()}
+
+
+class DecodeBatchTest(unittest.TestCase):
+    def setUp(self):
+        self.decoder = cayene.Decoder()
+
+    def test_list_of_payloads(self):
+        columns = columns_as_lists(
+            self.decoder.decode_batch([TEMPERATURE_HUMIDITY, UNKNOWN_TYPE, ACCELEROMETER]))
+        self.assertEqual(columns["device"], [0, 0, 2, 2, 2])
+        self.assertEqual(columns["channel"], [1, 2, 4, 4, 4])
+        self.assertEqual(columns["type"], [0x67, 0x68, 0x71, 0x71, 0x71])
+        self.assertEqual(columns["component"], [0, 0, 0, 1, 2])
+        self.assertEqual(columns["value"], [27.2, 60.0, 1.234, -1.234, 0.0])
+        self.assertEqual(columns["status"], [cayene.OK, cayene.UNKNOWN_DATA_TYPE, cayene.OK])
+
+    def test_concatenated_buffer_matches_list(self):
+        payloads = [TEMPERATURE_HUMIDITY, UNKNOWN_TYPE, ACCELEROMETER]
+        offsets = [0]
+        for payload in payloads:
+            offsets.append(offsets[-1] + len(payload))
+        self.assertEqual(
+            columns_as_lists(self.decoder.decode_batch(bytearray(b"".join(payloads)), offsets)),
+            columns_as_lists(self.decoder.decode_batch(payloads)))
+
+    def test_buffer_protocol_format(self):
+        columns = self.decoder.decode_batch([TEMPERATURE_HUMIDITY])
+        view = memoryview(columns["value"])
+        self.assertEqual(view.format, "d")
+        self.assertEqual(view.shape, (2,))
+        self.assertTrue(view.readonly)
+        self.assertEqual(memoryview(columns["device"]).format, "I")
+        self.assertEqual(len(columns["channel"]), 2)
+
+    def test_empty_batch(self):
+        columns = self.decoder.decode_batch([])
+        self.assertEqual(len(columns["value"]), 0)
+        self.assertEqual(len(columns["status"]), 0)
+
+    def test_invalid_arguments(self):
+        with self.assertRaises(TypeError):
+            self.decoder.decode_batch(TEMPERATURE_HUMIDITY)
+        with self.assertRaises(TypeError):
+            self.decoder.decode_batch([TEMPERATURE_HUMIDITY, 42])
+        with self.assertRaises(ValueError):
+            self.decoder.decode_batch(TEMPERATURE_HUMIDITY, [0, 9])
+        with self.assertRaises(ValueError):
+            self.decoder.decode_batch(TEMPERATURE_HUMIDITY, [4, 0])
+
+    def test_custom_types_are_skipped(self):
+        payload = bytes([0x05, 200, 0xAA, 0xBB]) + TEMPERATURE_HUMIDITY
+        self.assertEqual(
+            memoryview(self.decoder.decode_batch([payload])["status"]).tolist(),
+            [cayene.UNKNOWN_DATA_TYPE])
+
+        self.assertTrue(self.decoder.add_custom_type(200, "Custom", 2))
+        self.assertTrue(self.decoder.has_type(200))
+        columns = columns_as_lists(self.decoder.decode_batch([payload]))
+        self.assertEqual(columns["status"], [cayene.OK])
+        self.assertEqual(columns["type"], [0x67, 0x68])
+        self.assertTrue(self.decoder.remove_custom_type(200))
+
+    def test_concurrent_batches(self):
+        payloads = [TEMPERATURE_HUMIDITY, ACCELEROMETER] * 5000
+        expected = columns_as_lists(self.decoder.decode_batch(payloads))
+        results = []
+
+        def run():
+            results.append(columns_as_lists(self.decoder.decode_batch(payloads)))
+
+        threads = [threading.Thread(target=run) for _ in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(results, [expected] * 4)
+
+
+if __name__ == "__main__":
+    unittest.main()
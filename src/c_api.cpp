@@ -0,0 +1,378 @@
+/**
+ * @file c_api.cpp
+ * @brief Implementation of the C ABI on top of cayene::Decoder
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include "cayene/c_api.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <string>
+
+#include "cayene/decoder.hpp"
+
+struct cayene_decoder
+{
+    cayene::Decoder decoder;
+};
+
+namespace
+{
+
+static_assert(static_cast<int>(cayene::ErrorCode::PayloadEmpty) == CAYENE_PAYLOAD_EMPTY);
+static_assert(static_cast<int>(cayene::ErrorCode::UnknownDataType) == CAYENE_UNKNOWN_DATA_TYPE);
+static_assert(static_cast<int>(cayene::ErrorCode::BadPayloadFormat) == CAYENE_BAD_PAYLOAD_FORMAT);
+static_assert(static_cast<int>(cayene::ErrorCode::Unexpected) == CAYENE_UNEXPECTED);
+static_assert(static_cast<int>(cayene::ErrorCode::BufferTooSmall) == CAYENE_BUFFER_TOO_SMALL);
+
+// Nothing may propagate across the C boundary; map escaping exceptions to a status
+template <typename Function, typename Result>
+Result guarded(Function&& function, Result failure) noexcept
+{
+#ifdef __cpp_exceptions
+    try
+    {
+        return function();
+    }
+    catch (...)
+    {
+        return failure;
+    }
+#else
+    static_cast<void>(failure);
+    return function();
+#endif
+}
+
+cayene_status to_c_status(cayene::ErrorCode code) noexcept
+{
+    return static_cast<cayene_status>(code);
+}
+
+cayene_result to_c_result(const cayene::DecodeStatus& status) noexcept
+{
+    return {to_c_status(status.code), status.type_id, status.offset, status.count};
+}
+
+cayene_result invalid_result() noexcept
+{
+    return {CAYENE_INVALID_ARGUMENT, 0, 0, 0};
+}
+
+// Batch inputs are addressed with size_t offsets, so a record offset must never be narrower
+static_assert(sizeof(cayene_record::data_offset) >= sizeof(std::size_t),
+              "cayene_record::data_offset must hold any batch input offset");
+
+cayene_record to_c_record(const cayene::Record& record, const std::uint8_t* base) noexcept
+{
+    cayene_record c_record{};
+    c_record.channel = record.channel;
+    c_record.type_id = record.type_id;
+    c_record.value_count = record.value_count;
+    c_record.data_size = static_cast<std::uint32_t>(record.data.size());
+    c_record.data_offset = static_cast<std::uint64_t>(record.data.data() - base);
+    for (std::size_t i = 0; i < record.value_count; ++i)
+    {
+        c_record.raw[i] = record.raw[i];
+        c_record.value[i] = record.value(i);
+    }
+    return c_record;
+}
+
+cayene::DecoderFunction make_custom_decoder(cayene_custom_decode_fn decode_fn, void* user_data)
+{
+    return [decode_fn, user_data](std::span<const std::uint8_t> data) -> cayene::Json
+    {
+        std::array<char, 256> buffer{};
+        const std::size_t length =
+            decode_fn(user_data, data.data(), data.size(), buffer.data(), buffer.size());
+
+        cayene::Json value;
+        if (length <= buffer.size())
+        {
+            value = cayene::Json::parse(buffer.data(), buffer.data() + length, nullptr, false);
+        }
+        else
+        {
+            std::string text(length, '\0');
+            const std::size_t written =
+                decode_fn(user_data, data.data(), data.size(), text.data(), text.size());
+            text.resize(std::min(written, text.size()));
+            value = cayene::Json::parse(text, nullptr, false);
+        }
+
+        // Invalid JSON from the callback decodes as null rather than failing the payload
+        return value.is_discarded() ? cayene::Json(nullptr) : value;
+    };
+}
+
+bool valid_input(const cayene_decoder* decoder, const void* data, std::size_t size) noexcept
+{
+    return decoder != nullptr && (data != nullptr || size == 0);
+}
+
+}  // namespace
+
+extern "C" {
+
+cayene_decoder* cayene_decoder_new(void)
+{
+    return guarded([] { return new (std::nothrow) cayene_decoder(); },
+                   static_cast<cayene_decoder*>(nullptr));
+}
+
+void cayene_decoder_free(cayene_decoder* decoder)
+{
+    delete decoder;
+}
+
+cayene_status cayene_decoder_add_custom_type(cayene_decoder* decoder, std::uint8_t type_id,
+                                             const char* name, std::size_t size,
+                                             cayene_custom_decode_fn decode_fn, void* user_data)
+{
+    if (decoder == nullptr || name == nullptr || decode_fn == nullptr)
+    {
+        return CAYENE_INVALID_ARGUMENT;
+    }
+
+    return guarded(
+        [&]
+        {
+            const bool added = decoder->decoder.add_custom_type(
+                type_id, name, size, make_custom_decoder(decode_fn, user_data));
+            return added ? CAYENE_OK : CAYENE_INVALID_ARGUMENT;
+        },
+        CAYENE_UNEXPECTED);
+}
+
+int cayene_decoder_remove_custom_type(cayene_decoder* decoder, std::uint8_t type_id)
+{
+    return decoder != nullptr && decoder->decoder.remove_custom_type(type_id) ? 1 : 0;
+}
+
+int cayene_decoder_has_type(const cayene_decoder* decoder, std::uint8_t type_id)
+{
+    return decoder != nullptr && decoder->decoder.has_type(type_id) ? 1 : 0;
+}
+
+const char* cayene_status_message(cayene_status status)
+{
+    if (status == CAYENE_INVALID_ARGUMENT)
+    {
+        return "Invalid argument";
+    }
+    return cayene::error_message(static_cast<cayene::ErrorCode>(status));
+}
+
+cayene_result cayene_validate(const cayene_decoder* decoder, const std::uint8_t* payload,
+                              std::size_t payload_size)
+{
+    if (!valid_input(decoder, payload, payload_size))
+    {
+        return invalid_result();
+    }
+    return to_c_result(decoder->decoder.validate({payload, payload_size}));
+}
+
+cayene_result cayene_decode_records(const cayene_decoder* decoder, const std::uint8_t* payload,
+                                    std::size_t payload_size, cayene_record* records,
+                                    std::size_t record_capacity)
+{
+    if (!valid_input(decoder, payload, payload_size) ||
+        (records == nullptr && record_capacity != 0))
+    {
+        return invalid_result();
+    }
+
+    std::size_t written = 0;
+    const cayene::DecodeStatus status = decoder->decoder.visit(
+        {payload, payload_size},
+        [&](const cayene::Record& record)
+        {
+            if (written < record_capacity)
+            {
+                records[written] = to_c_record(record, payload);
+            }
+            ++written;
+        });
+
+    cayene_result result = to_c_result(status);
+    if (status.ok() && written > record_capacity)
+    {
+        result.status = CAYENE_BUFFER_TOO_SMALL;
+    }
+    result.count = std::min(written, record_capacity);
+    return result;
+}
+
+cayene_result cayene_decode_json(const cayene_decoder* decoder, const std::uint8_t* payload,
+                                 std::size_t payload_size, char* json_out,
+                                 std::size_t json_capacity)
+{
+    if (!valid_input(decoder, payload, payload_size) ||
+        (json_out == nullptr && json_capacity != 0))
+    {
+        return invalid_result();
+    }
+
+    return guarded(
+        [&]
+        {
+            return to_c_result(
+                decoder->decoder.write_json({payload, payload_size}, {json_out, json_capacity}));
+        },
+        cayene_result{CAYENE_UNEXPECTED, 0, 0, 0});
+}
+
+cayene_batch_result cayene_decode_records_batch(const cayene_decoder* decoder,
+                                                const std::uint8_t* data,
+                                                const std::size_t* payload_offsets,
+                                                std::size_t payload_count, cayene_record* records,
+                                                std::size_t record_capacity,
+                                                std::size_t* record_offsets,
+                                                cayene_status* statuses)
+{
+    cayene_batch_result batch{CAYENE_OK, 0, 0, 0};
+    if (decoder == nullptr ||
+        (payload_count != 0 && (payload_offsets == nullptr || data == nullptr)) ||
+        (records == nullptr && record_capacity != 0))
+    {
+        batch.status = CAYENE_INVALID_ARGUMENT;
+        return batch;
+    }
+
+    for (; batch.payloads < payload_count; ++batch.payloads)
+    {
+        const std::size_t index = batch.payloads;
+        if (record_offsets != nullptr)
+        {
+            record_offsets[index] = batch.produced;
+        }
+
+        cayene_status status = CAYENE_INVALID_ARGUMENT;
+        if (payload_offsets[index] <= payload_offsets[index + 1])
+        {
+            const std::span<const std::uint8_t> payload(
+                data + payload_offsets[index], payload_offsets[index + 1] - payload_offsets[index]);
+
+            // Decode into the free tail; it only becomes visible once the payload fully succeeds
+            std::size_t written = 0;
+            const std::size_t available = record_capacity - batch.produced;
+            const cayene::DecodeStatus decoded = decoder->decoder.visit(
+                payload,
+                [&](const cayene::Record& record)
+                {
+                    if (written < available)
+                    {
+                        records[batch.produced + written] = to_c_record(record, data);
+                    }
+                    ++written;
+                });
+
+            if (decoded.ok() && written > available)
+            {
+                batch.status = CAYENE_BUFFER_TOO_SMALL;
+                return batch;
+            }
+            if (decoded.ok())
+            {
+                batch.produced += written;
+            }
+            status = to_c_status(decoded.code);
+        }
+
+        if (status != CAYENE_OK)
+        {
+            ++batch.failed;
+        }
+        if (statuses != nullptr)
+        {
+            statuses[index] = status;
+        }
+    }
+
+    if (record_offsets != nullptr)
+    {
+        record_offsets[payload_count] = batch.produced;
+    }
+    return batch;
+}
+
+cayene_batch_result cayene_decode_json_batch(const cayene_decoder* decoder,
+                                             const std::uint8_t* data,
+                                             const std::size_t* payload_offsets,
+                                             std::size_t payload_count, char* json_out,
+                                             std::size_t json_capacity, std::size_t* text_offsets,
+                                             cayene_status* statuses)
+{
+    cayene_batch_result batch{CAYENE_OK, 0, 0, 0};
+    if (decoder == nullptr ||
+        (payload_count != 0 && (payload_offsets == nullptr || data == nullptr)) ||
+        (json_out == nullptr && json_capacity != 0))
+    {
+        batch.status = CAYENE_INVALID_ARGUMENT;
+        return batch;
+    }
+
+    for (; batch.payloads < payload_count; ++batch.payloads)
+    {
+        const std::size_t index = batch.payloads;
+        if (text_offsets != nullptr)
+        {
+            text_offsets[index] = batch.produced;
+        }
+
+        cayene_status status = CAYENE_INVALID_ARGUMENT;
+        if (payload_offsets[index] <= payload_offsets[index + 1])
+        {
+            const std::span<const std::uint8_t> payload(
+                data + payload_offsets[index], payload_offsets[index + 1] - payload_offsets[index]);
+
+            // Keep one byte for the newline terminating the object
+            const std::size_t available = json_capacity - batch.produced;
+            const std::span<char> output(json_out + batch.produced,
+                                         available > 0 ? available - 1 : 0);
+
+            const cayene::DecodeStatus written = guarded(
+                [&] { return decoder->decoder.write_json(payload, output); },
+                cayene::DecodeStatus{cayene::ErrorCode::Unexpected, 0, 0, 0});
+
+            if (written.code == cayene::ErrorCode::BufferTooSmall ||
+                (written.ok() && available == 0))
+            {
+                batch.status = CAYENE_BUFFER_TOO_SMALL;
+                return batch;
+            }
+            if (written.ok())
+            {
+                batch.produced += written.count;
+                json_out[batch.produced++] = '\n';
+            }
+            status = to_c_status(written.code);
+        }
+
+        if (status != CAYENE_OK)
+        {
+            ++batch.failed;
+        }
+        if (statuses != nullptr)
+        {
+            statuses[index] = status;
+        }
+    }
+
+    if (text_offsets != nullptr)
+    {
+        text_offsets[payload_count] = batch.produced;
+    }
+    return batch;
+}
+
+}  // extern "C"
@@ -0,0 +1,232 @@
+/**
+ * @file shared_ring.cpp
+ * @brief POSIX shared-memory and memfd mapping of the uplink ring
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include "cayene/shared_ring.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace cayene
+{
+
+namespace
+{
+
+constexpr std::size_t kSlotsOffset = sizeof(SharedRingHeader);
+
+SharedRingHeader* header_of(void* mapping) noexcept
+{
+    return static_cast<SharedRingHeader*>(mapping);
+}
+
+SharedRingSlot* slots_of(void* mapping) noexcept
+{
+    return reinterpret_cast<SharedRingSlot*>(static_cast<std::byte*>(mapping) + kSlotsOffset);
+}
+
+// Every slot starts at its own index; the magic is published last so that
+// processes opening the ring never see it half initialized
+void initialize(void* mapping, std::size_t capacity) noexcept
+{
+    auto* header = new (mapping) SharedRingHeader;
+    SharedRingSlot* slots = slots_of(mapping);
+    for (std::size_t i = 0; i < capacity; ++i)
+    {
+        new (&slots[i]) SharedRingSlot;
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    header->version = SharedRingHeader::kVersion;
+    header->slot_size = sizeof(SharedRingSlot);
+    header->capacity = capacity;
+    header->magic.store(SharedRingHeader::kMagic, std::memory_order_release);
+}
+
+// Checks a mapped segment is a published, compatible ring; unmaps it with errno EINVAL if not
+bool validate(void* mapping, std::size_t size) noexcept
+{
+    // The magic is acquired first, so the rest of the header is read complete
+    const SharedRingHeader* header = header_of(mapping);
+    const bool published =
+        header->magic.load(std::memory_order_acquire) == SharedRingHeader::kMagic;
+    const std::uint64_t capacity = header->capacity;
+    const bool compatible = published && header->version == SharedRingHeader::kVersion &&
+                            header->slot_size == sizeof(SharedRingSlot) && capacity >= 2 &&
+                            std::has_single_bit(capacity) &&
+                            size == kSlotsOffset + (capacity * sizeof(SharedRingSlot));
+    if (!compatible)
+    {
+        ::munmap(mapping, size);
+        errno = EINVAL;
+    }
+    return compatible;
+}
+
+std::size_t ring_bytes(std::size_t capacity) noexcept
+{
+    return kSlotsOffset + (capacity * sizeof(SharedRingSlot));
+}
+
+std::size_t round_capacity(std::size_t capacity) noexcept
+{
+    return std::bit_ceil(std::max<std::size_t>(capacity, 2));
+}
+
+}  // namespace
+
+std::optional<SharedUplinkRing> SharedUplinkRing::create(const std::string& name,
+                                                         std::size_t capacity)
+{
+    capacity = round_capacity(capacity);
+    const std::size_t size = ring_bytes(capacity);
+
+    detail::ShmSegmentId segment;
+    void* mapping = detail::create_shm(name, size, segment);
+    if (mapping == nullptr)
+    {
+        return std::nullopt;
+    }
+    initialize(mapping, capacity);
+    return SharedUplinkRing(mapping, size, -1, name, true, segment);
+}
+
+std::optional<SharedUplinkRing> SharedUplinkRing::open(const std::string& name)
+{
+    std::size_t size = 0;
+    void* mapping = detail::open_shm(name, true, kSlotsOffset, size);
+    if (mapping == nullptr || !validate(mapping, size))
+    {
+        return std::nullopt;
+    }
+    return SharedUplinkRing(mapping, size, -1, name, false, {});
+}
+
+std::optional<SharedUplinkRing> SharedUplinkRing::create_anonymous(std::size_t capacity)
+{
+#ifdef __linux__
+    capacity = round_capacity(capacity);
+    const std::size_t size = ring_bytes(capacity);
+
+    const int fd = ::memfd_create("cayene-uplinks", MFD_CLOEXEC);
+    if (fd < 0)
+    {
+        return std::nullopt;
+    }
+    void* mapping = detail::map_new_shm(fd, size);
+    if (mapping == nullptr)
+    {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        return std::nullopt;
+    }
+    initialize(mapping, capacity);
+    return SharedUplinkRing(mapping, size, fd, {}, true, {});
+#else
+    static_cast<void>(capacity);
+    errno = ENOSYS;
+    return std::nullopt;
+#endif
+}
+
+std::optional<SharedUplinkRing> SharedUplinkRing::open_fd(int fd)
+{
+    const int own = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (own < 0)
+    {
+        return std::nullopt;
+    }
+    std::size_t size = 0;
+    void* mapping = detail::map_shm(own, true, kSlotsOffset, size);
+    if (mapping == nullptr || !validate(mapping, size))
+    {
+        const int error = errno;
+        ::close(own);
+        errno = error;
+        return std::nullopt;
+    }
+    return SharedUplinkRing(mapping, size, own, {}, false, {});
+}
+
+SharedUplinkRing::SharedUplinkRing(void* mapping, std::size_t size, int fd, std::string name,
+                                   bool owner, detail::ShmSegmentId segment)
+    : mapping_(mapping),
+      size_(size),
+      fd_(fd),
+      name_(std::move(name)),
+      owner_(owner),
+      segment_(segment),
+      header_(header_of(mapping)),
+      slots_(slots_of(mapping)),
+      capacity_(static_cast<std::size_t>(header_->capacity)),
+      mask_(capacity_ - 1)
+{
+}
+
+SharedUplinkRing::SharedUplinkRing(SharedUplinkRing&& other) noexcept
+    : mapping_(std::exchange(other.mapping_, nullptr)),
+      size_(other.size_),
+      fd_(std::exchange(other.fd_, -1)),
+      name_(std::move(other.name_)),
+      owner_(std::exchange(other.owner_, false)),
+      segment_(other.segment_),
+      header_(other.header_),
+      slots_(other.slots_),
+      capacity_(other.capacity_),
+      mask_(other.mask_)
+{
+}
+
+SharedUplinkRing& SharedUplinkRing::operator=(SharedUplinkRing&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        mapping_ = std::exchange(other.mapping_, nullptr);
+        size_ = other.size_;
+        fd_ = std::exchange(other.fd_, -1);
+        name_ = std::move(other.name_);
+        owner_ = std::exchange(other.owner_, false);
+        segment_ = other.segment_;
+        header_ = other.header_;
+        slots_ = other.slots_;
+        capacity_ = other.capacity_;
+        mask_ = other.mask_;
+    }
+    return *this;
+}
+
+SharedUplinkRing::~SharedUplinkRing() { release(); }
+
+void SharedUplinkRing::release() noexcept
+{
+    if (mapping_ == nullptr)
+    {
+        return;
+    }
+    ::munmap(mapping_, size_);
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    if (owner_ && !name_.empty())
+    {
+        // A later create() may have replaced the segment; its name is not ours to unlink
+        detail::unlink_shm(name_, segment_);
+    }
+    mapping_ = nullptr;
+}
+
+}  // namespace cayene
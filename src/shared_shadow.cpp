@@ -0,0 +1,159 @@
+/**
+ * @file shared_shadow.cpp
+ * @brief POSIX shared-memory mapping of the device shadow
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include "cayene/shared_shadow.hpp"
+
+#include <sys/mman.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <new>
+#include <span>
+#include <utility>
+
+namespace cayene
+{
+
+namespace
+{
+
+constexpr std::size_t kSlotsOffset = sizeof(SharedShadowHeader);
+
+SharedShadowHeader* header_of(void* mapping) noexcept
+{
+    return static_cast<SharedShadowHeader*>(mapping);
+}
+
+std::span<ShadowSlot> slots_of(void* mapping, std::size_t count) noexcept
+{
+    return {reinterpret_cast<ShadowSlot*>(static_cast<std::byte*>(mapping) + kSlotsOffset),
+            count};
+}
+
+}  // namespace
+
+std::optional<SharedShadowTable> SharedShadowTable::create(const std::string& name,
+                                                           std::size_t shard_count,
+                                                           std::size_t keys_per_shard)
+{
+    shard_count = shard_count == 0 ? 1 : shard_count;
+    const std::size_t shard_capacity = ShadowTable::shard_capacity_for(keys_per_shard);
+    const std::size_t size = kSlotsOffset + (shard_count * shard_capacity * sizeof(ShadowSlot));
+
+    detail::ShmSegmentId segment;
+    void* mapping = detail::create_shm(name, size, segment);
+    if (mapping == nullptr)
+    {
+        return std::nullopt;
+    }
+
+    // The zero-filled segment is a valid empty table; the header is completed
+    // before the magic is published so that readers never see a partial one
+    auto* header = new (mapping) SharedShadowHeader;
+    header->version = SharedShadowHeader::kVersion;
+    header->slot_size = sizeof(ShadowSlot);
+    header->shard_count = shard_count;
+    header->shard_capacity = shard_capacity;
+    header->magic.store(SharedShadowHeader::kMagic, std::memory_order_release);
+
+    return SharedShadowTable(detail::ShadowMapping(mapping, size, name, true, segment));
+}
+
+std::optional<SharedShadowView> SharedShadowView::open(const std::string& name)
+{
+    std::size_t size = 0;
+    void* mapping = detail::open_shm(name, false, kSlotsOffset, size);
+    if (mapping == nullptr)
+    {
+        return std::nullopt;
+    }
+
+    // The magic is acquired first, so the rest of the header is read complete
+    const SharedShadowHeader* header = header_of(mapping);
+    const bool published =
+        header->magic.load(std::memory_order_acquire) == SharedShadowHeader::kMagic;
+    const std::uint64_t shard_count = header->shard_count;
+    const std::uint64_t shard_capacity = header->shard_capacity;
+    const bool compatible =
+        published && header->version == SharedShadowHeader::kVersion &&
+        header->slot_size == sizeof(ShadowSlot) && shard_count != 0 &&
+        (shard_capacity & (shard_capacity - 1)) == 0 && shard_capacity != 0 &&
+        size == kSlotsOffset + (shard_count * shard_capacity * sizeof(ShadowSlot));
+    if (!compatible)
+    {
+        ::munmap(mapping, size);
+        errno = EINVAL;
+        return std::nullopt;
+    }
+    return SharedShadowView(detail::ShadowMapping(mapping, size, name, false, {}));
+}
+
+namespace detail
+{
+
+// A read-only mapping is only handed out as a const table by SharedShadowView,
+// so its slots are taken as mutable here without ever being written
+ShadowMapping::ShadowMapping(void* mapping, std::size_t size, std::string name,
+                                     bool owner, ShmSegmentId segment)
+    : mapping_(mapping),
+      size_(size),
+      name_(std::move(name)),
+      owner_(owner),
+      segment_(segment),
+      table_(slots_of(mapping, static_cast<std::size_t>(header_of(mapping)->shard_count *
+                                                        header_of(mapping)->shard_capacity)),
+             static_cast<std::size_t>(header_of(mapping)->shard_count),
+             static_cast<std::size_t>(header_of(mapping)->shard_capacity))
+{
+}
+
+ShadowMapping::ShadowMapping(ShadowMapping&& other) noexcept
+    : mapping_(std::exchange(other.mapping_, nullptr)),
+      size_(other.size_),
+      name_(std::move(other.name_)),
+      owner_(std::exchange(other.owner_, false)),
+      segment_(other.segment_),
+      table_(std::move(other.table_))
+{
+}
+
+ShadowMapping& ShadowMapping::operator=(ShadowMapping&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        mapping_ = std::exchange(other.mapping_, nullptr);
+        size_ = other.size_;
+        name_ = std::move(other.name_);
+        owner_ = std::exchange(other.owner_, false);
+        segment_ = other.segment_;
+        table_ = std::move(other.table_);
+    }
+    return *this;
+}
+
+ShadowMapping::~ShadowMapping() { release(); }
+
+void ShadowMapping::release() noexcept
+{
+    if (mapping_ == nullptr)
+    {
+        return;
+    }
+    ::munmap(mapping_, size_);
+    if (owner_)
+    {
+        // A later create() may have replaced the segment; its name is not ours to unlink
+        unlink_shm(name_, segment_);
+    }
+    mapping_ = nullptr;
+}
+
+}  // namespace detail
+
+}  // namespace cayene
@@ -0,0 +1,106 @@
+/**
+ * @file shm_segment.cpp
+ * @brief POSIX shared-memory segments behind the shadow and the uplink ring
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include "cayene/detail/shm_segment.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+namespace cayene::detail
+{
+
+void* create_shm(const std::string& name, std::size_t size, ShmSegmentId& segment) noexcept
+{
+    if (::shm_unlink(name.c_str()) != 0 && errno != ENOENT)
+    {
+        return nullptr;
+    }
+    const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    struct stat status{};
+    void* mapping = ::fstat(fd, &status) == 0 ? map_new_shm(fd, size) : nullptr;
+    const int error = errno;
+    ::close(fd);
+    if (mapping == nullptr)
+    {
+        ::shm_unlink(name.c_str());
+        errno = error;
+        return nullptr;
+    }
+    segment = ShmSegmentId{status.st_dev, status.st_ino};
+    return mapping;
+}
+
+void* map_new_shm(int fd, std::size_t size) noexcept
+{
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        return nullptr;
+    }
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    return mapping == MAP_FAILED ? nullptr : mapping;
+}
+
+void* map_shm(int fd, bool writable, std::size_t min_size, std::size_t& size) noexcept
+{
+    struct stat status{};
+    if (::fstat(fd, &status) != 0)
+    {
+        return nullptr;
+    }
+    size = static_cast<std::size_t>(status.st_size);
+    if (size < min_size)
+    {
+        errno = EINVAL;
+        return nullptr;
+    }
+    const int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* mapping = ::mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+    return mapping == MAP_FAILED ? nullptr : mapping;
+}
+
+void* open_shm(const std::string& name, bool writable, std::size_t min_size,
+               std::size_t& size) noexcept
+{
+    const int fd = ::shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    void* mapping = map_shm(fd, writable, min_size, size);
+    const int error = errno;
+    ::close(fd);
+    errno = error;
+    return mapping;
+}
+
+void unlink_shm(const std::string& name, const ShmSegmentId& segment) noexcept
+{
+    const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return;
+    }
+    struct stat status{};
+    const bool same = ::fstat(fd, &status) == 0 && status.st_dev == segment.device &&
+                      status.st_ino == segment.inode;
+    ::close(fd);
+    if (same)
+    {
+        ::shm_unlink(name.c_str());
+    }
+}
+
+}  // namespace cayene::detail
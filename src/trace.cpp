@@ -0,0 +1,263 @@
+/**
+ * @file trace.cpp
+ * @brief Implementation of pipeline stage tracing
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include "cayene/trace.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace cayene::trace
+{
+
+namespace
+{
+
+static_assert((kThreadBufferCapacity & (kThreadBufferCapacity - 1)) == 0,
+              "Thread buffer capacity must be a power of two");
+
+/**
+ * @brief One ring buffer slot, guarded by a per-slot sequence number
+ *
+ * The sequence is odd while the owner thread writes the slot and equals
+ * 2 * (position + 1) once the span at that ring position is complete.
+ */
+struct Slot
+{
+    std::atomic<std::uint64_t> sequence{0};
+    std::atomic<std::uint64_t> start_ns{0};
+    std::atomic<std::uint64_t> end_ns{0};
+    std::atomic<Stage> stage{Stage::Ingest};
+};
+
+/**
+ * @brief Single-producer ring owned by one recording thread
+ */
+struct ThreadBuffer
+{
+    explicit ThreadBuffer(std::uint32_t tid) : thread_id(tid) {}
+
+    std::uint32_t thread_id;
+    std::atomic<std::uint64_t> head{0};
+    std::array<Slot, kThreadBufferCapacity> slots{};
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::vector<ThreadBuffer*> retired;  ///< Buffers of exited threads, ready for reuse
+};
+
+// Buffers outlive their threads so spans can still be dumped after workers exit
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+std::atomic<bool> g_enabled{true};
+
+ThreadBuffer* acquire_buffer()
+{
+    Registry& reg = registry();
+    const std::lock_guard lock(reg.mutex);
+    if (!reg.retired.empty())
+    {
+        // The new thread appends after the previous owner's spans and takes over its tid
+        ThreadBuffer* buffer = reg.retired.back();
+        reg.retired.pop_back();
+        return buffer;
+    }
+    const auto tid = static_cast<std::uint32_t>(reg.buffers.size() + 1);
+    reg.buffers.push_back(std::make_unique<ThreadBuffer>(tid));
+    // Every buffer can be retired without allocating at thread exit
+    reg.retired.reserve(reg.buffers.size());
+    return reg.buffers.back().get();
+}
+
+void retire_buffer(ThreadBuffer* buffer) noexcept
+{
+    Registry& reg = registry();
+    const std::lock_guard lock(reg.mutex);
+    reg.retired.push_back(buffer);
+}
+
+/**
+ * @brief Owns the calling thread's buffer and hands it back at thread exit
+ *
+ * Memory therefore stays bounded by the peak number of threads tracing at
+ * once, however many short-lived threads a pool goes through.
+ */
+struct ThreadHandle
+{
+    ThreadHandle() : buffer(acquire_buffer()) {}
+    ~ThreadHandle() { retire_buffer(buffer); }
+
+    ThreadHandle(const ThreadHandle&) = delete;
+    ThreadHandle& operator=(const ThreadHandle&) = delete;
+    ThreadHandle(ThreadHandle&&) = delete;
+    ThreadHandle& operator=(ThreadHandle&&) = delete;
+
+    ThreadBuffer* buffer;
+};
+
+ThreadBuffer* thread_buffer()
+{
+    thread_local ThreadHandle handle;
+    return handle.buffer;
+}
+
+void write_event(std::ostream& output, bool& first, Stage stage, std::uint32_t tid,
+                 std::uint64_t start_ns, std::uint64_t end_ns)
+{
+    output << (first ? "\n" : ",\n");
+    first = false;
+
+    // Trace-event timestamps are microseconds; keep nanosecond precision as decimals
+    const std::uint64_t duration_ns = end_ns >= start_ns ? end_ns - start_ns : 0;
+    output << R"({"name":")" << stage_name(stage) << R"(","cat":"cayene","ph":"X","pid":1,"tid":)"
+           << tid << R"(,"ts":)" << start_ns / 1000U << '.' << (start_ns % 1000U) / 100U
+           << (start_ns % 100U) / 10U << start_ns % 10U << R"(,"dur":)" << duration_ns / 1000U
+           << '.' << (duration_ns % 1000U) / 100U << (duration_ns % 100U) / 10U
+           << duration_ns % 10U << '}';
+}
+
+}  // namespace
+
+const char* stage_name(Stage stage) noexcept
+{
+    switch (stage)
+    {
+        case Stage::Ingest:
+            return "ingest";
+        case Stage::Base64Decode:
+            return "base64_decode";
+        case Stage::LppDecode:
+            return "lpp_decode";
+        case Stage::Serialize:
+            return "serialize";
+        case Stage::SinkWrite:
+            return "sink_write";
+    }
+    return "unknown";
+}
+
+std::uint64_t now_ns() noexcept
+{
+    const auto since_epoch = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count());
+}
+
+void set_enabled(bool enabled) noexcept
+{
+    g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool is_enabled() noexcept
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void record(Stage stage, std::uint64_t start_ns, std::uint64_t end_ns) noexcept
+{
+    ThreadBuffer* buffer = nullptr;
+#ifdef __cpp_exceptions
+    try
+    {
+        buffer = thread_buffer();
+    }
+    catch (...)
+    {
+        // Registration failed (out of memory); drop the span rather than the request
+        return;
+    }
+#else
+    buffer = thread_buffer();
+#endif
+
+    const std::uint64_t position = buffer->head.load(std::memory_order_relaxed);
+    Slot& slot = buffer->slots[position & (kThreadBufferCapacity - 1)];
+
+    slot.sequence.store((2 * position) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.start_ns.store(start_ns, std::memory_order_relaxed);
+    slot.end_ns.store(end_ns, std::memory_order_relaxed);
+    slot.stage.store(stage, std::memory_order_relaxed);
+    slot.sequence.store(2 * (position + 1), std::memory_order_release);
+
+    buffer->head.store(position + 1, std::memory_order_release);
+}
+
+std::size_t write_chrome_trace(std::ostream& output)
+{
+    Registry& reg = registry();
+    const std::lock_guard lock(reg.mutex);
+
+    std::size_t written = 0;
+    bool first = true;
+    output << R"({"displayTimeUnit":"ns","traceEvents":[)";
+
+    for (const auto& buffer : reg.buffers)
+    {
+        output << (first ? "\n" : ",\n");
+        first = false;
+        output << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << buffer->thread_id
+               << R"(,"args":{"name":"cayene-)" << buffer->thread_id << R"("}})";
+
+        const std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+        const std::uint64_t begin = head > kThreadBufferCapacity ? head - kThreadBufferCapacity : 0;
+
+        for (std::uint64_t position = begin; position < head; ++position)
+        {
+            const Slot& slot = buffer->slots[position & (kThreadBufferCapacity - 1)];
+
+            const std::uint64_t sequence_before = slot.sequence.load(std::memory_order_acquire);
+            const std::uint64_t start_ns = slot.start_ns.load(std::memory_order_relaxed);
+            const std::uint64_t end_ns = slot.end_ns.load(std::memory_order_relaxed);
+            const Stage stage = slot.stage.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const std::uint64_t sequence_after = slot.sequence.load(std::memory_order_relaxed);
+
+            // Skip slots the owner overwrote (or is writing) while we were reading
+            if (sequence_before != 2 * (position + 1) || sequence_after != sequence_before)
+            {
+                continue;
+            }
+
+            write_event(output, first, stage, buffer->thread_id, start_ns, end_ns);
+            ++written;
+        }
+    }
+
+    output << "\n]}\n";
+    return written;
+}
+
+void clear() noexcept
+{
+    Registry& reg = registry();
+    const std::lock_guard lock(reg.mutex);
+    for (const auto& buffer : reg.buffers)
+    {
+        buffer->head.store(0, std::memory_order_release);
+        for (auto& slot : buffer->slots)
+        {
+            slot.sequence.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+}  // namespace cayene::trace
@@ -0,0 +1,771 @@
+/**
+ * @file uring_file.cpp
+ * @brief io_uring file reader/writer (raw system calls, no liburing dependency)
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include "cayene/uring_file.hpp"
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+#include "cayene/trace.hpp"
+
+namespace cayene
+{
+
+namespace detail
+{
+
+/**
+ * @brief Minimal io_uring submission/completion queue pair
+ */
+class UringQueue
+{
+public:
+    /**
+     * @brief Set up a ring and register buffers with it
+     *
+     * @return nullptr with errno set if io_uring is unavailable
+     */
+    static std::unique_ptr<UringQueue> create(unsigned entries, std::span<const iovec> buffers)
+    {
+        io_uring_params params{};
+        const auto fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0)
+        {
+            return nullptr;
+        }
+        std::unique_ptr<UringQueue> queue(new UringQueue(fd));
+        if (!queue->map(params))
+        {
+            return nullptr;
+        }
+        // Unregistered buffers still work, with a per-request page pinning cost
+        queue->registered_ = ::syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS,
+                                       buffers.data(), buffers.size()) == 0;
+        return queue;
+    }
+
+    UringQueue(const UringQueue&) = delete;
+    UringQueue& operator=(const UringQueue&) = delete;
+
+    ~UringQueue()
+    {
+        if (sqes_ != nullptr)
+        {
+            ::munmap(sqes_, sqes_size_);
+        }
+        if (cq_ring_ != nullptr && cq_ring_ != sq_ring_)
+        {
+            ::munmap(cq_ring_, cq_size_);
+        }
+        if (sq_ring_ != nullptr)
+        {
+            ::munmap(sq_ring_, sq_size_);
+        }
+        ::close(fd_);
+    }
+
+    /**
+     * @brief Queue a read or write of one registered buffer
+     *
+     * The submission queue holds as many entries as there are buffers, so
+     * it cannot overflow while each buffer has at most one request.
+     */
+    void prepare(bool write, int fd, std::size_t buffer, std::uint8_t* data, std::size_t length,
+                 std::uint64_t offset, std::uint64_t user_data) noexcept
+    {
+        const unsigned index = sq_tail_ & *sq_mask_;
+        io_uring_sqe& sqe = sqes_[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        if (registered_)
+        {
+            sqe.opcode = write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+            sqe.buf_index = static_cast<std::uint16_t>(buffer);
+        }
+        else
+        {
+            sqe.opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+        }
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uintptr_t>(data);
+        sqe.len = static_cast<std::uint32_t>(length);
+        sqe.off = offset;
+        sqe.user_data = user_data;
+        sq_array_[index] = index;
+        ++sq_tail_;
+        ++unsubmitted_;
+    }
+
+    [[nodiscard]] unsigned unsubmitted() const noexcept { return unsubmitted_; }
+
+    /**
+     * @brief Submit queued requests and optionally wait for one completion
+     */
+    bool submit(bool wait) noexcept
+    {
+        std::atomic_ref<unsigned>(*sq_tail_shared_).store(sq_tail_, std::memory_order_release);
+        const unsigned flags = wait ? IORING_ENTER_GETEVENTS : 0U;
+        while (true)
+        {
+            const long submitted = ::syscall(__NR_io_uring_enter, fd_, unsubmitted_,
+                                             wait ? 1U : 0U, flags, nullptr, 0);
+            if (submitted >= 0)
+            {
+                unsubmitted_ -= static_cast<unsigned>(submitted);
+                return true;
+            }
+            if (errno != EINTR)
+            {
+                return false;
+            }
+        }
+    }
+
+    /**
+     * @brief Take one completion without waiting
+     */
+    bool pop(io_uring_cqe& completion) noexcept
+    {
+        const unsigned head = *cq_head_;
+        if (head == std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        completion = cqes_[head & *cq_mask_];
+        std::atomic_ref<unsigned>(*cq_head_).store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    explicit UringQueue(int fd) noexcept : fd_(fd) {}
+
+    template <typename T>
+    static T* at(void* ring, std::uint32_t offset) noexcept
+    {
+        return reinterpret_cast<T*>(static_cast<std::uint8_t*>(ring) + offset);
+    }
+
+    bool map(const io_uring_params& params) noexcept
+    {
+        sq_size_ = params.sq_off.array + (params.sq_entries * sizeof(unsigned));
+        cq_size_ = params.cq_off.cqes + (params.cq_entries * sizeof(io_uring_cqe));
+        const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single)
+        {
+            sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+        }
+
+        sq_ring_ = map_region(sq_size_, IORING_OFF_SQ_RING);
+        cq_ring_ = single ? sq_ring_ : map_region(cq_size_, IORING_OFF_CQ_RING);
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(map_region(sqes_size_, IORING_OFF_SQES));
+        if (sq_ring_ == nullptr || cq_ring_ == nullptr || sqes_ == nullptr)
+        {
+            return false;
+        }
+
+        sq_tail_shared_ = at<unsigned>(sq_ring_, params.sq_off.tail);
+        sq_mask_ = at<unsigned>(sq_ring_, params.sq_off.ring_mask);
+        sq_array_ = at<unsigned>(sq_ring_, params.sq_off.array);
+        sq_tail_ = *sq_tail_shared_;
+        cq_head_ = at<unsigned>(cq_ring_, params.cq_off.head);
+        cq_tail_ = at<unsigned>(cq_ring_, params.cq_off.tail);
+        cq_mask_ = at<unsigned>(cq_ring_, params.cq_off.ring_mask);
+        cqes_ = at<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+        return true;
+    }
+
+    void* map_region(std::size_t size, off_t offset) const noexcept
+    {
+        void* region =
+            ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        return region == MAP_FAILED ? nullptr : region;
+    }
+
+    int fd_;
+    bool registered_{false};
+    void* sq_ring_{nullptr};
+    void* cq_ring_{nullptr};
+    io_uring_sqe* sqes_{nullptr};
+    std::size_t sq_size_{0};
+    std::size_t cq_size_{0};
+    std::size_t sqes_size_{0};
+    unsigned* sq_tail_shared_{nullptr};
+    unsigned* sq_mask_{nullptr};
+    unsigned* sq_array_{nullptr};
+    unsigned* cq_head_{nullptr};
+    unsigned* cq_tail_{nullptr};
+    unsigned* cq_mask_{nullptr};
+    io_uring_cqe* cqes_{nullptr};
+    unsigned sq_tail_{0};
+    unsigned unsubmitted_{0};
+};
+
+}  // namespace detail
+
+namespace
+{
+
+UringConfig normalized(UringConfig config) noexcept
+{
+    config.queue_depth = std::clamp<std::size_t>(config.queue_depth, 1, 1024);
+    config.buffer_size = std::clamp<std::size_t>(config.buffer_size, 4096, 1U << 30U);
+    return config;
+}
+
+std::vector<std::unique_ptr<std::uint8_t[]>> allocate_buffers(const UringConfig& config)
+{
+    std::vector<std::unique_ptr<std::uint8_t[]>> buffers;
+    for (std::size_t i = 0; i < config.queue_depth; ++i)
+    {
+        buffers.push_back(std::make_unique_for_overwrite<std::uint8_t[]>(config.buffer_size));
+    }
+    return buffers;
+}
+
+std::unique_ptr<detail::UringQueue> create_queue(
+    const UringConfig& config, const std::vector<std::unique_ptr<std::uint8_t[]>>& buffers)
+{
+    if (!config.use_io_uring)
+    {
+        return nullptr;
+    }
+    std::vector<iovec> vectors;
+    for (const auto& buffer : buffers)
+    {
+        vectors.push_back({buffer.get(), config.buffer_size});
+    }
+    const int error = errno;
+    auto queue = detail::UringQueue::create(static_cast<unsigned>(config.queue_depth), vectors);
+    errno = error;  // Falling back to pread/pwrite is not an error
+    return queue;
+}
+
+// Blocking transfers of the fallback path; both complete the whole range
+bool read_fully(int fd, std::uint8_t* data, std::size_t length, std::uint64_t offset) noexcept
+{
+    while (length != 0)
+    {
+        const ssize_t got = ::pread(fd, data, length, static_cast<off_t>(offset));
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (got <= 0)
+        {
+            errno = got == 0 ? EIO : errno;  // The file shrank while being read
+            return false;
+        }
+        data += got;
+        length -= static_cast<std::size_t>(got);
+        offset += static_cast<std::uint64_t>(got);
+    }
+    return true;
+}
+
+bool write_fully(int fd, const std::uint8_t* data, std::size_t length,
+                 std::uint64_t offset) noexcept
+{
+    while (length != 0)
+    {
+        const ssize_t put = ::pwrite(fd, data, length, static_cast<off_t>(offset));
+        if (put < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        if (put == 0)
+        {
+            errno = ENOSPC;  // No progress; retrying would spin
+            return false;
+        }
+        data += put;
+        length -= static_cast<std::size_t>(put);
+        offset += static_cast<std::uint64_t>(put);
+    }
+    return true;
+}
+
+}  // namespace
+
+// ---- UringFileReader ----
+
+std::optional<UringFileReader> UringFileReader::open(const std::string& path,
+                                                     const UringConfig& config)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return std::nullopt;
+    }
+    struct stat status{};
+    if (::fstat(fd, &status) != 0)
+    {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        return std::nullopt;
+    }
+    return UringFileReader(fd, static_cast<std::uint64_t>(status.st_size), config);
+}
+
+UringFileReader::UringFileReader(int fd, std::uint64_t size, const UringConfig& config)
+    : fd_(fd),
+      size_(size),
+      config_(normalized(config)),
+      buffers_(allocate_buffers(config_)),
+      queue_(create_queue(config_, buffers_))
+{
+}
+
+UringFileReader::UringFileReader(UringFileReader&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1)),
+      size_(other.size_),
+      config_(other.config_),
+      buffers_(std::move(other.buffers_)),
+      queue_(std::move(other.queue_)),
+      failed_(other.failed_)
+{
+}
+
+UringFileReader& UringFileReader::operator=(UringFileReader&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        fd_ = std::exchange(other.fd_, -1);
+        size_ = other.size_;
+        config_ = other.config_;
+        buffers_ = std::move(other.buffers_);
+        queue_ = std::move(other.queue_);
+        failed_ = other.failed_;
+    }
+    return *this;
+}
+
+UringFileReader::~UringFileReader() { release(); }
+
+void UringFileReader::release() noexcept
+{
+    queue_.reset();
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool UringFileReader::read_all(const std::function<void(std::span<const std::uint8_t>)>& callback)
+{
+    const std::size_t chunk_size = config_.buffer_size;
+    const std::uint64_t chunks = (size_ + chunk_size - 1) / chunk_size;
+    const std::size_t depth = config_.queue_depth;
+    auto length_of = [&](std::uint64_t chunk)
+    {
+        return static_cast<std::size_t>(
+            std::min<std::uint64_t>(chunk_size, size_ - (chunk * chunk_size)));
+    };
+
+    if (!queue_)
+    {
+        for (std::uint64_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            if (!read_fully(fd_, buffers_[0].get(), length_of(chunk), chunk * chunk_size))
+            {
+                return false;
+            }
+            callback(std::span<const std::uint8_t>(buffers_[0].get(), length_of(chunk)));
+        }
+        return true;
+    }
+
+    if (failed_)
+    {
+        errno = EIO;
+        return false;
+    }
+
+    // Chunk c is read into buffer c % depth; results are bytes read, or -errno
+    constexpr std::int64_t kPending = INT64_MIN;
+    std::vector<std::int64_t> results(depth, kPending);
+    std::size_t outstanding = 0;  // Reads prepared whose completion was not taken yet
+    auto queue_read = [&](std::uint64_t chunk)
+    {
+        const std::size_t buffer = chunk % depth;
+        results[buffer] = kPending;
+        queue_->prepare(false, fd_, buffer, buffers_[buffer].get(), length_of(chunk),
+                        chunk * chunk_size, chunk);
+        ++outstanding;
+    };
+
+    // Leaving early (an error, or a throwing callback) must not leave reads in flight into
+    // the buffers: the next read_all would take their completions for its own
+    struct Drain
+    {
+        UringFileReader& reader;
+        std::size_t& outstanding;
+
+        ~Drain()
+        {
+            const int error = errno;
+            reader.drain(outstanding);
+            errno = error;
+        }
+    } const drain{*this, outstanding};
+
+    for (std::uint64_t chunk = 0; chunk < std::min<std::uint64_t>(depth, chunks); ++chunk)
+    {
+        queue_read(chunk);
+    }
+    for (std::uint64_t next = 0; next < chunks; ++next)
+    {
+        const std::size_t buffer = next % depth;
+        while (results[buffer] == kPending)
+        {
+            // Also submits the refills queued since the last wait
+            if (!queue_->submit(true))
+            {
+                return false;
+            }
+            io_uring_cqe completion{};
+            while (queue_->pop(completion))
+            {
+                results[completion.user_data % depth] = completion.res;
+                --outstanding;
+            }
+        }
+
+        const std::size_t length = length_of(next);
+        if (results[buffer] < 0)
+        {
+            errno = static_cast<int>(-results[buffer]);
+            return false;
+        }
+        const auto got = static_cast<std::size_t>(results[buffer]);
+        if (got < length && !read_fully(fd_, buffers_[buffer].get() + got, length - got,
+                                        (next * chunk_size) + got))
+        {
+            return false;
+        }
+        callback(std::span<const std::uint8_t>(buffers_[buffer].get(), length));
+
+        if (next + depth < chunks)
+        {
+            queue_read(next + depth);
+            if (queue_->unsubmitted() * 2 >= depth && !queue_->submit(false))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void UringFileReader::drain(std::size_t& outstanding) noexcept
+{
+    io_uring_cqe completion{};
+    while (outstanding != 0)
+    {
+        // Also submits reads that were prepared but not submitted yet
+        if (!queue_->submit(true))
+        {
+            // Reads may still land in the buffers; never hand them out again
+            failed_ = true;
+            return;
+        }
+        while (queue_->pop(completion))
+        {
+            --outstanding;
+        }
+    }
+}
+
+// ---- UringFileWriter ----
+
+std::optional<UringFileWriter> UringFileWriter::create(const std::string& path,
+                                                       const UringConfig& config)
+{
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return std::nullopt;
+    }
+    return UringFileWriter(fd, config);
+}
+
+UringFileWriter::UringFileWriter(int fd, const UringConfig& config)
+    : fd_(fd),
+      config_(normalized(config)),
+      buffers_(allocate_buffers(config_)),
+      in_flight_(config_.queue_depth, false),
+      lengths_(config_.queue_depth, 0),
+      offsets_(config_.queue_depth, 0),
+      queue_(create_queue(config_, buffers_))
+{
+}
+
+UringFileWriter::UringFileWriter(UringFileWriter&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1)),
+      config_(other.config_),
+      buffers_(std::move(other.buffers_)),
+      in_flight_(std::move(other.in_flight_)),
+      lengths_(std::move(other.lengths_)),
+      offsets_(std::move(other.offsets_)),
+      queue_(std::move(other.queue_)),
+      current_(other.current_),
+      fill_(other.fill_),
+      offset_(other.offset_),
+      error_(other.error_)
+{
+}
+
+UringFileWriter& UringFileWriter::operator=(UringFileWriter&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        fd_ = std::exchange(other.fd_, -1);
+        config_ = other.config_;
+        buffers_ = std::move(other.buffers_);
+        in_flight_ = std::move(other.in_flight_);
+        lengths_ = std::move(other.lengths_);
+        offsets_ = std::move(other.offsets_);
+        queue_ = std::move(other.queue_);
+        current_ = other.current_;
+        fill_ = other.fill_;
+        offset_ = other.offset_;
+        error_ = other.error_;
+    }
+    return *this;
+}
+
+UringFileWriter::~UringFileWriter() { release(); }
+
+void UringFileWriter::release() noexcept
+{
+    if (fd_ < 0)
+    {
+        return;
+    }
+    flush();
+    queue_.reset();
+    ::close(fd_);
+    fd_ = -1;
+}
+
+bool UringFileWriter::write(std::span<const std::uint8_t> data)
+{
+    while (!data.empty() && error_ == 0)
+    {
+        const std::size_t take = std::min(config_.buffer_size - fill_, data.size());
+        std::memcpy(buffers_[current_].get() + fill_, data.data(), take);
+        fill_ += take;
+        data = data.subspan(take);
+        if (fill_ == config_.buffer_size && !submit_current())
+        {
+            break;
+        }
+    }
+    errno = error_ != 0 ? error_ : errno;
+    return error_ == 0;
+}
+
+bool UringFileWriter::flush()
+{
+    if (fd_ >= 0 && error_ == 0 && submit_current())
+    {
+        while (error_ == 0 &&
+               std::find(in_flight_.begin(), in_flight_.end(), true) != in_flight_.end())
+        {
+            reap(true);
+        }
+    }
+    errno = error_ != 0 ? error_ : errno;
+    return error_ == 0;
+}
+
+bool UringFileWriter::submit_current()
+{
+    if (fill_ == 0)
+    {
+        return true;
+    }
+    if (queue_)
+    {
+        lengths_[current_] = fill_;
+        offsets_[current_] = offset_;
+        in_flight_[current_] = true;
+        queue_->prepare(true, fd_, current_, buffers_[current_].get(), fill_, offset_, current_);
+        if (queue_->unsubmitted() * 2 >= config_.queue_depth && !queue_->submit(false))
+        {
+            error_ = errno;
+            return false;
+        }
+    }
+    else if (!write_fully(fd_, buffers_[current_].get(), fill_, offset_))
+    {
+        error_ = errno;
+        return false;
+    }
+
+    offset_ += fill_;
+    fill_ = 0;
+    current_ = (current_ + 1) % config_.queue_depth;
+    return wait_for(current_);
+}
+
+bool UringFileWriter::wait_for(std::size_t buffer)
+{
+    while (error_ == 0 && in_flight_[buffer])
+    {
+        reap(true);
+    }
+    return error_ == 0;
+}
+
+bool UringFileWriter::reap(bool wait)
+{
+    if (!queue_->submit(wait))
+    {
+        error_ = errno;
+        return false;
+    }
+    io_uring_cqe completion{};
+    while (queue_->pop(completion))
+    {
+        const auto buffer = static_cast<std::size_t>(completion.user_data);
+        in_flight_[buffer] = false;
+        if (completion.res < 0)
+        {
+            error_ = -completion.res;
+        }
+        else if (const auto put = static_cast<std::size_t>(completion.res);
+                 put < lengths_[buffer] &&
+                 !write_fully(fd_, buffers_[buffer].get() + put, lengths_[buffer] - put,
+                              offsets_[buffer] + put))
+        {
+            // Short writes are finished synchronously, as short reads are; this one failed
+            error_ = errno;
+        }
+    }
+    return error_ == 0;
+}
+
+// ---- JsonLinesSink ----
+
+namespace
+{
+
+constexpr std::size_t kSinkBufferBytes = 64 * 1024;
+
+}  // namespace
+
+JsonLinesSink::JsonLinesSink(const Decoder& decoder, UringFileWriter& writer, std::size_t workers,
+                             const RecordFilter& filter)
+    : decoder_(decoder),
+      writer_(writer),
+      filter_(filter),
+      buffers_(std::max<std::size_t>(workers, 1))
+{
+    for (WorkerBuffer& buffer : buffers_)
+    {
+        buffer.bytes.reserve(kSinkBufferBytes + 4096);
+    }
+}
+
+void JsonLinesSink::consume(std::size_t worker, const DecodedPayload& result)
+{
+    WorkerBuffer& buffer = buffers_[worker];
+    {
+        CAYENE_TRACE_SCOPE(trace::Stage::Serialize);
+        render(buffer, result);
+    }
+    if (buffer.bytes.size() >= kSinkBufferBytes)
+    {
+        drain(buffer);
+    }
+}
+
+void JsonLinesSink::render(WorkerBuffer& buffer, const DecodedPayload& result)
+{
+    std::array<char, 24> number{};
+    auto append_number = [&](std::uint64_t value)
+    {
+        const char* end = std::to_chars(number.data(), number.data() + number.size(), value).ptr;
+        append(buffer, std::span<const char>(number.data(), end));
+    };
+
+    append(buffer, std::string_view("{\"device\":"));
+    append_number(result.device);
+    append(buffer, std::string_view(",\"timestamp\":"));
+    append_number(result.timestamp);
+
+    std::array<char, 4096> json{};
+    DecodeStatus status = result.status;
+    if (status.ok())
+    {
+        status = decoder_.write_json(result.payload, json, filter_);
+    }
+    if (status.ok())
+    {
+        append(buffer, std::string_view(",\"data\":"));
+        append(buffer, std::span<const char>(json.data(), status.count));
+    }
+    else
+    {
+        append(buffer, std::string_view(",\"error\":\""));
+        append(buffer, std::string_view(error_message(status.code)));
+        append(buffer, std::string_view("\""));
+    }
+    append(buffer, std::string_view("}\n"));
+}
+
+void JsonLinesSink::flush(std::size_t worker) { drain(buffers_[worker]); }
+
+bool JsonLinesSink::ok() const noexcept
+{
+    const std::lock_guard lock(mutex_);
+    return !failed_;
+}
+
+void JsonLinesSink::append(WorkerBuffer& buffer, std::span<const char> text)
+{
+    const auto* bytes = reinterpret_cast<const std::uint8_t*>(text.data());
+    buffer.bytes.insert(buffer.bytes.end(), bytes, bytes + text.size());
+}
+
+void JsonLinesSink::drain(WorkerBuffer& buffer)
+{
+    if (buffer.bytes.empty())
+    {
+        return;
+    }
+    const std::lock_guard lock(mutex_);
+    if (!writer_.write(buffer.bytes))
+    {
+        failed_ = true;
+    }
+    buffer.bytes.clear();
+}
+
+}  // namespace cayene
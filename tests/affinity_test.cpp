@@ -0,0 +1,126 @@
+/**
+ * @file affinity_test.cpp
+ * @brief Unit tests for CPU topology discovery and thread pinning
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <cerrno>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cayene/affinity.hpp"
+
+namespace cayene::test
+{
+
+TEST(AffinityTest, ParsesKernelCpuLists)
+{
+    EXPECT_EQ(parse_cpu_list("0-3,8,10-11\n"),
+              (std::vector<unsigned>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(parse_cpu_list("5"), (std::vector<unsigned>{5}));
+    EXPECT_TRUE(parse_cpu_list("").empty());
+    EXPECT_TRUE(parse_cpu_list("\n").empty());  // Memory-only node
+    EXPECT_TRUE(parse_cpu_list("3-1").empty());
+    EXPECT_TRUE(parse_cpu_list("0-").empty());
+    EXPECT_TRUE(parse_cpu_list("0;1").empty());
+}
+
+TEST(AffinityTest, DetectsUsableCpus)
+{
+    const CpuTopology topology = CpuTopology::detect();
+    ASSERT_GE(topology.node_count(), 1U);
+    std::size_t cpus = 0;
+    for (const std::vector<unsigned>& node : topology.nodes)
+    {
+        EXPECT_FALSE(node.empty());
+        cpus += node.size();
+    }
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    ASSERT_EQ(::sched_getaffinity(0, sizeof(set), &set), 0);
+    EXPECT_EQ(cpus, static_cast<std::size_t>(CPU_COUNT(&set)));
+    for (const std::vector<unsigned>& node : topology.nodes)
+    {
+        for (const unsigned cpu : node)
+        {
+            EXPECT_TRUE(CPU_ISSET(cpu, &set)) << cpu;
+        }
+    }
+#endif
+}
+
+TEST(AffinityTest, SpreadsThreadsOverNodesInBlocks)
+{
+    const CpuTopology topology{{{0, 1}, {2, 3}}};
+
+    std::vector<std::size_t> nodes;
+    for (std::size_t i = 0; i < 5; ++i)
+    {
+        nodes.push_back(topology.node_of(i, 5));
+    }
+    EXPECT_EQ(nodes, (std::vector<std::size_t>{0, 0, 0, 1, 1}));
+    EXPECT_EQ(topology.node_of(0, 1), 0U);
+
+    EXPECT_TRUE(topology.cpus_for(0, 5, CpuPlacement::None).empty());
+    EXPECT_EQ(topology.cpus_for(4, 5, CpuPlacement::Node), (std::vector<unsigned>{2, 3}));
+    // Core placement deals a node's CPUs out to its threads, wrapping around
+    EXPECT_EQ(topology.cpus_for(0, 5, CpuPlacement::Core), (std::vector<unsigned>{0}));
+    EXPECT_EQ(topology.cpus_for(1, 5, CpuPlacement::Core), (std::vector<unsigned>{1}));
+    EXPECT_EQ(topology.cpus_for(2, 5, CpuPlacement::Core), (std::vector<unsigned>{0}));
+    EXPECT_EQ(topology.cpus_for(3, 5, CpuPlacement::Core), (std::vector<unsigned>{2}));
+    EXPECT_EQ(topology.cpus_for(4, 5, CpuPlacement::Core), (std::vector<unsigned>{3}));
+}
+
+TEST(AffinityTest, PinsTheCallingThread)
+{
+    const unsigned cpu = CpuTopology::detect().nodes.front().front();
+    const std::vector<unsigned> cpus{cpu};
+    const std::vector<unsigned> outside{1U << 20U};
+
+#if defined(__linux__)
+    bool ran = false;
+    EXPECT_TRUE(run_on_cpus(cpus,
+                            [&]()
+                            {
+                                ran = true;
+                                cpu_set_t set;
+                                CPU_ZERO(&set);
+                                ASSERT_EQ(::sched_getaffinity(0, sizeof(set), &set), 0);
+                                EXPECT_EQ(CPU_COUNT(&set), 1);
+                                EXPECT_TRUE(CPU_ISSET(cpu, &set));
+                            }));
+    EXPECT_TRUE(ran);
+
+    std::thread thread(
+        [&]()
+        {
+            errno = 0;
+            EXPECT_FALSE(pin_current_thread(outside));
+            EXPECT_EQ(errno, EINVAL);
+            EXPECT_FALSE(pin_current_thread({}));
+        });
+    thread.join();
+#else
+    errno = 0;
+    EXPECT_FALSE(pin_current_thread(cpus));
+    EXPECT_EQ(errno, ENOSYS);
+#endif
+}
+
+#ifndef CAYENE_NO_EXCEPTIONS
+TEST(AffinityTest, RunOnCpusRethrows)
+{
+    const std::vector<unsigned> cpus = CpuTopology::detect().nodes.front();
+    EXPECT_THROW(run_on_cpus(cpus, []() { throw std::runtime_error("allocation failed"); }),
+                 std::runtime_error);
+}
+#endif
+
+}  // namespace cayene::test
@@ -0,0 +1,217 @@
+/**
+ * @file aggregator_test.cpp
+ * @brief Unit tests for windowed aggregation
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cayene/aggregator.hpp"
+
+namespace cayene::test
+{
+
+namespace
+{
+
+constexpr std::uint64_t kWindow = 60'000;
+
+Record temperature(std::uint8_t channel, std::int32_t raw)
+{
+    Record record;
+    record.channel = channel;
+    record.type_id = 0x67;
+    record.value_count = 1;
+    record.raw[0] = raw;
+    return record;
+}
+
+}  // namespace
+
+TEST(AggregatorTest, SummarisesOneWindow)
+{
+    AggregationShard shard(kWindow);
+    shard.add(1, 1'000, temperature(1, 250));
+    shard.add(1, 30'000, temperature(1, 200));
+    shard.add(1, 20'000, temperature(1, 310));  // out of order: not the last value
+    shard.add(2, 5'000, temperature(1, 100));
+    EXPECT_EQ(shard.size(), 2U);
+
+    std::vector<WindowAggregate> output;
+    shard.drain(kWindow, output);
+    ASSERT_EQ(output.size(), 2U);
+    EXPECT_EQ(shard.size(), 0U);
+
+    const WindowAggregate& device1 = output[0].device == 1 ? output[0] : output[1];
+    EXPECT_EQ(device1.window_start, 0U);
+    EXPECT_EQ(device1.count, 3U);
+    EXPECT_DOUBLE_EQ(device1.min_value(), 20.0);
+    EXPECT_DOUBLE_EQ(device1.max_value(), 31.0);
+    EXPECT_DOUBLE_EQ(device1.mean(), 25.333333333333332);
+    EXPECT_DOUBLE_EQ(device1.last_value(), 20.0);
+    EXPECT_EQ(device1.last_timestamp, 30'000U);
+}
+
+TEST(AggregatorTest, WindowsTumble)
+{
+    AggregationShard shard(kWindow);
+    shard.add(1, 59'999, temperature(1, 1));
+    shard.add(1, 60'000, temperature(1, 2));
+    shard.add(1, 130'000, temperature(1, 3));
+
+    std::vector<WindowAggregate> output;
+    shard.drain(2 * kWindow, output);
+    ASSERT_EQ(output.size(), 2U);
+    EXPECT_EQ(shard.size(), 1U);
+
+    // The drained windows are closed: late records are dropped
+    shard.add(1, 61'000, temperature(1, 9));
+    EXPECT_EQ(shard.late_records(), 1U);
+    shard.add(1, 121'000, temperature(1, 4));
+    EXPECT_EQ(shard.size(), 1U);
+
+    output.clear();
+    shard.drain(3 * kWindow, output);
+    ASSERT_EQ(output.size(), 1U);
+    EXPECT_EQ(output[0].window_start, 2 * kWindow);
+    EXPECT_EQ(output[0].count, 2U);
+}
+
+TEST(AggregatorTest, VectorTypesAndPayloads)
+{
+    Decoder decoder;
+    AggregationShard shard(kWindow);
+    const std::vector<std::uint8_t> first = {0x04, 0x71, 0x04, 0xD2, 0xFB, 0x2E, 0x00, 0x00,
+                                             0x05, 0x68, 0x02, 0x58};
+    const std::vector<std::uint8_t> second = {0x04, 0x71, 0x00, 0x00, 0x00, 0x00, 0x03, 0xE8};
+    ASSERT_TRUE(shard.add_payload(decoder, 9, 10, first));
+    ASSERT_TRUE(shard.add_payload(decoder, 9, 20, second));
+    ASSERT_TRUE(shard.add_payload(decoder, 9, 30, first, RecordFilter::types({0x68})));
+
+    std::vector<WindowAggregate> output;
+    shard.drain(kWindow, output);
+    ASSERT_EQ(output.size(), 2U);
+    const WindowAggregate& accel = output[0].type_id == 0x71 ? output[0] : output[1];
+    const WindowAggregate& humidity = output[0].type_id == 0x71 ? output[1] : output[0];
+
+    EXPECT_EQ(accel.count, 2U);
+    EXPECT_DOUBLE_EQ(accel.max_value(0), 1.234);
+    EXPECT_DOUBLE_EQ(accel.min_value(1), -1.234);
+    EXPECT_DOUBLE_EQ(accel.mean(2), 0.5);
+    EXPECT_DOUBLE_EQ(accel.last_value(2), 1.0);
+    EXPECT_EQ(humidity.count, 2U);
+    EXPECT_DOUBLE_EQ(humidity.mean(), 60.0);
+}
+
+TEST(AggregatorTest, CustomTypesAreIgnored)
+{
+    Decoder decoder;
+    decoder.add_custom_type(0xC0, "Custom", 1,
+                            [](std::span<const std::uint8_t> data) { return Json(data[0]); });
+    AggregationShard shard(kWindow);
+    const std::vector<std::uint8_t> payload = {0x01, 0xC0, 0x2A};
+    ASSERT_TRUE(shard.add_payload(decoder, 1, 0, payload));
+    EXPECT_EQ(shard.size(), 0U);
+}
+
+TEST(AggregatorTest, GrowsBeyondReservation)
+{
+    AggregationShard shard(kWindow, 4);
+    for (std::uint32_t device = 0; device < 1000; ++device)
+    {
+        shard.add(device, 0, temperature(1, static_cast<std::int32_t>(device)));
+        shard.add(device, 1, temperature(1, 0));
+    }
+    EXPECT_EQ(shard.size(), 1000U);
+
+    std::vector<WindowAggregate> output;
+    shard.drain(kWindow, output);
+    ASSERT_EQ(output.size(), 1000U);
+    for (const WindowAggregate& aggregate : output)
+    {
+        EXPECT_EQ(aggregate.count, 2U);
+        EXPECT_EQ(aggregate.max[0], static_cast<std::int32_t>(aggregate.device));
+    }
+}
+
+TEST(AggregatorTest, ZeroShardsAndWindowLengthAreClamped)
+{
+    ShardedAggregator aggregator(0, 0);
+    ASSERT_EQ(aggregator.shard_count(), 1U);
+    EXPECT_EQ(aggregator.shard(0).window_length(), 1U);
+
+    aggregator.shard(0).add(1, 5, temperature(1, 100));
+    std::vector<WindowAggregate> output;
+    EXPECT_EQ(aggregator.close_windows(5, output), 0U);
+    EXPECT_EQ(aggregator.close_windows(6, output), 1U);
+    EXPECT_EQ(output.front().window_start, 5U);
+}
+
+TEST(AggregatorTest, MergesShardsAtWindowClose)
+{
+    ShardedAggregator aggregator(2, kWindow);
+    ASSERT_EQ(aggregator.shard_count(), 2U);
+    aggregator.shard(0).add(3, 100, temperature(1, 10));
+    aggregator.shard(1).add(3, 200, temperature(1, 30));
+    aggregator.shard(1).add(1, 300, temperature(1, 5));
+    aggregator.shard(0).add(3, 70'000, temperature(1, 7));
+
+    std::vector<WindowAggregate> output;
+    EXPECT_EQ(aggregator.close_windows(50'000, output), 0U);
+    EXPECT_EQ(aggregator.close_windows(70'001, output), 2U);
+    ASSERT_EQ(output.size(), 2U);
+    EXPECT_EQ(output[0].device, 1U);
+    EXPECT_EQ(output[1].device, 3U);
+    EXPECT_EQ(output[1].count, 2U);
+    EXPECT_DOUBLE_EQ(output[1].mean(), 2.0);
+    EXPECT_DOUBLE_EQ(output[1].last_value(), 3.0);
+
+    aggregator.shard(1).add(3, 100, temperature(1, 1));
+    EXPECT_EQ(aggregator.late_records(), 1U);
+    EXPECT_EQ(aggregator.close_all(output), 1U);
+    EXPECT_EQ(output.back().window_start, kWindow);
+}
+
+TEST(AggregatorTest, ShardsUpdateConcurrently)
+{
+    constexpr std::size_t kShards = 4;
+    constexpr int kRecords = 10'000;
+    ShardedAggregator aggregator(kShards, kWindow);
+
+    std::vector<std::thread> workers;
+    for (std::size_t index = 0; index < kShards; ++index)
+    {
+        workers.emplace_back(
+            [&shard = aggregator.shard(index)]()
+            {
+                for (int i = 0; i < kRecords; ++i)
+                {
+                    shard.add(static_cast<std::uint32_t>(i % 16), static_cast<std::uint64_t>(i),
+                              temperature(1, i % 100));
+                }
+            });
+    }
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    std::vector<WindowAggregate> output;
+    ASSERT_EQ(aggregator.close_all(output), 16U);
+    std::uint64_t total = 0;
+    for (const WindowAggregate& aggregate : output)
+    {
+        total += aggregate.count;
+        EXPECT_EQ(aggregate.min[0], static_cast<std::int32_t>(aggregate.device % 4));
+    }
+    EXPECT_EQ(total, kShards * kRecords);
+}
+
+}  // namespace cayene::test
@@ -0,0 +1,134 @@
+/**
+ * @file allocation_counter.cpp
+ * @brief Global operator new/delete replacements backing allocation_counter.hpp
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include "allocation_counter.hpp"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+thread_local std::size_t t_allocations = 0;
+
+void* counted_alloc(std::size_t size, std::size_t alignment)
+{
+    ++t_allocations;
+    if (size == 0)
+    {
+        size = 1;
+    }
+
+    void* pointer = nullptr;
+    if (alignment <= alignof(std::max_align_t))
+    {
+        pointer = std::malloc(size);  // NOLINT(cppcoreguidelines-no-malloc)
+    }
+    else
+    {
+        // aligned_alloc requires the size to be a multiple of the alignment
+        const std::size_t rounded = (size + alignment - 1) / alignment * alignment;
+        pointer = std::aligned_alloc(alignment, rounded);
+    }
+    return pointer;
+}
+
+void* counted_alloc_or_throw(std::size_t size, std::size_t alignment)
+{
+    void* pointer = counted_alloc(size, alignment);
+    if (pointer == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+}  // namespace
+
+namespace cayene::test
+{
+
+std::size_t allocation_count() noexcept
+{
+    return t_allocations;
+}
+
+}  // namespace cayene::test
+
+// NOLINTBEGIN(cppcoreguidelines-no-malloc,cppcoreguidelines-owning-memory)
+void* operator new(std::size_t size)
+{
+    return counted_alloc_or_throw(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size)
+{
+    return counted_alloc_or_throw(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return counted_alloc_or_throw(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return counted_alloc_or_throw(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t& /*tag*/) noexcept
+{
+    return counted_alloc(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& /*tag*/) noexcept
+{
+    return counted_alloc(size, alignof(std::max_align_t));
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t /*size*/) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t /*size*/) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t /*alignment*/) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t /*alignment*/) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t /*size*/, std::align_val_t /*alignment*/) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t /*size*/, std::align_val_t /*alignment*/) noexcept
+{
+    std::free(pointer);
+}
+// NOLINTEND(cppcoreguidelines-no-malloc,cppcoreguidelines-owning-memory)
@@ -0,0 +1,42 @@
+#ifndef CAYENE_TEST_ALLOCATION_COUNTER_HPP
+#define CAYENE_TEST_ALLOCATION_COUNTER_HPP
+
+/**
+ * @file allocation_counter.hpp
+ * @brief Heap allocation counting for tests via global operator new/delete hooks
+ *
+ * Link allocation_counter.cpp into a test executable to replace the global
+ * allocation functions. Counts are kept per thread so background threads
+ * (test framework, sanitizers) do not disturb measurements.
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <cstddef>
+
+namespace cayene::test
+{
+
+/**
+ * @brief Number of heap allocations made by the calling thread so far
+ */
+[[nodiscard]] std::size_t allocation_count() noexcept;
+
+/**
+ * @brief Counts the allocations made by the calling thread during its lifetime
+ */
+class AllocationScope
+{
+public:
+    AllocationScope() noexcept : start_(allocation_count()) {}
+
+    [[nodiscard]] std::size_t allocations() const noexcept { return allocation_count() - start_; }
+
+private:
+    std::size_t start_;
+};
+
+}  // namespace cayene::test
+
+#endif  // CAYENE_TEST_ALLOCATION_COUNTER_HPP
@@ -0,0 +1,250 @@
+/**
+ * @file allocation_test.cpp
+ * @brief Asserts that the allocation-free decode paths never touch the heap
+ *
+ * Every standard data type is run through validate, decode_records, visit,
+ * write_json, decode_flat, a ChangeFilter and an AggregationShard into
+ * pre-sized buffers, after one warm-up call, and the number of heap
+ * allocations made by the test thread must stay at zero.
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "allocation_counter.hpp"
+#include "cayene/aggregator.hpp"
+#include "cayene/change_filter.hpp"
+#include "cayene/decoder.hpp"
+
+namespace cayene::test
+{
+
+namespace
+{
+
+constexpr int kIterations = 100;
+
+struct PayloadCase
+{
+    std::string name;
+    std::vector<std::uint8_t> payload;
+};
+
+void PrintTo(const PayloadCase& payload_case, std::ostream* output)
+{
+    *output << payload_case.name;
+}
+
+std::vector<PayloadCase> standard_payloads()
+{
+    return {
+        {"DigitalInput", {0x01, 0x00, 0x01}},
+        {"DigitalOutput", {0x02, 0x01, 0x00}},
+        {"AnalogInput", {0x03, 0x02, 0xFF, 0x9C}},
+        {"AnalogOutput", {0x04, 0x03, 0x01, 0x2C}},
+        {"Luminosity", {0x05, 0x65, 0x01, 0x90}},
+        {"Presence", {0x06, 0x66, 0x01}},
+        {"Temperature", {0x07, 0x67, 0xFF, 0xF6}},
+        {"Humidity", {0x08, 0x68, 0x02, 0x8A}},
+        {"Accelerometer", {0x09, 0x71, 0x01, 0xF4, 0xFF, 0xD8, 0x03, 0xE8}},
+        {"Barometer", {0x0A, 0x73, 0x27, 0x7F}},
+        {"Gyrometer", {0x0B, 0x86, 0x01, 0xF4, 0xFF, 0xD8, 0x03, 0xE8}},
+        {"GPS", {0x0C, 0x88, 0x06, 0x19, 0x48, 0xF9, 0xCC, 0xE6, 0x00, 0x09, 0xC4}},
+        {"MultiSensor",
+         {0x01, 0x67, 0x01, 0x10, 0x02, 0x68, 0x02, 0x58, 0x03, 0x88, 0x06, 0x19, 0x48, 0xF9, 0xCC,
+          0xE6, 0x00, 0x09, 0xC4}},
+    };
+}
+
+}  // namespace
+
+class AllocationTest : public ::testing::TestWithParam<PayloadCase>
+{
+protected:
+    Decoder decoder_;
+};
+
+TEST_P(AllocationTest, HookCountsJsonDecode)
+{
+    // Sanity check that the hooks are active: the Json tree path allocates
+    Json result;
+    const AllocationScope scope;
+    EXPECT_TRUE(decoder_.try_decode(GetParam().payload, result));
+    EXPECT_GT(scope.allocations(), 0U);
+    EXPECT_FALSE(result.empty());
+}
+
+TEST_P(AllocationTest, ValidateDoesNotAllocate)
+{
+    const auto& payload = GetParam().payload;
+    ASSERT_TRUE(decoder_.validate(payload));
+
+    const AllocationScope scope;
+    for (int i = 0; i < kIterations; ++i)
+    {
+        EXPECT_TRUE(decoder_.validate(payload));
+    }
+    EXPECT_EQ(scope.allocations(), 0U);
+}
+
+TEST_P(AllocationTest, DecodeRecordsDoesNotAllocate)
+{
+    const auto& payload = GetParam().payload;
+    std::array<Record, 8> records{};
+    ASSERT_TRUE(decoder_.decode_records(payload, records));
+
+    const AllocationScope scope;
+    for (int i = 0; i < kIterations; ++i)
+    {
+        EXPECT_TRUE(decoder_.decode_records(payload, records));
+    }
+    EXPECT_EQ(scope.allocations(), 0U);
+}
+
+TEST_P(AllocationTest, VisitDoesNotAllocate)
+{
+    const auto& payload = GetParam().payload;
+    double sum = 0.0;
+    auto visitor = [&sum](const Record& record)
+    {
+        for (std::size_t i = 0; i < record.value_count; ++i)
+        {
+            sum += record.value(i);
+        }
+    };
+    ASSERT_TRUE(decoder_.visit(payload, visitor));
+
+    const AllocationScope scope;
+    for (int i = 0; i < kIterations; ++i)
+    {
+        EXPECT_TRUE(decoder_.visit(payload, visitor));
+    }
+    EXPECT_EQ(scope.allocations(), 0U);
+}
+
+TEST_P(AllocationTest, WriteJsonDoesNotAllocate)
+{
+    const auto& payload = GetParam().payload;
+    std::array<char, 512> buffer{};
+    ASSERT_TRUE(decoder_.write_json(payload, buffer));
+
+    const AllocationScope scope;
+    for (int i = 0; i < kIterations; ++i)
+    {
+        EXPECT_TRUE(decoder_.write_json(payload, buffer));
+    }
+    EXPECT_EQ(scope.allocations(), 0U);
+}
+
+TEST_P(AllocationTest, DecodeFlatDoesNotAllocate)
+{
+    const auto& payload = GetParam().payload;
+    FlatObject output;
+    ASSERT_TRUE(decoder_.decode_flat(payload, output));
+
+    const AllocationScope scope;
+    for (int i = 0; i < kIterations; ++i)
+    {
+        EXPECT_TRUE(decoder_.decode_flat(payload, output));
+    }
+    EXPECT_EQ(scope.allocations(), 0U);
+}
+
+TEST_P(AllocationTest, ChangeFilterDoesNotAllocate)
+{
+    const auto& payload = GetParam().payload;
+    ChangeFilter changes;
+    std::size_t reported = 0;
+    const auto count = [&reported](const Record&) { ++reported; };
+    ASSERT_TRUE(changes.visit_changes(decoder_, 1, payload, count));
+
+    const AllocationScope scope;
+    for (int i = 0; i < kIterations; ++i)
+    {
+        EXPECT_TRUE(changes.visit_changes(decoder_, 1, payload, count));
+    }
+    EXPECT_EQ(scope.allocations(), 0U);
+    EXPECT_EQ(changes.stats().suppressed, kIterations * changes.size());
+}
+
+TEST_P(AllocationTest, AggregationDoesNotAllocate)
+{
+    const auto& payload = GetParam().payload;
+    constexpr std::uint64_t kWindow = 1000;
+    AggregationShard shard(kWindow);
+    std::vector<WindowAggregate> closed;
+    closed.reserve(64);
+    ASSERT_TRUE(shard.add_payload(decoder_, 1, 0, payload));
+    shard.drain(kWindow, closed);
+
+    const AllocationScope scope;
+    for (int i = 1; i <= kIterations; ++i)
+    {
+        const auto timestamp = static_cast<std::uint64_t>(i) * kWindow;
+        EXPECT_TRUE(shard.add_payload(decoder_, 1, timestamp, payload));
+        EXPECT_TRUE(shard.add_payload(decoder_, 1, timestamp + 1, payload));
+        closed.clear();
+        shard.drain(timestamp + kWindow, closed);
+    }
+    EXPECT_EQ(scope.allocations(), 0U);
+    EXPECT_EQ(closed.front().count, 2U);
+}
+
+TEST(AggregationAllocationTest, UpdatesOfAFullShardDoNotAllocate)
+{
+    AggregationShard shard(1000);
+    Record record;
+    record.type_id = 0x67;
+    record.value_count = 1;
+    std::uint32_t devices = 0;
+    while (!detail::exceeds_load(shard.size(), detail::capacity_for(0)))
+    {
+        shard.add(devices++, 0, record);
+    }
+
+    // The next new key grows the table; folding into existing keys must not
+    const AllocationScope scope;
+    for (int i = 0; i < kIterations; ++i)
+    {
+        for (std::uint32_t device = 0; device < devices; ++device)
+        {
+            record.raw[0] = i;
+            shard.add(device, 1, record);
+        }
+    }
+    EXPECT_EQ(scope.allocations(), 0U);
+    EXPECT_EQ(shard.size(), devices);
+}
+
+TEST_P(AllocationTest, ErrorPathsDoNotAllocate)
+{
+    auto truncated = GetParam().payload;
+    truncated.pop_back();
+    std::array<Record, 8> records{};
+    std::array<char, 512> buffer{};
+    ASSERT_FALSE(decoder_.decode_records(truncated, records));
+
+    const AllocationScope scope;
+    for (int i = 0; i < kIterations; ++i)
+    {
+        EXPECT_FALSE(decoder_.validate(truncated));
+        EXPECT_FALSE(decoder_.decode_records(truncated, records));
+        EXPECT_FALSE(decoder_.write_json(truncated, buffer));
+    }
+    EXPECT_EQ(scope.allocations(), 0U);
+}
+
+INSTANTIATE_TEST_SUITE_P(StandardTypes, AllocationTest, ::testing::ValuesIn(standard_payloads()),
+                         [](const ::testing::TestParamInfo<PayloadCase>& param_info)
+                         { return param_info.param.name; });
+
+}  // namespace cayene::test
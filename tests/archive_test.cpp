@@ -0,0 +1,115 @@
+/**
+ * @file archive_test.cpp
+ * @brief Unit tests for the uplink archive format
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cayene/archive.hpp"
+
+namespace cayene::test
+{
+
+namespace
+{
+
+struct Entry
+{
+    std::uint32_t device;
+    std::uint64_t timestamp;
+    std::vector<std::uint8_t> payload;
+
+    bool operator==(const Entry&) const = default;
+};
+
+std::vector<Entry> parse_in_chunks(std::span<const std::uint8_t> archive, std::size_t chunk,
+                                   bool& complete)
+{
+    std::vector<Entry> entries;
+    ArchiveParser parser;
+    for (std::size_t offset = 0; offset < archive.size(); offset += chunk)
+    {
+        const std::size_t size = std::min(chunk, archive.size() - offset);
+        const bool ok = parser.feed(archive.subspan(offset, size),
+                                    [&entries](const PayloadRef& ref)
+                                    {
+                                        entries.push_back(
+                                            {ref.device,
+                                             ref.timestamp,
+                                             {ref.payload.begin(), ref.payload.end()}});
+                                    });
+        EXPECT_TRUE(ok);
+    }
+    EXPECT_EQ(parser.entries(), entries.size());
+    complete = parser.finish();
+    return entries;
+}
+
+}  // namespace
+
+TEST(ArchiveTest, EntryHeaderIsLittleEndian)
+{
+    const auto header = encode_archive_entry_header(0x01020304, 0x1122334455667788ULL, 0x0A0B);
+    const std::array<std::uint8_t, kArchiveEntryHeaderSize> expected = {
+        0x04, 0x03, 0x02, 0x01, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x0B, 0x0A};
+    EXPECT_EQ(header, expected);
+}
+
+TEST(ArchiveTest, RoundTripsAcrossEveryChunkSize)
+{
+    std::vector<Entry> written;
+    std::vector<std::uint8_t> archive;
+    for (std::uint32_t i = 0; i < 40; ++i)
+    {
+        std::vector<std::uint8_t> payload(i % 7, static_cast<std::uint8_t>(i));
+        written.push_back({i * 1000, 1'700'000'000'000ULL + i, payload});
+        ASSERT_TRUE(append_archive_entry(archive, i * 1000, 1'700'000'000'000ULL + i, payload));
+    }
+
+    for (std::size_t chunk = 1; chunk <= archive.size(); ++chunk)
+    {
+        bool complete = false;
+        EXPECT_EQ(parse_in_chunks(archive, chunk, complete), written) << "chunk " << chunk;
+        EXPECT_TRUE(complete);
+    }
+}
+
+TEST(ArchiveTest, ReportsTruncationAndBadMagic)
+{
+    std::vector<std::uint8_t> archive;
+    const std::vector<std::uint8_t> payload = {0x01, 0x67, 0x01, 0x10};
+    append_archive_entry(archive, 1, 2, payload);
+
+    bool complete = true;
+    const auto entries =
+        parse_in_chunks(std::span(archive).first(archive.size() - 1), 5, complete);
+    EXPECT_TRUE(entries.empty());
+    EXPECT_FALSE(complete);
+
+    ArchiveParser empty;
+    EXPECT_FALSE(empty.finish());
+
+    archive[0] = 'X';
+    ArchiveParser parser;
+    EXPECT_FALSE(parser.feed(archive, [](const PayloadRef&) { FAIL(); }));
+    EXPECT_FALSE(parser.feed(archive, [](const PayloadRef&) { FAIL(); }));
+    EXPECT_FALSE(parser.finish());
+}
+
+TEST(ArchiveTest, RejectsOversizedPayload)
+{
+    std::vector<std::uint8_t> archive;
+    const std::vector<std::uint8_t> payload(70'000, 0);
+    EXPECT_FALSE(append_archive_entry(archive, 1, 2, payload));
+    EXPECT_TRUE(archive.empty());
+}
+
+}  // namespace cayene::test
@@ -0,0 +1,310 @@
+/**
+ * @file async_test.cpp
+ * @brief Unit tests for the coroutine decode and sink interface
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cayene/async.hpp"
+
+namespace cayene::test
+{
+
+namespace
+{
+
+// Minimal reactor: a queue of coroutines resumed on the thread calling run()
+class EventLoop
+{
+public:
+    void post(std::coroutine_handle<> handle)
+    {
+        {
+            const std::lock_guard lock(mutex_);
+            ready_.push_back(handle);
+        }
+        wakeup_.notify_one();
+    }
+
+    // Resume posted coroutines until the given one-shot flag is set
+    void run_until(const bool& finished)
+    {
+        thread_ = std::this_thread::get_id();
+        while (!finished)
+        {
+            std::coroutine_handle<> handle;
+            {
+                std::unique_lock lock(mutex_);
+                wakeup_.wait(lock, [this]() { return !ready_.empty(); });
+                handle = ready_.front();
+                ready_.pop_front();
+            }
+            handle.resume();
+        }
+    }
+
+    // Awaitable that reschedules the current coroutine through the loop
+    auto yield()
+    {
+        struct Awaiter
+        {
+            EventLoop& loop;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) const { loop.post(handle); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+
+    [[nodiscard]] std::thread::id thread() const noexcept { return thread_; }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::deque<std::coroutine_handle<>> ready_;
+    std::thread::id thread_;
+};
+
+// Starts a task on the loop and records its completion
+template <typename Body>
+void spawn(EventLoop& loop, bool& finished, Body body)
+{
+    struct Detached
+    {
+        struct promise_type
+        {
+            Detached get_return_object() noexcept { return {}; }
+            std::suspend_never initial_suspend() const noexcept { return {}; }
+            std::suspend_never final_suspend() const noexcept { return {}; }
+            void return_void() const noexcept {}
+            void unhandled_exception() const noexcept { std::terminate(); }
+        };
+    };
+    [](EventLoop& on, bool& flag, Body task) -> Detached
+    {
+        co_await on.yield();
+        co_await task();
+        flag = true;
+    }(loop, finished, std::move(body));
+}
+
+class RecordingSink final : public AsyncSink
+{
+public:
+    explicit RecordingSink(EventLoop& loop) : loop_(loop) {}
+
+    Task<> consume(const DecodedBatch& batch) override
+    {
+        // Suspends like a network write would, then looks at the batch again
+        co_await loop_.yield();
+        on_loop_thread = std::this_thread::get_id() == loop_.thread();
+        batches.push_back(batch.size());
+        records += batch.record_count();
+    }
+
+    std::vector<std::size_t> batches;
+    std::size_t records{0};
+    bool on_loop_thread{false};
+
+private:
+    EventLoop& loop_;
+};
+
+}  // namespace
+
+class AsyncTest : public ::testing::Test
+{
+protected:
+    Decoder decoder_;
+
+    const std::vector<std::uint8_t> payload_ = {
+        0x01, 0x67, 0x01, 0x10,  // Temperature 27.2
+        0x02, 0x68, 0x02, 0x58   // Humidity 60.0
+    };
+    const std::vector<std::uint8_t> truncated_ = {0x01, 0x67, 0x01};
+
+    std::vector<PayloadRef> batch() const
+    {
+        return {{1, 100, payload_}, {2, 200, truncated_}, {3, 300, payload_}};
+    }
+};
+
+TEST_F(AsyncTest, DecodesOffTheLoopAndResumesOnIt)
+{
+    EventLoop loop;
+    AsyncDecoder async(decoder_, 2, [&loop](std::coroutine_handle<> handle) { loop.post(handle); });
+    ASSERT_EQ(async.thread_count(), 2U);
+
+    const std::vector<PayloadRef> payloads = batch();
+    bool finished = false;
+    bool resumed_on_loop = false;
+    std::size_t records = 0;
+    std::size_t failures = 0;
+    spawn(loop, finished,
+          [&]() -> Task<>
+          {
+              const DecodedBatch decoded = co_await async.decode_async(payloads);
+              resumed_on_loop = std::this_thread::get_id() == loop.thread();
+              records = decoded.record_count();
+              failures = decoded.failures();
+
+              EXPECT_EQ(decoded.size(), 3U);
+              EXPECT_EQ(decoded[0].device, 1U);
+              EXPECT_EQ(decoded[0].records.size(), 2U);
+              EXPECT_DOUBLE_EQ(decoded[0].records[0].value(), 27.2);
+              EXPECT_EQ(decoded[1].status.code, ErrorCode::BadPayloadFormat);
+              EXPECT_EQ(decoded[2].timestamp, 300U);
+              EXPECT_DOUBLE_EQ(decoded[2].records[1].value(), 60.0);
+          });
+    loop.run_until(finished);
+
+    EXPECT_TRUE(resumed_on_loop);
+    EXPECT_EQ(records, 4U);
+    EXPECT_EQ(failures, 1U);
+}
+
+TEST_F(AsyncTest, DecodeToAwaitsTheSink)
+{
+    EventLoop loop;
+    AsyncDecoder async(decoder_, 1, [&loop](std::coroutine_handle<> handle) { loop.post(handle); });
+    RecordingSink sink(loop);
+
+    const std::vector<PayloadRef> payloads = batch();
+    bool finished = false;
+    std::size_t failures = 0;
+    constexpr auto temperatures = RecordFilter::types({0x67});
+    spawn(loop, finished,
+          [&]() -> Task<>
+          {
+              failures = co_await async.decode_to(payloads, sink);
+              failures +=
+                  co_await async.decode_to(std::span(payloads).first(1), sink, temperatures);
+          });
+    loop.run_until(finished);
+
+    EXPECT_EQ(failures, 1U);
+    EXPECT_EQ(sink.batches, (std::vector<std::size_t>{3, 1}));
+    EXPECT_EQ(sink.records, 5U);
+    EXPECT_TRUE(sink.on_loop_thread);
+}
+
+TEST_F(AsyncTest, SyncWaitWithoutScheduler)
+{
+    AsyncDecoder async(decoder_);
+    const std::vector<PayloadRef> payloads = batch();
+
+    auto decode = [&]() -> Task<std::size_t>
+    {
+        const DecodedBatch decoded = co_await async.decode_async(payloads);
+        co_return decoded.record_count();
+    };
+    EXPECT_EQ(sync_wait(decode()), 4U);
+
+    // An empty batch completes without suspending
+    auto empty = [&]() -> Task<std::size_t>
+    { co_return (co_await async.decode_async(std::span<const PayloadRef>{})).size(); };
+    EXPECT_EQ(sync_wait(empty()), 0U);
+}
+
+TEST_F(AsyncTest, PinnedDecodeThreads)
+{
+    AsyncDecoder async(decoder_, 2, {}, CpuPlacement::Core);
+    const std::vector<PayloadRef> payloads = batch();
+
+    auto decode = [&]() -> Task<std::size_t>
+    {
+        const DecodedBatch decoded = co_await async.decode_async(payloads);
+        co_return decoded.record_count();
+    };
+    EXPECT_EQ(sync_wait(decode()), 4U);
+#if defined(__linux__)
+    EXPECT_EQ(async.unpinned_count(), 0U);
+#endif
+}
+
+TEST_F(AsyncTest, ManyConcurrentBatches)
+{
+    AsyncDecoder async(decoder_, 4);
+    const std::vector<PayloadRef> payloads = batch();
+
+    std::vector<std::thread> callers;
+    std::vector<std::size_t> records(8, 0);
+    for (std::size_t i = 0; i < records.size(); ++i)
+    {
+        callers.emplace_back(
+            [&, i]()
+            {
+                for (int n = 0; n < 100; ++n)
+                {
+                    auto decode = [&]() -> Task<std::size_t>
+                    { co_return (co_await async.decode_async(payloads)).record_count(); };
+                    records[i] += sync_wait(decode());
+                }
+            });
+    }
+    for (std::thread& caller : callers)
+    {
+        caller.join();
+    }
+    for (const std::size_t count : records)
+    {
+        EXPECT_EQ(count, 400U);
+    }
+}
+
+#ifndef CAYENE_NO_EXCEPTIONS
+TEST_F(AsyncTest, ExceptionsReachTheAwaiter)
+{
+    auto failing = []() -> Task<int>
+    {
+        throw std::runtime_error("sink unavailable");
+        co_return 0;
+    };
+    auto outer = [&]() -> Task<>
+    {
+        EXPECT_THROW(co_await failing(), std::runtime_error);
+        co_return;
+    };
+    sync_wait(outer());
+    EXPECT_THROW(sync_wait(failing()), std::runtime_error);
+}
+
+TEST_F(AsyncTest, SchedulerFailureReachesTheAwaiter)
+{
+    AsyncDecoder async(decoder_, 1,
+                       [](std::coroutine_handle<>) { throw std::runtime_error("loop closed"); });
+    const std::vector<PayloadRef> payloads = batch();
+    auto decode = [&]() -> Task<std::size_t>
+    {
+        const DecodedBatch decoded = co_await async.decode_async(payloads);
+        co_return decoded.size();
+    };
+    EXPECT_THROW(sync_wait(decode()), std::runtime_error);
+
+    // The decode thread survives and keeps serving batches
+    AsyncDecoder plain(decoder_, 1);
+    auto decode_plain = [&]() -> Task<std::size_t>
+    {
+        const DecodedBatch decoded = co_await plain.decode_async(payloads);
+        co_return decoded.size();
+    };
+    EXPECT_EQ(sync_wait(decode_plain()), 3U);
+    EXPECT_THROW(sync_wait(decode()), std::runtime_error);
+}
+#endif
+
+}  // namespace cayene::test
@@ -0,0 +1,243 @@
+/**
+ * @file c_api_test.cpp
+ * @brief Unit tests for the C ABI
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cayene/c_api.h"
+#include "cayene/decoder.hpp"
+
+namespace cayene::test
+{
+
+class CApiTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        decoder_ = cayene_decoder_new();
+        ASSERT_NE(decoder_, nullptr);
+    }
+
+    void TearDown() override
+    {
+        cayene_decoder_free(decoder_);
+    }
+
+    cayene_decoder* decoder_ = nullptr;
+};
+
+// Three payloads back to back: two records, a bad one, one record
+const std::vector<std::uint8_t> kBatchData = {
+    0x01, 0x67, 0x01, 0x10,  // Temperature 27.2
+    0x02, 0x68, 0x02, 0x58,  // Humidity 60.0
+    0x03, 0xFF, 0x00,        // Unknown type
+    0x04, 0x73, 0x27, 0x1F   // Barometer 1001.5
+};
+const std::array<std::size_t, 4> kBatchOffsets = {0, 8, 11, 15};
+
+TEST_F(CApiTest, DecodeRecords)
+{
+    std::vector<std::uint8_t> payload = {0x03, 0x71, 0x04, 0xD2, 0xFB, 0x2E, 0x00, 0x00};
+    std::array<cayene_record, 4> records{};
+
+    cayene_result result =
+        cayene_decode_records(decoder_, payload.data(), payload.size(), records.data(), 4);
+    ASSERT_EQ(result.status, CAYENE_OK);
+    ASSERT_EQ(result.count, 1U);
+    EXPECT_EQ(records[0].channel, 3);
+    EXPECT_EQ(records[0].type_id, 0x71);
+    EXPECT_EQ(records[0].value_count, 3);
+    EXPECT_EQ(records[0].data_offset, 2U);
+    EXPECT_EQ(records[0].data_size, 6U);
+    EXPECT_EQ(records[0].raw[0], 1234);
+    EXPECT_DOUBLE_EQ(records[0].value[0], 1.234);
+    EXPECT_DOUBLE_EQ(records[0].value[1], -1.234);
+    EXPECT_DOUBLE_EQ(records[0].value[2], 0.0);
+}
+
+TEST_F(CApiTest, DecodeRecordsBufferTooSmall)
+{
+    std::span<const std::uint8_t> payload(kBatchData.data(), kBatchOffsets[1]);
+    std::array<cayene_record, 1> records{};
+
+    cayene_result result =
+        cayene_decode_records(decoder_, payload.data(), payload.size(), records.data(), 1);
+    EXPECT_EQ(result.status, CAYENE_BUFFER_TOO_SMALL);
+    EXPECT_EQ(result.count, 1U);
+    EXPECT_EQ(records[0].type_id, 0x67);
+}
+
+TEST_F(CApiTest, ErrorsMatchDecoder)
+{
+    const std::uint8_t truncated[] = {0x01, 0x88, 0x06, 0x19};
+    cayene_result result = cayene_validate(decoder_, truncated, sizeof(truncated));
+    EXPECT_EQ(result.status, CAYENE_BAD_PAYLOAD_FORMAT);
+    EXPECT_EQ(result.type_id, 0x88);
+    EXPECT_EQ(result.offset, 0U);
+
+    EXPECT_EQ(cayene_validate(decoder_, nullptr, 0).status, CAYENE_PAYLOAD_EMPTY);
+    EXPECT_STREQ(cayene_status_message(CAYENE_PAYLOAD_EMPTY), "Payload is empty");
+}
+
+TEST_F(CApiTest, InvalidArguments)
+{
+    const std::uint8_t payload[] = {0x01, 0x00, 0x01};
+    EXPECT_EQ(cayene_validate(nullptr, payload, sizeof(payload)).status, CAYENE_INVALID_ARGUMENT);
+    EXPECT_EQ(cayene_validate(decoder_, nullptr, 3).status, CAYENE_INVALID_ARGUMENT);
+    EXPECT_EQ(cayene_decode_records(decoder_, payload, sizeof(payload), nullptr, 4).status,
+              CAYENE_INVALID_ARGUMENT);
+    EXPECT_EQ(cayene_decode_json_batch(decoder_, payload, nullptr, 1, nullptr, 0, nullptr,
+                                       nullptr)
+                  .status,
+              CAYENE_INVALID_ARGUMENT);
+}
+
+TEST_F(CApiTest, DecodeJsonMatchesDecoder)
+{
+    std::span<const std::uint8_t> payload(kBatchData.data(), kBatchOffsets[1]);
+    std::array<char, 128> text{};
+
+    cayene_result result =
+        cayene_decode_json(decoder_, payload.data(), payload.size(), text.data(), text.size());
+    ASSERT_EQ(result.status, CAYENE_OK);
+
+    Decoder reference;
+    Json expected;
+    ASSERT_TRUE(reference.try_decode(payload, expected).ok());
+    EXPECT_EQ(Json::parse(std::string_view(text.data(), result.count)), expected);
+}
+
+TEST_F(CApiTest, RecordsBatch)
+{
+    std::array<cayene_record, 8> records{};
+    std::array<std::size_t, 4> record_offsets{};
+    std::array<cayene_status, 3> statuses{};
+
+    cayene_batch_result batch = cayene_decode_records_batch(
+        decoder_, kBatchData.data(), kBatchOffsets.data(), 3, records.data(), records.size(),
+        record_offsets.data(), statuses.data());
+    EXPECT_EQ(batch.status, CAYENE_OK);
+    EXPECT_EQ(batch.payloads, 3U);
+    EXPECT_EQ(batch.produced, 3U);
+    EXPECT_EQ(batch.failed, 1U);
+
+    EXPECT_EQ(statuses[0], CAYENE_OK);
+    EXPECT_EQ(statuses[1], CAYENE_UNKNOWN_DATA_TYPE);
+    EXPECT_EQ(statuses[2], CAYENE_OK);
+    EXPECT_EQ(record_offsets, (std::array<std::size_t, 4>{0, 2, 2, 3}));
+
+    // Data offsets point into the whole batch buffer
+    EXPECT_EQ(records[2].type_id, 0x73);
+    EXPECT_EQ(records[2].data_offset, 13U);
+    EXPECT_DOUBLE_EQ(records[2].value[0], 1001.5);
+}
+
+TEST_F(CApiTest, RecordsBatchResumesAfterBufferTooSmall)
+{
+    std::array<cayene_record, 2> records{};
+
+    cayene_batch_result batch = cayene_decode_records_batch(
+        decoder_, kBatchData.data(), kBatchOffsets.data(), 3, records.data(), records.size(),
+        nullptr, nullptr);
+    EXPECT_EQ(batch.status, CAYENE_BUFFER_TOO_SMALL);
+    EXPECT_EQ(batch.payloads, 2U);
+    EXPECT_EQ(batch.produced, 2U);
+
+    batch = cayene_decode_records_batch(decoder_, kBatchData.data(),
+                                        kBatchOffsets.data() + batch.payloads, 1, records.data(),
+                                        records.size(), nullptr, nullptr);
+    EXPECT_EQ(batch.status, CAYENE_OK);
+    EXPECT_EQ(batch.produced, 1U);
+    EXPECT_EQ(records[0].type_id, 0x73);
+}
+
+TEST_F(CApiTest, JsonBatchIsNewlineDelimited)
+{
+    std::array<char, 256> text{};
+    std::array<std::size_t, 4> text_offsets{};
+
+    cayene_batch_result batch =
+        cayene_decode_json_batch(decoder_, kBatchData.data(), kBatchOffsets.data(), 3, text.data(),
+                                 text.size(), text_offsets.data(), nullptr);
+    EXPECT_EQ(batch.status, CAYENE_OK);
+    EXPECT_EQ(batch.failed, 1U);
+    EXPECT_EQ(text_offsets[1], text_offsets[2]);
+    EXPECT_EQ(text_offsets[3], batch.produced);
+
+    std::string_view output(text.data(), batch.produced);
+    EXPECT_EQ(output, R"({"Temperature_1":27.2,"Humidity_2":60.0})"
+                      "\n"
+                      R"({"Barometer_4":1001.5})"
+                      "\n");
+}
+
+TEST_F(CApiTest, JsonBatchBufferTooSmall)
+{
+    std::array<char, 16> text{};
+    cayene_batch_result batch =
+        cayene_decode_json_batch(decoder_, kBatchData.data(), kBatchOffsets.data(), 3, text.data(),
+                                 text.size(), nullptr, nullptr);
+    EXPECT_EQ(batch.status, CAYENE_BUFFER_TOO_SMALL);
+    EXPECT_EQ(batch.payloads, 0U);
+    EXPECT_EQ(batch.produced, 0U);
+}
+
+std::size_t write_custom_value(void* user_data, const std::uint8_t* data, std::size_t size,
+                               char* json_out, std::size_t json_capacity)
+{
+    const std::string text =
+        std::string(*static_cast<const std::size_t*>(user_data), ' ') + std::to_string(data[0]);
+    static_cast<void>(size);
+    if (text.size() <= json_capacity)
+    {
+        std::memcpy(json_out, text.data(), text.size());
+    }
+    return text.size();
+}
+
+TEST_F(CApiTest, CustomTypeCallback)
+{
+    // Padding beyond the first buffer forces the callback to be retried
+    std::size_t padding = 300;
+    ASSERT_EQ(cayene_decoder_add_custom_type(decoder_, 200, "Custom", 1, write_custom_value,
+                                             &padding),
+              CAYENE_OK);
+    EXPECT_EQ(cayene_decoder_has_type(decoder_, 200), 1);
+    EXPECT_EQ(cayene_decoder_add_custom_type(decoder_, 200, "Custom", 1, write_custom_value,
+                                             &padding),
+              CAYENE_INVALID_ARGUMENT);
+
+    const std::uint8_t payload[] = {0x05, 200, 42};
+    std::array<char, 64> text{};
+    cayene_result result =
+        cayene_decode_json(decoder_, payload, sizeof(payload), text.data(), text.size());
+    ASSERT_EQ(result.status, CAYENE_OK);
+    EXPECT_EQ(std::string_view(text.data(), result.count), R"({"Custom_5":42})");
+
+    // Records expose custom types by their bytes only
+    cayene_record record{};
+    result = cayene_decode_records(decoder_, payload, sizeof(payload), &record, 1);
+    ASSERT_EQ(result.status, CAYENE_OK);
+    EXPECT_EQ(record.value_count, 0);
+    EXPECT_EQ(record.data_offset, 2U);
+    EXPECT_EQ(record.data_size, 1U);
+
+    EXPECT_EQ(cayene_decoder_remove_custom_type(decoder_, 200), 1);
+    EXPECT_EQ(cayene_decoder_remove_custom_type(decoder_, 0x67), 0);
+}
+
+}  // namespace cayene::test
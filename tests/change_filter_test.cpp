@@ -0,0 +1,195 @@
+/**
+ * @file change_filter_test.cpp
+ * @brief Unit tests for report-on-change suppression
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cayene/change_filter.hpp"
+
+namespace cayene::test
+{
+
+class ChangeFilterTest : public ::testing::Test
+{
+protected:
+    Decoder decoder_;
+    ChangeFilter changes_;
+
+    std::vector<std::uint8_t> reported(std::uint32_t device, std::span<const std::uint8_t> payload)
+    {
+        std::vector<std::uint8_t> types;
+        const auto status = changes_.visit_changes(decoder_, device, payload,
+                                                   [&types](const Record& record)
+                                                   { types.push_back(record.type_id); });
+        EXPECT_TRUE(status.ok());
+        return types;
+    }
+
+    static Record temperature(std::uint8_t channel, std::int32_t raw)
+    {
+        Record record;
+        record.channel = channel;
+        record.type_id = 0x67;
+        record.value_count = 1;
+        record.raw[0] = raw;
+        return record;
+    }
+};
+
+TEST_F(ChangeFilterTest, SuppressesRepeats)
+{
+    const std::vector<std::uint8_t> payload = {
+        0x01, 0x67, 0x01, 0x10,  // Temperature 27.2
+        0x02, 0x68, 0x02, 0x58   // Humidity 60.0
+    };
+
+    EXPECT_EQ(reported(7, payload), (std::vector<std::uint8_t>{0x67, 0x68}));
+    EXPECT_TRUE(reported(7, payload).empty());
+    EXPECT_EQ(changes_.size(), 2U);
+    EXPECT_EQ(changes_.stats().emitted, 2U);
+    EXPECT_EQ(changes_.stats().suppressed, 2U);
+
+    std::vector<std::uint8_t> changed = payload;
+    changed[7] = 0x5A;
+    EXPECT_EQ(reported(7, changed), std::vector<std::uint8_t>{0x68});
+}
+
+TEST_F(ChangeFilterTest, KeysIncludeDeviceChannelAndType)
+{
+    EXPECT_TRUE(changes_.update(0, temperature(0, 0)));
+    EXPECT_FALSE(changes_.update(0, temperature(0, 0)));
+    EXPECT_TRUE(changes_.update(1, temperature(0, 0)));
+    EXPECT_TRUE(changes_.update(0, temperature(1, 0)));
+
+    Record humidity = temperature(0, 0);
+    humidity.type_id = 0x68;
+    EXPECT_TRUE(changes_.update(0, humidity));
+    EXPECT_EQ(changes_.size(), 4U);
+}
+
+TEST_F(ChangeFilterTest, DeadbandComparesAgainstLastReported)
+{
+    changes_.set_deadband(0x67, 5);
+    EXPECT_EQ(changes_.deadband(0x67), 5U);
+    EXPECT_EQ(changes_.deadband(0x68), 0U);
+
+    EXPECT_TRUE(changes_.update(1, temperature(1, 250)));
+    EXPECT_FALSE(changes_.update(1, temperature(1, 253)));
+    EXPECT_FALSE(changes_.update(1, temperature(1, 255)));
+    EXPECT_FALSE(changes_.update(1, temperature(1, 245)));
+    // Drift accumulates against 250, the last reported value
+    EXPECT_TRUE(changes_.update(1, temperature(1, 256)));
+    EXPECT_FALSE(changes_.update(1, temperature(1, 251)));
+    EXPECT_TRUE(changes_.update(1, temperature(1, 250)));
+}
+
+TEST_F(ChangeFilterTest, AnyComponentOfVectorTypes)
+{
+    changes_.set_deadband(2);
+    std::vector<std::uint8_t> payload = {0x04, 0x71, 0x04, 0xD2, 0xFB, 0x2E, 0x00, 0x00};
+    EXPECT_EQ(reported(3, payload).size(), 1U);
+
+    payload[7] = 0x02;  // z moves by 2: within the deadband
+    EXPECT_TRUE(reported(3, payload).empty());
+    payload[5] = 0x31;  // y moves by 3
+    EXPECT_EQ(reported(3, payload).size(), 1U);
+}
+
+TEST_F(ChangeFilterTest, ExtremeValuesDoNotOverflow)
+{
+    changes_.set_deadband(0xFFFFFFFFU);
+    Record gps;
+    gps.type_id = 0x88;
+    gps.value_count = 3;
+    gps.raw = {-8388608, 8388607, 0};
+    EXPECT_TRUE(changes_.update(1, gps));
+    gps.raw = {8388607, -8388608, 0};
+    EXPECT_FALSE(changes_.update(1, gps));
+
+    changes_.set_deadband(0);
+    EXPECT_TRUE(changes_.update(1, gps));
+}
+
+TEST_F(ChangeFilterTest, CustomTypesAreAlwaysReported)
+{
+    decoder_.add_custom_type(0xC0, "Custom", 1,
+                             [](std::span<const std::uint8_t> data) { return Json(data[0]); });
+    const std::vector<std::uint8_t> payload = {0x01, 0xC0, 0x2A};
+    EXPECT_EQ(reported(1, payload).size(), 1U);
+    EXPECT_EQ(reported(1, payload).size(), 1U);
+    EXPECT_EQ(changes_.size(), 0U);
+}
+
+TEST_F(ChangeFilterTest, GrowsAndClears)
+{
+    ChangeFilter changes(4);
+    const std::size_t initial = changes.capacity();
+    for (std::uint32_t device = 0; device < 1000; ++device)
+    {
+        EXPECT_TRUE(changes.update(device, temperature(1, 100)));
+    }
+    EXPECT_EQ(changes.size(), 1000U);
+    EXPECT_GT(changes.capacity(), initial);
+    for (std::uint32_t device = 0; device < 1000; ++device)
+    {
+        EXPECT_FALSE(changes.update(device, temperature(1, 100)));
+    }
+
+    const std::size_t capacity = changes.capacity();
+    changes.reserve(100);
+    EXPECT_EQ(changes.capacity(), capacity);
+
+    changes.clear();
+    EXPECT_EQ(changes.size(), 0U);
+    EXPECT_TRUE(changes.update(500, temperature(1, 100)));
+}
+
+TEST_F(ChangeFilterTest, UpdatesDoNotGrowAFullTable)
+{
+    ChangeFilter changes;
+    const std::size_t capacity = changes.capacity();
+    std::uint32_t device = 0;
+    while ((changes.size() + 1) * 4 <= capacity * 3)
+    {
+        EXPECT_TRUE(changes.update(device++, temperature(1, 100)));
+    }
+    for (std::uint32_t repeat = 0; repeat < device; ++repeat)
+    {
+        EXPECT_FALSE(changes.update(repeat, temperature(1, 100)));
+        EXPECT_TRUE(changes.update(repeat, temperature(1, 200)));
+    }
+    EXPECT_EQ(changes.capacity(), capacity);
+
+    EXPECT_TRUE(changes.update(device, temperature(1, 100)));
+    EXPECT_GT(changes.capacity(), capacity);
+}
+
+TEST_F(ChangeFilterTest, ErrorsAndProjection)
+{
+    const std::vector<std::uint8_t> payload = {0x01, 0x67, 0x01, 0x10, 0x02, 0x68, 0x02};
+    int calls = 0;
+    const auto status =
+        changes_.visit_changes(decoder_, 1, payload, [&calls](const Record&) { ++calls; });
+    EXPECT_EQ(status.code, ErrorCode::BadPayloadFormat);
+    EXPECT_EQ(calls, 1);
+
+    const std::vector<std::uint8_t> valid = {0x01, 0x67, 0x01, 0x11, 0x02, 0x68, 0x02, 0x58};
+    calls = 0;
+    ASSERT_TRUE(changes_
+                    .visit_changes(decoder_, 1, valid, RecordFilter::types({0x68}),
+                                   [&calls](const Record&) { ++calls; })
+                    .ok());
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(changes_.size(), 2U);
+}
+
+}  // namespace cayene::test
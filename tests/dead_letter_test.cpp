@@ -0,0 +1,229 @@
+/**
+ * @file dead_letter_test.cpp
+ * @brief Unit tests for the dead-letter queue and sink
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cayene/dead_letter.hpp"
+
+namespace cayene::test
+{
+
+class DeadLetterTest : public ::testing::Test
+{
+protected:
+    Decoder decoder_;
+
+    const std::vector<std::uint8_t> good_ = {0x01, 0x67, 0x01, 0x10};  // Temperature 27.2
+    const std::vector<std::uint8_t> unknown_ = {0x01, 0x67, 0x01, 0x10, 0x02, 0xAB, 0x00};
+    const std::vector<std::uint8_t> truncated_ = {0x01, 0x67, 0x01};
+
+    DecodeStatus status_of(const std::vector<std::uint8_t>& payload) const
+    {
+        std::vector<Record> records(8);
+        return decoder_.decode_records(payload, records);
+    }
+
+    static std::vector<DeadLetterRecord> read_back(const std::string& file,
+                                                   std::vector<std::vector<std::uint8_t>>& bytes)
+    {
+        std::vector<DeadLetterRecord> records;
+        const auto* data = reinterpret_cast<const std::uint8_t*>(file.data());
+        const bool ok = read_dead_letters(std::span(data, file.size()),
+                                          [&](const DeadLetterRecord& record)
+                                          {
+                                              records.push_back(record);
+                                              bytes.emplace_back(record.payload.begin(),
+                                                                 record.payload.end());
+                                          });
+        EXPECT_TRUE(ok);
+        return records;
+    }
+};
+
+TEST_F(DeadLetterTest, CapturesFailuresWithTheirLocation)
+{
+    std::ostringstream file;
+    {
+        DeadLetterQueue queue(file);
+        EXPECT_FALSE(queue.offer(0, 1, 10, good_, status_of(good_)));
+        EXPECT_TRUE(queue.offer(0, 2, 20, unknown_, status_of(unknown_)));
+        EXPECT_TRUE(queue.offer(0, 3, 30, truncated_, status_of(truncated_)));
+        EXPECT_FALSE(queue.offer(1, 4, 40, truncated_, status_of(truncated_)));  // No thread 1
+
+        queue.flush();
+        const DeadLetterStats stats = queue.stats();
+        EXPECT_EQ(stats.failures, 2U);
+        EXPECT_EQ(stats.dropped, 1U);
+        EXPECT_EQ(stats.written, 2U);
+        EXPECT_EQ(stats.write_errors, 0U);
+    }
+
+    std::vector<std::vector<std::uint8_t>> bytes;
+    const std::vector<DeadLetterRecord> records = read_back(file.str(), bytes);
+    ASSERT_EQ(records.size(), 2U);
+    EXPECT_EQ(records[0].device, 2U);
+    EXPECT_EQ(records[0].timestamp, 20U);
+    EXPECT_EQ(records[0].code, ErrorCode::UnknownDataType);
+    EXPECT_EQ(records[0].offset, 4U);
+    EXPECT_EQ(records[0].type_id, 0xAB);
+    EXPECT_EQ(records[0].payload_size, unknown_.size());
+    EXPECT_EQ(bytes[0], unknown_);
+    EXPECT_EQ(records[1].device, 3U);
+    EXPECT_EQ(records[1].code, ErrorCode::BadPayloadFormat);
+    EXPECT_EQ(records[1].offset, 0U);
+    EXPECT_EQ(bytes[1], truncated_);
+}
+
+TEST_F(DeadLetterTest, SamplesAndRateLimits)
+{
+    std::ostringstream file;
+    DeadLetterConfig config;
+    config.threads = 2;
+    config.sample_every = 3;
+    DeadLetterQueue sampled(file, config);
+    const DecodeStatus status = status_of(truncated_);
+    std::size_t kept = 0;
+    for (std::uint32_t i = 0; i < 9; ++i)
+    {
+        kept += sampled.offer(i % 2, i, i, truncated_, status) ? 1U : 0U;
+    }
+    // Sampling is per thread: of 5 and 4 failures, threads 0 and 1 each keep the 1st and 4th
+    EXPECT_EQ(kept, 4U);
+    EXPECT_EQ(sampled.stats().sampled_out, 5U);
+
+    std::ostringstream limited_file;
+    DeadLetterConfig limits;
+    limits.max_per_second = 2;
+    DeadLetterQueue limited(limited_file, limits);
+    kept = 0;
+    for (std::uint32_t i = 0; i < 5; ++i)
+    {
+        kept += limited.offer(0, i, i, truncated_, status) ? 1U : 0U;
+    }
+    EXPECT_EQ(kept, 2U);
+    EXPECT_EQ(limited.stats().rate_limited, 3U);
+}
+
+TEST_F(DeadLetterTest, FullRingDropsInsteadOfBlocking)
+{
+    std::ostringstream file;
+    DeadLetterConfig config;
+    config.ring_capacity = 2;
+    config.flush_interval = std::chrono::hours(1);  // Only flush() drains
+    DeadLetterQueue queue(file, config);
+    const DecodeStatus status = status_of(unknown_);
+
+    std::size_t kept = 0;
+    for (std::uint32_t i = 0; i < 5; ++i)
+    {
+        kept += queue.offer(0, i, i, unknown_, status) ? 1U : 0U;
+    }
+    EXPECT_EQ(kept, 2U);
+    EXPECT_EQ(queue.stats().dropped, 3U);
+
+    queue.flush();
+    EXPECT_EQ(queue.stats().written, 2U);
+    EXPECT_TRUE(queue.offer(0, 9, 9, unknown_, status));
+}
+
+TEST_F(DeadLetterTest, FailedWriteStopsTheFile)
+{
+    std::ostringstream file;
+    DeadLetterConfig config;
+    config.flush_interval = std::chrono::hours(1);  // Only flush() drains
+    DeadLetterQueue queue(file, config);
+    const DecodeStatus status = status_of(unknown_);
+
+    ASSERT_TRUE(queue.offer(0, 1, 1, unknown_, status));
+    ASSERT_TRUE(queue.offer(0, 2, 2, unknown_, status));
+    file.setstate(std::ios::badbit);
+    queue.flush();
+    DeadLetterStats stats = queue.stats();
+    EXPECT_EQ(stats.written, 0U);
+    EXPECT_EQ(stats.dropped, 2U);
+    EXPECT_EQ(stats.write_errors, 1U);
+
+    // Nothing is appended after a failure, even once the stream looks usable again
+    file.clear();
+    ASSERT_TRUE(queue.offer(0, 3, 3, unknown_, status));
+    queue.flush();
+    stats = queue.stats();
+    EXPECT_EQ(stats.written, 0U);
+    EXPECT_EQ(stats.dropped, 3U);
+    EXPECT_EQ(stats.write_errors, 1U);
+    EXPECT_EQ(file.str().size(), kDeadLetterMagic.size());
+}
+
+TEST_F(DeadLetterTest, PipelineSinkCapturesFailedPayloads)
+{
+    std::ostringstream file;
+    CountingSink counting(2);
+    DeadLetterConfig config;
+    config.threads = 2;
+    config.ring_capacity = 1024;
+    DeadLetterQueue queue(file, config);
+    DeadLetterSink sink(counting, queue);
+
+    PipelineConfig pipeline_config;
+    pipeline_config.workers = 2;
+    Pipeline pipeline(decoder_, sink, pipeline_config);
+    pipeline.start();
+    for (std::uint32_t device = 0; device < 300; ++device)
+    {
+        pipeline.producer(0).submit(device, device, device % 3 == 0 ? truncated_ : good_);
+    }
+    pipeline.stop();
+    queue.flush();
+
+    EXPECT_EQ(counting.payloads(), 300U);
+    EXPECT_EQ(counting.failures(), 100U);
+    EXPECT_EQ(queue.stats().written, 100U);
+
+    std::vector<std::vector<std::uint8_t>> bytes;
+    for (const DeadLetterRecord& record : read_back(file.str(), bytes))
+    {
+        EXPECT_EQ(record.device % 3, 0U);
+        EXPECT_EQ(record.code, ErrorCode::BadPayloadFormat);
+    }
+    EXPECT_EQ(bytes.size(), 100U);
+}
+
+TEST_F(DeadLetterTest, ReadsAppendedRunsAndLongPayloads)
+{
+    std::ostringstream file;
+    const std::vector<std::uint8_t> long_payload(kMaxPipelinePayload + 44, 0xFF);
+    for (int run = 0; run < 2; ++run)
+    {
+        DeadLetterQueue queue(file);
+        queue.offer(0, 7, 0, long_payload, status_of(long_payload));
+    }
+
+    std::vector<std::vector<std::uint8_t>> bytes;
+    const std::vector<DeadLetterRecord> records = read_back(file.str(), bytes);
+    ASSERT_EQ(records.size(), 2U);
+    EXPECT_EQ(records[1].payload_size, long_payload.size());
+    EXPECT_EQ(bytes[1].size(), kMaxPipelinePayload);
+
+    // Not a dead-letter file, or cut short
+    const std::string text = file.str();
+    const auto* data = reinterpret_cast<const std::uint8_t*>(text.data());
+    auto ignore = [](const DeadLetterRecord&) {};
+    EXPECT_FALSE(read_dead_letters(std::span(data + 1, text.size() - 1), ignore));
+    EXPECT_FALSE(read_dead_letters(std::span(data, text.size() - 1), ignore));
+}
+
+}  // namespace cayene::test
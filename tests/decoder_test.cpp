@@ -18,8 +18,10 @@
 
 #include "cayene/decoder.hpp"
 
+#include <array>
 #include <cstdint>
 #include <limits>
+#include <string>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -737,6 +739,135 @@ TEST_F(DecoderTest, TwoBytePayload)
     EXPECT_THROW(decoder_.decode(payload), BadPayloadFormatException);
 }
 
+// ============================================================================
+// TYPED DECODE TESTS
+// ============================================================================
+
+TEST_F(DecoderTest, ValidateCountsRecords)
+{
+    std::vector<std::uint8_t> payload = {
+        0x01, 0x67, 0x01, 0x10,  // Temperature
+        0x02, 0x68, 0x02, 0x58   // Humidity
+    };
+    auto status = decoder_.validate(payload);
+    EXPECT_TRUE(status.ok());
+    EXPECT_EQ(status.count, 2U);
+    EXPECT_EQ(status.offset, payload.size());
+}
+
+TEST_F(DecoderTest, ValidateReportsErrors)
+{
+    EXPECT_EQ(decoder_.validate({}).code, ErrorCode::PayloadEmpty);
+
+    std::vector<std::uint8_t> unknown = {0x01, 0x67, 0x01, 0x10, 0x02, 0xFF, 0x00};
+    auto status = decoder_.validate(unknown);
+    EXPECT_EQ(status.code, ErrorCode::UnknownDataType);
+    EXPECT_EQ(status.offset, 4U);
+    EXPECT_EQ(status.type_id, 0xFF);
+
+    std::vector<std::uint8_t> truncated = {0x01, 0x88, 0x00, 0x00};
+    EXPECT_EQ(decoder_.validate(truncated).code, ErrorCode::BadPayloadFormat);
+
+    std::vector<std::uint8_t> trailing = {0x01, 0x67, 0x01, 0x10, 0xFF};
+    status = decoder_.validate(trailing);
+    EXPECT_EQ(status.code, ErrorCode::BadPayloadFormat);
+    EXPECT_EQ(status.offset, 4U);
+}
+
+TEST_F(DecoderTest, DecodeRecordsMatchesJson)
+{
+    std::vector<std::uint8_t> payload = {
+        0x01, 0x67, 0xFF, 0xF6,                                     // Temperature -1.0
+        0x02, 0x71, 0x01, 0xF4, 0xFF, 0xD8, 0x03, 0xE8,             // Accelerometer
+        0x03, 0x88, 0x06, 0x19, 0x48, 0xF9, 0xCC, 0xE6, 0x00, 0x09, 0xC4  // GPS
+    };
+    std::array<Record, 4> records{};
+    auto status = decoder_.decode_records(payload, records);
+    ASSERT_TRUE(status.ok());
+    ASSERT_EQ(status.count, 3U);
+
+    auto json = decoder_.decode(payload);
+    EXPECT_EQ(records[0].channel, 1);
+    EXPECT_EQ(records[0].type_id, 0x67);
+    EXPECT_EQ(records[0].raw[0], -10);
+    EXPECT_DOUBLE_EQ(records[0].value(), json["Temperature_1"].get<double>());
+    EXPECT_EQ(records[1].value_count, 3);
+    EXPECT_DOUBLE_EQ(records[1].value(1), json["Accelerometer_2"]["y"].get<double>());
+    EXPECT_DOUBLE_EQ(records[2].value(0), json["GPS_3"]["latitude"].get<double>());
+    EXPECT_DOUBLE_EQ(records[2].value(1), json["GPS_3"]["longitude"].get<double>());
+    EXPECT_DOUBLE_EQ(records[2].value(2), json["GPS_3"]["altitude"].get<double>());
+}
+
+TEST_F(DecoderTest, DecodeRecordsBufferTooSmall)
+{
+    std::vector<std::uint8_t> payload = {0x01, 0x67, 0x01, 0x10, 0x02, 0x68, 0x02, 0x58};
+    std::array<Record, 1> records{};
+    auto status = decoder_.decode_records(payload, records);
+    EXPECT_EQ(status.code, ErrorCode::BufferTooSmall);
+    EXPECT_EQ(status.count, 1U);
+    EXPECT_EQ(status.offset, 4U);
+}
+
+TEST_F(DecoderTest, VisitCustomTypeExposesBytes)
+{
+    auto battery_decoder = [](std::span<const std::uint8_t> data) -> Json
+    { return Json(data[0]); };
+    decoder_.add_custom_type(0xA0, "Battery", 2, battery_decoder);
+
+    std::vector<std::uint8_t> payload = {0x05, 0xA0, 0x0E, 0x74};
+    std::vector<Record> seen;
+    auto status =
+        decoder_.visit(payload, [&seen](const Record& record) { seen.push_back(record); });
+    ASSERT_TRUE(status.ok());
+    ASSERT_EQ(seen.size(), 1U);
+    EXPECT_EQ(seen[0].value_count, 0);
+    ASSERT_EQ(seen[0].data.size(), 2U);
+    EXPECT_EQ(seen[0].data[0], 0x0E);
+    EXPECT_EQ(seen[0].data[1], 0x74);
+}
+
+TEST_F(DecoderTest, WriteJsonMatchesDump)
+{
+    std::vector<std::uint8_t> payload = {
+        0x01, 0x00, 0x01,                                           // Digital Input
+        0x02, 0x65, 0x01, 0x90,                                     // Luminosity
+        0x03, 0x67, 0x01, 0x10,                                     // Temperature 27.2
+        0x04, 0x68, 0x02, 0x58,                                     // Humidity 60.0
+        0x05, 0x86, 0x01, 0xF4, 0xFF, 0xD8, 0x03, 0xE8,             // Gyrometer
+        0x06, 0x88, 0x06, 0x19, 0x48, 0xF9, 0xCC, 0xE6, 0x00, 0x09, 0xC4  // GPS
+    };
+    std::array<char, 512> buffer{};
+    auto status = decoder_.write_json(payload, buffer);
+    ASSERT_TRUE(status.ok());
+
+    const std::string text(buffer.data(), status.count);
+    EXPECT_EQ(Json::parse(text), decoder_.decode(payload));
+    EXPECT_EQ(text.rfind(R"({"Digital Input_1":1,"Luminosity_2":400,)", 0), 0U);
+    EXPECT_NE(text.find(R"("Humidity_4":60.0)"), std::string::npos);
+}
+
+TEST_F(DecoderTest, WriteJsonBufferTooSmall)
+{
+    std::vector<std::uint8_t> payload = {0x01, 0x67, 0x01, 0x10};
+    std::array<char, 8> buffer{};
+    auto status = decoder_.write_json(payload, buffer);
+    EXPECT_EQ(status.code, ErrorCode::BufferTooSmall);
+    EXPECT_EQ(status.count, 0U);
+}
+
+TEST_F(DecoderTest, WriteJsonCustomType)
+{
+    auto battery_decoder = [](std::span<const std::uint8_t> data) -> Json
+    { return Json{{"voltage", ((data[0] << 8) | data[1]) / 1000.0}}; };
+    decoder_.add_custom_type(0xA0, "Bat\"tery", 2, battery_decoder);
+
+    std::vector<std::uint8_t> payload = {0x01, 0xA0, 0x0E, 0x74};
+    std::array<char, 128> buffer{};
+    auto status = decoder_.write_json(payload, buffer);
+    ASSERT_TRUE(status.ok());
+    EXPECT_EQ(Json::parse(std::string(buffer.data(), status.count)), decoder_.decode(payload));
+}
+
 }  // namespace cayene::test
 
 int main(int argc, char** argv)
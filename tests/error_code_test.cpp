@@ -0,0 +1,264 @@
+/**
+ * @file error_code_test.cpp
+ * @brief Unit tests for the error-code decode API and its mapping to exceptions
+ *
+ * Also built when the library is configured with CAYENE_NO_EXCEPTIONS, in
+ * which case only the error-code tests are compiled.
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cayene/decoder.hpp"
+
+namespace cayene::test
+{
+
+class ErrorCodeTest : public ::testing::Test
+{
+protected:
+    Decoder decoder_;
+};
+
+TEST_F(ErrorCodeTest, TryDecodeSuccess)
+{
+    std::vector<std::uint8_t> payload = {
+        0x01, 0x67, 0x01, 0x10,  // Temperature 27.2
+        0x02, 0x68, 0x02, 0x58   // Humidity 60.0
+    };
+    Json result;
+    auto status = decoder_.try_decode(payload, result);
+    ASSERT_TRUE(status.ok());
+    EXPECT_EQ(status.count, 2U);
+    EXPECT_EQ(status.offset, payload.size());
+    EXPECT_DOUBLE_EQ(result["Temperature_1"], 27.2);
+    EXPECT_DOUBLE_EQ(result["Humidity_2"], 60.0);
+}
+
+TEST_F(ErrorCodeTest, TryDecodeEmpty)
+{
+    Json result;
+    EXPECT_EQ(decoder_.try_decode({}, result).code, ErrorCode::PayloadEmpty);
+    EXPECT_TRUE(result.empty());
+}
+
+TEST_F(ErrorCodeTest, TryDecodeUnknownType)
+{
+    std::vector<std::uint8_t> payload = {0x01, 0x67, 0x01, 0x10, 0x02, 0xFF, 0x00, 0x00};
+    Json result;
+    auto status = decoder_.try_decode(payload, result);
+    EXPECT_EQ(status.code, ErrorCode::UnknownDataType);
+    EXPECT_EQ(status.offset, 4U);
+    EXPECT_EQ(status.type_id, 0xFF);
+    EXPECT_EQ(status.count, 1U);
+
+    // Records before the error are kept
+    EXPECT_TRUE(result.contains("Temperature_1"));
+}
+
+TEST_F(ErrorCodeTest, TryDecodeTruncatedRecord)
+{
+    std::vector<std::uint8_t> payload = {0x01, 0x88, 0x06, 0x19};
+    Json result;
+    auto status = decoder_.try_decode(payload, result);
+    EXPECT_EQ(status.code, ErrorCode::BadPayloadFormat);
+    EXPECT_EQ(status.offset, 0U);
+    EXPECT_EQ(status.type_id, 0x88);
+}
+
+TEST_F(ErrorCodeTest, TryDecodeTrailingByte)
+{
+    std::vector<std::uint8_t> payload = {0x01, 0x67, 0x01, 0x10, 0xFF};
+    Json result;
+    auto status = decoder_.try_decode(payload, result);
+    EXPECT_EQ(status.code, ErrorCode::BadPayloadFormat);
+    EXPECT_EQ(status.offset, 4U);
+}
+
+TEST_F(ErrorCodeTest, TryDecodeAgreesWithValidate)
+{
+    const std::vector<std::vector<std::uint8_t>> payloads = {
+        {},
+        {0x01},
+        {0x01, 0x00},
+        {0x01, 0x00, 0x01},
+        {0x01, 0x42, 0x00},
+        {0x01, 0x71, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07},
+    };
+    for (const auto& payload : payloads)
+    {
+        Json result;
+        const auto decoded = decoder_.try_decode(payload, result);
+        const auto validated = decoder_.validate(payload);
+        EXPECT_EQ(decoded.code, validated.code);
+        EXPECT_EQ(decoded.offset, validated.offset);
+    }
+}
+
+TEST_F(ErrorCodeTest, ErrorMessages)
+{
+    EXPECT_STREQ(error_message(ErrorCode::Ok), "Ok");
+    EXPECT_STREQ(error_message(ErrorCode::PayloadEmpty), "Payload is empty");
+    EXPECT_STREQ(error_message(ErrorCode::BufferTooSmall), "Output buffer too small");
+}
+
+#ifndef CAYENE_NO_EXCEPTIONS
+
+TEST_F(ErrorCodeTest, ExceptionsCarryMatchingCodes)
+{
+    EXPECT_EQ(PayloadEmptyException().code(), ErrorCode::PayloadEmpty);
+    EXPECT_EQ(UnknownDataTypeException(0xFF).code(), ErrorCode::UnknownDataType);
+    EXPECT_EQ(BadPayloadFormatException("x").code(), ErrorCode::BadPayloadFormat);
+    EXPECT_EQ(UnexpectedException("x").code(), ErrorCode::Unexpected);
+}
+
+TEST_F(ErrorCodeTest, ThrowingDecodeMapsStatus)
+{
+    const std::vector<std::vector<std::uint8_t>> payloads = {
+        {},
+        {0x01, 0xFF, 0x00},
+        {0x01, 0x67, 0x01},
+        {0x01, 0x67, 0x01, 0x10, 0xFF},
+    };
+    for (const auto& payload : payloads)
+    {
+        Json result;
+        const auto status = decoder_.try_decode(payload, result);
+        try
+        {
+            static_cast<void>(decoder_.decode(payload));
+            ADD_FAILURE() << "decode did not throw";
+        }
+        catch (const DecoderException& e)
+        {
+            EXPECT_EQ(e.code(), status.code);
+        }
+    }
+}
+
+TEST_F(ErrorCodeTest, ThrowingDecodeKeepsMessages)
+{
+    std::vector<std::uint8_t> truncated = {0x01, 0x67, 0x01};
+    std::vector<std::uint8_t> trailing = {0x01, 0x67, 0x01, 0x10, 0xFF};
+    std::vector<std::uint8_t> unknown = {0x01, 0xAB, 0x00};
+
+    auto message = [this](const std::vector<std::uint8_t>& payload)
+    {
+        try
+        {
+            static_cast<void>(decoder_.decode(payload));
+        }
+        catch (const DecoderException& e)
+        {
+            return std::string(e.what());
+        }
+        return std::string();
+    };
+
+    EXPECT_EQ(message(truncated), "Bad payload format: Insufficient bytes for data type");
+    EXPECT_EQ(message(trailing), "Bad payload format: Unprocessed bytes remaining");
+    EXPECT_EQ(message(unknown), "Unknown data type: 0xAB");
+}
+
+TEST_F(ErrorCodeTest, ExceptionsCarryStructuredFields)
+{
+    const std::vector<std::uint8_t> payload = {0x01, 0x67, 0x01, 0x10, 0x02, 0xAB, 0x00};
+    try
+    {
+        static_cast<void>(decoder_.decode(payload));
+        ADD_FAILURE() << "decode did not throw";
+    }
+    catch (const UnknownDataTypeException& e)
+    {
+        EXPECT_EQ(e.code(), ErrorCode::UnknownDataType);
+        EXPECT_EQ(e.offset(), 4U);
+        EXPECT_EQ(e.type_id(), 0xAB);
+        EXPECT_EQ(e.payload_size(), payload.size());
+
+        // Copies carry the text along and agree with the original
+        const UnknownDataTypeException copy = e;
+        EXPECT_STREQ(copy.what(), "Unknown data type: 0xAB");
+        EXPECT_STREQ(e.what(), copy.what());
+        EXPECT_EQ(copy.offset(), 4U);
+    }
+
+    const std::vector<std::uint8_t> truncated = {0x01, 0x67, 0x01, 0x10, 0x02, 0x68};
+    try
+    {
+        static_cast<void>(decoder_.decode(truncated));
+        ADD_FAILURE() << "decode did not throw";
+    }
+    catch (const BadPayloadFormatException& e)
+    {
+        EXPECT_EQ(e.offset(), 4U);
+        EXPECT_EQ(e.type_id(), 0x68);
+        EXPECT_EQ(e.payload_size(), truncated.size());
+    }
+
+    // Messages given by the thrower are kept verbatim and carry no location
+    const BadPayloadFormatException custom("Battery decoder requires 2 bytes");
+    EXPECT_STREQ(custom.what(), "Bad payload format: Battery decoder requires 2 bytes");
+    EXPECT_EQ(custom.offset(), 0U);
+    EXPECT_STREQ(DecoderException("plain").what(), "plain");
+    EXPECT_STREQ(PayloadEmptyException().what(), "Payload is empty");
+
+    static_assert(std::is_base_of_v<std::runtime_error, DecoderException>);
+    const PayloadEmptyException empty;
+    const std::runtime_error& base = empty;
+    EXPECT_STREQ(base.what(), "Payload is empty");
+}
+
+TEST_F(ErrorCodeTest, MessageIsSafeAcrossThreads)
+{
+    std::exception_ptr error;
+    try
+    {
+        static_cast<void>(decoder_.decode(std::vector<std::uint8_t>{0x01, 0x67, 0x01}));
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+    ASSERT_TRUE(error);
+
+    std::vector<std::thread> threads;
+    std::vector<std::string> messages(4);
+    for (std::size_t i = 0; i < messages.size(); ++i)
+    {
+        threads.emplace_back(
+            [&, i]()
+            {
+                try
+                {
+                    std::rethrow_exception(error);
+                }
+                catch (const std::exception& e)
+                {
+                    messages[i] = e.what();
+                }
+            });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    for (const std::string& message : messages)
+    {
+        EXPECT_EQ(message, "Bad payload format: Insufficient bytes for data type");
+    }
+}
+
+#endif  // CAYENE_NO_EXCEPTIONS
+
+}  // namespace cayene::test
@@ -0,0 +1,172 @@
+/**
+ * @file filter_test.cpp
+ * @brief Unit tests for projected decoding with RecordFilter
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cayene/decoder.hpp"
+
+namespace cayene::test
+{
+
+class FilterTest : public ::testing::Test
+{
+protected:
+    Decoder decoder_;
+
+    // Tracker payload: GPS among accelerometer, gyrometer and temperature records
+    const std::vector<std::uint8_t> tracker_ = {
+        0x01, 0x71, 0x04, 0xD2, 0xFB, 0x2E, 0x00, 0x00,                    // Accelerometer
+        0x02, 0x86, 0x01, 0x99, 0xFE, 0x67, 0x00, 0x00,                    // Gyrometer
+        0x03, 0x88, 0x06, 0x76, 0x5F, 0xF2, 0x96, 0x0A, 0x00, 0x03, 0xE8,  // GPS
+        0x03, 0x89, 0x00,                                                  // Unknown type
+        0x04, 0x67, 0x01, 0x10                                             // Temperature 27.2
+    };
+};
+
+TEST_F(FilterTest, SelectsAllByDefault)
+{
+    constexpr RecordFilter filter;
+    static_assert(filter.selects_all());
+    static_assert(filter.matches(0xFF, 0x00));
+}
+
+TEST_F(FilterTest, TypeAndChannelSets)
+{
+    constexpr auto gps = RecordFilter::types({0x88});
+    static_assert(!gps.selects_all());
+    static_assert(gps.matches(7, 0x88));
+    static_assert(!gps.matches(7, 0x67));
+
+    auto filter = RecordFilter::channels({1, 200});
+    filter.allow_type(0x67).allow_type(0xFF);
+    EXPECT_TRUE(filter.matches(1, 0x67));
+    EXPECT_TRUE(filter.matches(200, 0xFF));
+    EXPECT_FALSE(filter.matches(2, 0x67));
+    EXPECT_FALSE(filter.matches(1, 0x68));
+}
+
+TEST_F(FilterTest, TryDecodeProjectsGps)
+{
+    std::vector<std::uint8_t> payload(tracker_.begin(), tracker_.begin() + 27);
+    payload.insert(payload.end(), tracker_.end() - 4, tracker_.end());
+
+    Json result;
+    const auto status = decoder_.try_decode(payload, result, RecordFilter::types({0x88}));
+    ASSERT_TRUE(status.ok());
+    EXPECT_EQ(status.count, 1U);
+    EXPECT_EQ(status.offset, payload.size());
+    ASSERT_EQ(result.size(), 1U);
+    EXPECT_DOUBLE_EQ(result["GPS_3"]["latitude"], 42.3519);
+    EXPECT_DOUBLE_EQ(result["GPS_3"]["altitude"], 10.0);
+}
+
+TEST_F(FilterTest, SkippedRecordsMustBeWellFormed)
+{
+    Json result;
+    const auto filter = RecordFilter::types({0x88});
+
+    // The unknown 0x89 record cannot be skipped since its size is unknown
+    auto status = decoder_.try_decode(tracker_, result, filter);
+    EXPECT_EQ(status.code, ErrorCode::UnknownDataType);
+    EXPECT_EQ(status.offset, 27U);
+
+    // A truncated record outside the projection is still a format error
+    const std::vector<std::uint8_t> truncated = {0x03, 0x88, 0x06, 0x76, 0x5F, 0xF2, 0x96,
+                                                 0x0A, 0x00, 0x03, 0xE8, 0x04, 0x67, 0x01};
+    status = decoder_.validate(truncated);
+    EXPECT_EQ(decoder_.try_decode(truncated, result, filter).code, status.code);
+    EXPECT_EQ(status.code, ErrorCode::BadPayloadFormat);
+}
+
+TEST_F(FilterTest, ChannelProjection)
+{
+    const std::vector<std::uint8_t> payload = {
+        0x01, 0x67, 0x01, 0x10,  // Temperature_1
+        0x02, 0x67, 0x00, 0xFF,  // Temperature_2
+        0x01, 0x68, 0x02, 0x58   // Humidity_1
+    };
+
+    std::array<Record, 4> records{};
+    const auto status = decoder_.decode_records(payload, records, RecordFilter::channels({1}));
+    ASSERT_TRUE(status.ok());
+    ASSERT_EQ(status.count, 2U);
+    EXPECT_EQ(records[0].type_id, 0x67);
+    EXPECT_EQ(records[1].type_id, 0x68);
+    EXPECT_EQ(records[1].data.data(), payload.data() + 10);
+}
+
+TEST_F(FilterTest, RecordBufferOnlyNeedsSelectedRecords)
+{
+    const std::vector<std::uint8_t> payload(tracker_.begin(), tracker_.begin() + 27);
+
+    std::array<Record, 1> records{};
+    EXPECT_EQ(decoder_.decode_records(payload, records).code, ErrorCode::BufferTooSmall);
+    EXPECT_TRUE(decoder_.decode_records(payload, records, RecordFilter::types({0x88})).ok());
+    EXPECT_EQ(records[0].channel, 3);
+}
+
+TEST_F(FilterTest, VisitAndWriteJsonAgree)
+{
+    const std::vector<std::uint8_t> payload(tracker_.begin(), tracker_.begin() + 27);
+    auto filter = RecordFilter::types({0x71, 0x86});
+    filter.allow_channel(2);
+
+    std::vector<std::uint8_t> visited;
+    const auto status = decoder_.visit(payload, filter, [&visited](const Record& record)
+                                       { visited.push_back(record.type_id); });
+    ASSERT_TRUE(status.ok());
+    EXPECT_EQ(visited, std::vector<std::uint8_t>{0x86});
+
+    std::array<char, 128> text{};
+    const auto written = decoder_.write_json(payload, text, filter);
+    ASSERT_TRUE(written.ok());
+    EXPECT_EQ(std::string_view(text.data(), written.count),
+              R"({"Gyrometer_2":{"x":4.09,"y":-4.09,"z":0.0}})");
+
+    Json result;
+    ASSERT_TRUE(decoder_.try_decode(payload, result, filter).ok());
+    EXPECT_EQ(Json::parse(std::string_view(text.data(), written.count)), result);
+}
+
+TEST_F(FilterTest, CustomTypesAreNotInvokedWhenSkipped)
+{
+    int calls = 0;
+    decoder_.add_custom_type(0xC0, "Custom", 2,
+                             [&calls](std::span<const std::uint8_t>)
+                             {
+                                 ++calls;
+                                 return Json(nullptr);
+                             });
+
+    const std::vector<std::uint8_t> payload = {0x01, 0xC0, 0xAA, 0xBB, 0x02, 0x67, 0x01, 0x10};
+    Json result;
+    ASSERT_TRUE(decoder_.try_decode(payload, result, RecordFilter::types({0x67})).ok());
+    EXPECT_EQ(calls, 0);
+    EXPECT_TRUE(result.contains("Temperature_2"));
+}
+
+#ifndef CAYENE_NO_EXCEPTIONS
+TEST_F(FilterTest, DecodeThrowsOnSkippedErrors)
+{
+    EXPECT_THROW(static_cast<void>(decoder_.decode(tracker_, RecordFilter::types({0x67}))),
+                 UnknownDataTypeException);
+
+    const std::vector<std::uint8_t> payload(tracker_.begin(), tracker_.begin() + 27);
+    const Json result = decoder_.decode(payload, RecordFilter::channels({3}));
+    EXPECT_EQ(result.size(), 1U);
+    EXPECT_TRUE(result.contains("GPS_3"));
+}
+#endif
+
+}  // namespace cayene::test
@@ -0,0 +1,142 @@
+/**
+ * @file flat_object_test.cpp
+ * @brief Unit tests for the flat decode output
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cayene/decoder.hpp"
+
+namespace cayene::test
+{
+
+class FlatObjectTest : public ::testing::Test
+{
+protected:
+    Decoder decoder_;
+    FlatObject output_;
+
+    const std::vector<std::uint8_t> payload_ = {
+        0x03, 0x88, 0x06, 0x76, 0x5F, 0xF2, 0x96, 0x0A, 0x00, 0x03, 0xE8,  // GPS
+        0x01, 0x67, 0x01, 0x10,                                            // Temperature 27.2
+        0x02, 0x65, 0x01, 0x90,                                            // Luminosity 400
+        0x04, 0x71, 0x04, 0xD2, 0xFB, 0x2E, 0x00, 0x00                     // Accelerometer
+    };
+
+    Json reference(std::span<const std::uint8_t> payload) const
+    {
+        Json result;
+        EXPECT_TRUE(decoder_.try_decode(payload, result).ok());
+        return result;
+    }
+};
+
+TEST_F(FlatObjectTest, KeepsPayloadOrder)
+{
+    const auto status = decoder_.decode_flat(payload_, output_);
+    ASSERT_TRUE(status.ok());
+    EXPECT_EQ(status.count, 4U);
+    ASSERT_EQ(output_.size(), 4U);
+
+    EXPECT_EQ(output_[0].name, "GPS");
+    EXPECT_EQ(output_[0].channel(), 3);
+    EXPECT_EQ(output_[1].key(), "Temperature_1");
+    EXPECT_DOUBLE_EQ(output_[1].value(), 27.2);
+    EXPECT_EQ(output_[2].type_id(), 0x65);
+    EXPECT_DOUBLE_EQ(output_[3].value(1), -1.234);
+}
+
+TEST_F(FlatObjectTest, ToJsonMatchesDecode)
+{
+    ASSERT_TRUE(decoder_.decode_flat(payload_, output_).ok());
+    const Json converted = output_.to_json();
+    EXPECT_EQ(converted, reference(payload_));
+    EXPECT_EQ(converted.dump(), reference(payload_).dump());
+    EXPECT_TRUE(converted["Luminosity_2"].is_number_unsigned());
+}
+
+TEST_F(FlatObjectTest, DuplicateKeysReplaceInPlace)
+{
+    const std::vector<std::uint8_t> payload = {
+        0x01, 0x67, 0x01, 0x10,  // Temperature_1 27.2
+        0x02, 0x68, 0x02, 0x58,  // Humidity_2
+        0x01, 0x67, 0x00, 0xFA   // Temperature_1 25.0
+    };
+
+    const auto status = decoder_.decode_flat(payload, output_);
+    ASSERT_TRUE(status.ok());
+    EXPECT_EQ(status.count, 3U);
+    ASSERT_EQ(output_.size(), 2U);
+    EXPECT_EQ(output_[0].key(), "Temperature_1");
+    EXPECT_DOUBLE_EQ(output_[0].value(), 25.0);
+    EXPECT_EQ(output_.to_json(), reference(payload));
+}
+
+TEST_F(FlatObjectTest, Find)
+{
+    ASSERT_TRUE(decoder_.decode_flat(payload_, output_).ok());
+    const FlatEntry* gps = output_.find("GPS", 3);
+    ASSERT_NE(gps, nullptr);
+    EXPECT_DOUBLE_EQ(gps->value(2), 10.0);
+    EXPECT_EQ(output_.find("GPS", 4), nullptr);
+    EXPECT_EQ(output_.find("Humidity", 3), nullptr);
+}
+
+TEST_F(FlatObjectTest, SpillsBeyondInlineCapacity)
+{
+    std::vector<std::uint8_t> payload;
+    for (std::uint8_t channel = 0; channel < 2 * FlatObject::kInlineCapacity; ++channel)
+    {
+        payload.insert(payload.end(), {channel, 0x67, 0x00, channel});
+    }
+
+    ASSERT_TRUE(decoder_.decode_flat(payload, output_).ok());
+    ASSERT_EQ(output_.size(), 2 * FlatObject::kInlineCapacity);
+    for (std::size_t i = 0; i < output_.size(); ++i)
+    {
+        EXPECT_EQ(output_[i].channel(), i);
+    }
+    EXPECT_EQ(output_.to_json(), reference(payload));
+
+    // Reuse returns to inline storage
+    ASSERT_TRUE(decoder_.decode_flat(payload_, output_).ok());
+    EXPECT_EQ(output_.size(), 4U);
+    EXPECT_EQ(output_.to_json(), reference(payload_));
+}
+
+TEST_F(FlatObjectTest, CustomTypes)
+{
+    decoder_.add_custom_type(0xC0, "Custom", 2,
+                             [](std::span<const std::uint8_t> data)
+                             { return Json{{"hi", data[0]}, {"lo", data[1]}}; });
+    const std::vector<std::uint8_t> payload = {0x07, 0xC0, 0x12, 0x34, 0x01, 0x67, 0x01, 0x10};
+
+    ASSERT_TRUE(decoder_.decode_flat(payload, output_).ok());
+    ASSERT_EQ(output_.size(), 2U);
+    EXPECT_EQ(output_[0].record.value_count, 0);
+    EXPECT_EQ(output_[0].custom["lo"], 0x34);
+    EXPECT_EQ(output_.to_json(), reference(payload));
+}
+
+TEST_F(FlatObjectTest, ErrorsAndProjection)
+{
+    const std::vector<std::uint8_t> truncated(payload_.begin(), payload_.end() - 1);
+    const auto status = decoder_.decode_flat(truncated, output_);
+    EXPECT_EQ(status.code, ErrorCode::BadPayloadFormat);
+    EXPECT_EQ(status.offset, 19U);
+    EXPECT_EQ(output_.size(), 3U);
+
+    ASSERT_TRUE(decoder_.decode_flat(payload_, output_, RecordFilter::types({0x88})).ok());
+    ASSERT_EQ(output_.size(), 1U);
+    EXPECT_EQ(output_[0].name, "GPS");
+}
+
+}  // namespace cayene::test
@@ -0,0 +1,149 @@
+/**
+ * @file payload_view_test.cpp
+ * @brief Unit tests for PayloadView and RawRecord
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cayene/payload_view.hpp"
+
+namespace cayene::test
+{
+
+static_assert(std::ranges::forward_range<PayloadView>);
+static_assert(std::ranges::view<PayloadView>);
+static_assert(std::ranges::sized_range<PayloadView>);
+static_assert(std::ranges::borrowed_range<PayloadView>);
+
+class PayloadViewTest : public ::testing::Test
+{
+protected:
+    Decoder decoder_;
+
+    const std::vector<std::uint8_t> payload_ = {
+        0x01, 0x67, 0x01, 0x10,                                            // Temperature 27.2
+        0x02, 0x68, 0x02, 0x58,                                            // Humidity 60.0
+        0x03, 0x88, 0x06, 0x76, 0x5F, 0xF2, 0x96, 0x0A, 0x00, 0x03, 0xE8,  // GPS
+        0x04, 0x67, 0xFF, 0x9C                                             // Temperature -10.0
+    };
+};
+
+TEST_F(PayloadViewTest, IteratesRawRecords)
+{
+    const PayloadView view(decoder_, payload_);
+    ASSERT_TRUE(view.valid());
+    EXPECT_EQ(view.size(), 4U);
+
+    std::vector<std::uint8_t> channels;
+    std::vector<std::uint8_t> types;
+    for (const RawRecord record : view)
+    {
+        channels.push_back(record.channel);
+        types.push_back(record.type_id);
+    }
+    EXPECT_EQ(channels, (std::vector<std::uint8_t>{1, 2, 3, 4}));
+    EXPECT_EQ(types, (std::vector<std::uint8_t>{0x67, 0x68, 0x88, 0x67}));
+
+    const RawRecord gps = *std::next(view.begin(), 2);
+    EXPECT_EQ(gps.data.data(), payload_.data() + 10);
+    EXPECT_EQ(gps.data.size(), 9U);
+}
+
+TEST_F(PayloadViewTest, DecodesValuesOnDemand)
+{
+    const PayloadView view(decoder_, payload_);
+    const RawRecord gps = *std::next(view.begin(), 2);
+
+    const Record record = gps.decode();
+    EXPECT_EQ(record.value_count, 3);
+    EXPECT_DOUBLE_EQ(record.value(0), 42.3519);
+    EXPECT_DOUBLE_EQ(record.value(1), -87.9094);
+    EXPECT_DOUBLE_EQ(record.value(2), 10.0);
+
+    EXPECT_DOUBLE_EQ(view.front().value(), 27.2);
+    EXPECT_DOUBLE_EQ((*std::next(view.begin(), 3)).value(), -10.0);
+}
+
+TEST_F(PayloadViewTest, MatchesDecodeRecords)
+{
+    std::vector<Record> records(8);
+    const auto status = decoder_.decode_records(payload_, records);
+    ASSERT_TRUE(status.ok());
+
+    std::size_t index = 0;
+    for (const RawRecord raw : PayloadView(decoder_, payload_))
+    {
+        const Record record = raw.decode();
+        EXPECT_EQ(record.data.data(), records[index].data.data());
+        ASSERT_EQ(record.value_count, records[index].value_count);
+        for (std::size_t i = 0; i < record.value_count; ++i)
+        {
+            EXPECT_EQ(record.raw[i], records[index].raw[i]);
+        }
+        ++index;
+    }
+    EXPECT_EQ(index, status.count);
+}
+
+TEST_F(PayloadViewTest, ComposesWithRangeAdaptors)
+{
+    auto temperatures = PayloadView(decoder_, payload_) |
+                        std::views::filter([](const RawRecord& record)
+                                           { return record.type_id == 0x67; }) |
+                        std::views::transform([](const RawRecord& record)
+                                              { return record.value(); });
+
+    const std::vector<double> values(temperatures.begin(), temperatures.end());
+    ASSERT_EQ(values.size(), 2U);
+    EXPECT_DOUBLE_EQ(values[0], 27.2);
+    EXPECT_DOUBLE_EQ(values[1], -10.0);
+
+    EXPECT_EQ(std::ranges::count_if(PayloadView(decoder_, payload_),
+                                    [](const RawRecord& record) { return record.channel > 2; }),
+              2);
+
+    // Borrowed: the iterator stays valid after the temporary view is gone
+    const auto gps = std::ranges::find(PayloadView(decoder_, payload_), std::uint8_t{0x88},
+                                       &RawRecord::type_id);
+    EXPECT_EQ((*gps).channel, 3);
+}
+
+TEST_F(PayloadViewTest, InvalidPayloadIsEmpty)
+{
+    const std::vector<std::uint8_t> truncated(payload_.begin(), payload_.end() - 1);
+    const PayloadView view(decoder_, truncated);
+    EXPECT_FALSE(view.valid());
+    EXPECT_TRUE(view.empty());
+    EXPECT_EQ(view.size(), 0U);
+    EXPECT_EQ(view.status().code, ErrorCode::BadPayloadFormat);
+    EXPECT_EQ(view.status().offset, 19U);
+
+    EXPECT_EQ(PayloadView(decoder_, {}).status().code, ErrorCode::PayloadEmpty);
+    EXPECT_TRUE(PayloadView().empty());
+}
+
+TEST_F(PayloadViewTest, CustomTypesHaveNoValues)
+{
+    decoder_.add_custom_type(0xC0, "Custom", 3,
+                             [](std::span<const std::uint8_t>) { return Json(nullptr); });
+    const std::vector<std::uint8_t> payload = {0x05, 0xC0, 0x01, 0x02, 0x03,
+                                               0x01, 0x67, 0x00, 0x01};
+
+    const PayloadView view(decoder_, payload);
+    ASSERT_EQ(view.size(), 2U);
+    EXPECT_EQ(view.front().data.size(), 3U);
+    EXPECT_EQ(view.front().decode().value_count, 0);
+    EXPECT_DOUBLE_EQ((*std::next(view.begin(), 1)).value(), 0.1);
+}
+
+}  // namespace cayene::test
@@ -0,0 +1,331 @@
+/**
+ * @file pipeline_test.cpp
+ * @brief Unit tests for the sharded ingest/decode pipeline
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cayene/pipeline.hpp"
+
+namespace cayene::test
+{
+
+class PipelineTest : public ::testing::Test
+{
+protected:
+    Decoder decoder_;
+
+    const std::vector<std::uint8_t> payload_ = {
+        0x01, 0x67, 0x01, 0x10,  // Temperature 27.2
+        0x02, 0x68, 0x02, 0x58   // Humidity 60.0
+    };
+};
+
+TEST_F(PipelineTest, DecodesEverySubmittedPayload)
+{
+    CountingSink sink(3);
+    PipelineConfig config;
+    config.producers = 2;
+    config.workers = 3;
+    config.ring_capacity = 8;
+    Pipeline pipeline(decoder_, sink, config);
+    ASSERT_EQ(pipeline.producer_count(), 2U);
+    ASSERT_EQ(pipeline.worker_count(), 3U);
+    pipeline.start();
+
+    constexpr std::uint32_t kPerProducer = 5000;
+    std::vector<std::thread> producers;
+    for (std::size_t p = 0; p < 2; ++p)
+    {
+        producers.emplace_back(
+            [&, p]()
+            {
+                for (std::uint32_t i = 0; i < kPerProducer; ++i)
+                {
+                    const auto device = static_cast<std::uint32_t>((p * kPerProducer) + i);
+                    EXPECT_EQ(pipeline.producer(p).submit(device, i, payload_),
+                              SubmitStatus::Accepted);
+                }
+            });
+    }
+    for (std::thread& producer : producers)
+    {
+        producer.join();
+    }
+    pipeline.stop();
+
+    EXPECT_EQ(sink.payloads(), 2 * kPerProducer);
+    EXPECT_EQ(sink.records(), 4 * kPerProducer);
+    EXPECT_EQ(sink.failures(), 0U);
+    for (std::size_t worker = 0; worker < 3; ++worker)
+    {
+        EXPECT_GT(sink.payloads(worker), 0U);
+    }
+
+    const PipelineStats stats = pipeline.stats();
+    EXPECT_EQ(stats.submitted, 2 * kPerProducer);
+    EXPECT_EQ(stats.decoded, 2 * kPerProducer);
+    EXPECT_EQ(stats.failed, 0U);
+}
+
+TEST_F(PipelineTest, KeepsDeviceOrderOnOneWorker)
+{
+    std::mutex mutex;
+    std::vector<std::vector<std::uint64_t>> seen(4);
+    std::vector<std::size_t> worker_of_device(4, 99);
+    FunctionSink sink(
+        [&](std::size_t worker, const DecodedPayload& result)
+        {
+            const std::lock_guard lock(mutex);
+            seen[result.device].push_back(result.timestamp);
+            EXPECT_TRUE(worker_of_device[result.device] == 99 ||
+                        worker_of_device[result.device] == worker);
+            worker_of_device[result.device] = worker;
+        });
+
+    PipelineConfig config;
+    config.workers = 2;
+    config.ring_capacity = 4;
+    Pipeline pipeline(decoder_, sink, config);
+    pipeline.start();
+    for (std::uint64_t i = 0; i < 1000; ++i)
+    {
+        pipeline.producer(0).submit(static_cast<std::uint32_t>(i % 4), i, payload_);
+    }
+    pipeline.stop();
+
+    for (std::uint32_t device = 0; device < 4; ++device)
+    {
+        ASSERT_EQ(seen[device].size(), 250U);
+        for (std::size_t i = 0; i < seen[device].size(); ++i)
+        {
+            EXPECT_EQ(seen[device][i], (i * 4) + device);
+        }
+        EXPECT_EQ(worker_of_device[device], pipeline.worker_of(device));
+    }
+}
+
+TEST_F(PipelineTest, BackpressureAndLimits)
+{
+    CountingSink sink(1);
+    PipelineConfig config;
+    config.ring_capacity = 2;
+    Pipeline pipeline(decoder_, sink, config);
+
+    // Not started: the ring fills up and try_submit reports it
+    auto& producer = pipeline.producer(0);
+    EXPECT_EQ(producer.try_submit(1, 0, payload_), SubmitStatus::Accepted);
+    EXPECT_EQ(producer.try_submit(1, 1, payload_), SubmitStatus::Accepted);
+    EXPECT_EQ(producer.try_submit(1, 2, payload_), SubmitStatus::Full);
+
+    const std::vector<std::uint8_t> huge(kMaxPipelinePayload + 1, 0);
+    EXPECT_EQ(producer.submit(1, 3, huge), SubmitStatus::TooLarge);
+
+    // A blocked submit completes once the workers drain the ring
+    std::thread blocked([&producer, this]()
+                        { EXPECT_EQ(producer.submit(1, 4, payload_), SubmitStatus::Accepted); });
+    while (pipeline.stats().backpressure == 0)
+    {
+        std::this_thread::yield();
+    }
+    pipeline.start();
+    blocked.join();
+    pipeline.stop();
+
+    const PipelineStats stats = pipeline.stats();
+    EXPECT_EQ(stats.submitted, 3U);
+    EXPECT_EQ(stats.rejected, 1U);
+    EXPECT_EQ(stats.too_large, 1U);
+    EXPECT_EQ(stats.backpressure, 1U);
+    EXPECT_EQ(sink.payloads(), 3U);
+}
+
+TEST_F(PipelineTest, ReportsFailuresAndRecordLimits)
+{
+    std::vector<DecodeStatus> statuses;
+    std::vector<std::size_t> record_counts;
+    FunctionSink sink(
+        [&](std::size_t, const DecodedPayload& result)
+        {
+            statuses.push_back(result.status);
+            record_counts.push_back(result.records.size());
+        });
+
+    PipelineConfig config;
+    config.max_records = 1;
+    Pipeline pipeline(decoder_, sink, config);
+    pipeline.start();
+    const std::vector<std::uint8_t> truncated(payload_.begin(), payload_.end() - 1);
+    pipeline.producer(0).submit(1, 0, truncated);
+    pipeline.producer(0).submit(1, 1, payload_);
+    pipeline.producer(0).submit(1, 2, std::span(payload_).first(4));
+    pipeline.stop();
+
+    ASSERT_EQ(statuses.size(), 3U);
+    EXPECT_EQ(statuses[0].code, ErrorCode::BadPayloadFormat);
+    EXPECT_EQ(record_counts[0], 1U);
+    EXPECT_EQ(statuses[1].code, ErrorCode::BufferTooSmall);
+    EXPECT_EQ(record_counts[1], 1U);
+    EXPECT_TRUE(statuses[2].ok());
+    EXPECT_EQ(pipeline.stats().failed, 2U);
+}
+
+TEST_F(PipelineTest, StopWithoutStartAndRestart)
+{
+    CountingSink sink(1);
+    Pipeline pipeline(decoder_, sink);
+    pipeline.stop();
+    pipeline.start();
+    pipeline.producer(0).submit(1, 0, payload_);
+    pipeline.stop();
+    pipeline.start();
+    pipeline.producer(0).submit(1, 1, payload_);
+    pipeline.stop();
+    EXPECT_EQ(sink.payloads(), 2U);
+}
+
+TEST_F(PipelineTest, ReportsHotPartitionAndItsDevice)
+{
+    CountingSink sink(4);
+    PipelineConfig config;
+    config.workers = 4;
+    Pipeline pipeline(decoder_, sink, config);
+
+    // Queued before start, so the hot worker finds its whole backlog at once
+    constexpr std::uint32_t kHotDevice = 42;
+    for (std::uint64_t i = 0; i < 300; ++i)
+    {
+        pipeline.producer(0).submit(kHotDevice, i, payload_);
+    }
+    std::size_t hot_backlog = 300;
+    for (std::uint32_t device = 1000; device < 1100; ++device)
+    {
+        pipeline.producer(0).submit(device, 0, payload_);
+        if (pipeline.worker_of(device) == pipeline.worker_of(kHotDevice))
+        {
+            ++hot_backlog;
+        }
+    }
+    EXPECT_EQ(pipeline.skew().workers[pipeline.worker_of(kHotDevice)].queued, hot_backlog);
+    pipeline.start();
+    pipeline.stop();
+
+    const PartitionSkew skew = pipeline.skew();
+    const std::size_t hot = pipeline.worker_of(kHotDevice);
+    ASSERT_EQ(skew.workers.size(), 4U);
+    EXPECT_EQ(skew.busiest, hot);
+    EXPECT_EQ(skew.hot_count, 1U);
+    EXPECT_DOUBLE_EQ(skew.mean, 100.0);
+    EXPECT_GT(skew.imbalance, 2.5);
+
+    const WorkerLoad& load = skew.workers[hot];
+    EXPECT_TRUE(load.hot);
+    EXPECT_EQ(load.top_device, kHotDevice);
+    EXPECT_GE(load.top_payloads, 300U);
+    EXPECT_EQ(load.peak_queued, hot_backlog);
+    EXPECT_EQ(load.queued, 0U);
+
+    std::uint64_t total = 0;
+    for (std::size_t worker = 0; worker < skew.workers.size(); ++worker)
+    {
+        total += skew.workers[worker].decoded;
+        EXPECT_EQ(skew.workers[worker].decoded, sink.payloads(worker));
+    }
+    EXPECT_EQ(total, 400U);
+}
+
+TEST_F(PipelineTest, EvenLoadIsNotSkewed)
+{
+    CountingSink sink(2);
+    PipelineConfig config;
+    config.workers = 2;
+    Pipeline pipeline(decoder_, sink, config);
+
+    EXPECT_DOUBLE_EQ(pipeline.skew().imbalance, 1.0);
+    EXPECT_EQ(pipeline.skew().hot_count, 0U);
+
+    pipeline.start();
+    for (std::uint32_t device = 0; device < 10'000; ++device)
+    {
+        pipeline.producer(0).submit(device, 0, payload_);
+    }
+    pipeline.stop();
+
+    const PartitionSkew skew = pipeline.skew();
+    EXPECT_EQ(skew.hot_count, 0U);
+    EXPECT_LT(skew.imbalance, 1.1);
+}
+
+TEST_F(PipelineTest, PlacesWorkersAndProducersOnNodes)
+{
+    // Two "nodes" sharing a CPU this process may use, so pinning succeeds anywhere
+    const unsigned cpu = CpuTopology::detect().nodes.front().front();
+    CountingSink sink(4);
+    PipelineConfig config;
+    config.producers = 2;
+    config.workers = 4;
+    config.placement = CpuPlacement::Core;
+    config.topology.nodes = {{cpu}, {cpu}};
+    Pipeline pipeline(decoder_, sink, config);
+
+    EXPECT_EQ(pipeline.topology().node_count(), 2U);
+    EXPECT_EQ(pipeline.node_of_worker(0), 0U);
+    EXPECT_EQ(pipeline.node_of_worker(1), 0U);
+    EXPECT_EQ(pipeline.node_of_worker(2), 1U);
+    EXPECT_EQ(pipeline.node_of_worker(3), 1U);
+    EXPECT_EQ(pipeline.producer(0).node(), 0U);
+    EXPECT_EQ(pipeline.producer(1).node(), 1U);
+
+    pipeline.start();
+    std::vector<std::thread> producers;
+    for (std::size_t p = 0; p < 2; ++p)
+    {
+        producers.emplace_back(
+            [&, p]()
+            {
+                Pipeline::Producer& producer = pipeline.producer(p);
+#if defined(__linux__)
+                EXPECT_TRUE(producer.pin());
+#endif
+                // Node-local submission: each producer takes its node's devices
+                for (std::uint32_t device = 0; device < 1000; ++device)
+                {
+                    EXPECT_EQ(pipeline.node_of(device),
+                              pipeline.node_of_worker(pipeline.worker_of(device)));
+                    if (pipeline.node_of(device) == producer.node())
+                    {
+                        producer.submit(device, 0, payload_);
+                    }
+                }
+            });
+    }
+    for (std::thread& producer : producers)
+    {
+        producer.join();
+    }
+    pipeline.stop();
+
+    EXPECT_EQ(sink.payloads(), 1000U);
+    EXPECT_EQ(sink.failures(), 0U);
+#if defined(__linux__)
+    EXPECT_EQ(pipeline.stats().unpinned, 0U);
+#endif
+
+    // Without placement there is no node to pin a producer to
+    CountingSink plain_sink(1);
+    Pipeline plain(decoder_, plain_sink);
+    EXPECT_TRUE(plain.topology().nodes.empty());
+    EXPECT_EQ(plain.node_of(42), 0U);
+    EXPECT_FALSE(plain.producer(0).pin());
+}
+
+}  // namespace cayene::test
@@ -0,0 +1,174 @@
+/**
+ * @file series_store_test.cpp
+ * @brief Unit tests for the compressed time-series store
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cayene/series_store.hpp"
+
+namespace cayene::test
+{
+
+namespace
+{
+
+std::vector<SeriesPoint> collect(const CompressedSeries& series)
+{
+    std::vector<SeriesPoint> points;
+    series.for_each([&points](const SeriesPoint& point) { points.push_back(point); });
+    return points;
+}
+
+}  // namespace
+
+TEST(SeriesStoreTest, RegularSeriesCompresses)
+{
+    // One day of minute readings of a slowly moving temperature
+    CompressedSeries series(0x67);
+    for (std::int32_t minute = 0; minute < 1440; ++minute)
+    {
+        series.append(1'700'000'000'000ULL + (static_cast<std::uint64_t>(minute) * 60'000),
+                      {200 + (minute / 10) % 50, 0, 0});
+    }
+    ASSERT_EQ(series.size(), 1440U);
+    EXPECT_LT(series.memory_bytes(), 1440U);
+
+    const auto points = collect(series);
+    ASSERT_EQ(points.size(), 1440U);
+    EXPECT_EQ(points[1].timestamp, 1'700'000'060'000ULL);
+    EXPECT_DOUBLE_EQ(points[1439].value(), 24.3);
+    EXPECT_EQ(points[1439].type_id, 0x67);
+}
+
+TEST(SeriesStoreTest, IrregularValuesRoundTrip)
+{
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<std::int32_t> any_value(-8388608, 8388607);
+    std::uniform_int_distribution<std::uint64_t> jitter(0, 5000);
+
+    CompressedSeries series(0x88);
+    std::vector<SeriesPoint> expected;
+    std::uint64_t timestamp = 0;
+    for (int i = 0; i < 2000; ++i)
+    {
+        SeriesPoint point;
+        point.type_id = 0x88;
+        // Mostly ordered, with the occasional jump back and huge gap
+        timestamp = i % 97 == 0 ? timestamp - 7 : timestamp + 1000 + jitter(random);
+        timestamp += i == 1000 ? 1ULL << 40U : 0;
+        point.timestamp = timestamp;
+        point.raw = {any_value(random), any_value(random), i % 3 == 0 ? any_value(random) : 0};
+        series.append(point.timestamp, point.raw);
+        expected.push_back(point);
+    }
+
+    const auto points = collect(series);
+    ASSERT_EQ(points.size(), expected.size());
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        ASSERT_EQ(points[i].timestamp, expected[i].timestamp) << i;
+        ASSERT_EQ(points[i].raw, expected[i].raw) << i;
+    }
+}
+
+TEST(SeriesStoreTest, ExtremesRoundTrip)
+{
+    constexpr auto kMin = std::numeric_limits<std::int32_t>::min();
+    constexpr auto kMax = std::numeric_limits<std::int32_t>::max();
+    constexpr auto kLast = std::numeric_limits<std::uint64_t>::max();
+
+    CompressedSeries series(0x71);
+    series.append(kLast, {kMin, kMax, 0});
+    series.append(0, {kMax, kMin, -1});
+    series.append(kLast, {kMin, kMax, 1});
+
+    const auto points = collect(series);
+    ASSERT_EQ(points.size(), 3U);
+    EXPECT_EQ(points[0].timestamp, kLast);
+    EXPECT_EQ(points[1].timestamp, 0U);
+    EXPECT_EQ(points[1].raw, (std::array<std::int32_t, 3>{kMax, kMin, -1}));
+    EXPECT_EQ(points[2].timestamp, kLast);
+    EXPECT_EQ(points[2].raw, (std::array<std::int32_t, 3>{kMin, kMax, 1}));
+}
+
+TEST(SeriesStoreTest, RangesAndRetention)
+{
+    constexpr std::size_t kBlock = CompressedSeries::kBlockPoints;
+    CompressedSeries series(0x68);
+    const std::size_t total = (3 * kBlock) + 10;
+    for (std::size_t i = 0; i < total; ++i)
+    {
+        series.append(i * 10, {static_cast<std::int32_t>(i), 0, 0});
+    }
+
+    std::size_t visited = 0;
+    series.for_each(5000, 5100,
+                    [&visited](const SeriesPoint& point)
+                    {
+                        EXPECT_EQ(point.raw[0] * 10, static_cast<std::int32_t>(point.timestamp));
+                        ++visited;
+                    });
+    EXPECT_EQ(visited, 10U);
+
+    // Only whole blocks older than the cutoff are dropped
+    EXPECT_EQ(series.drop_before(kBlock * 10), kBlock);
+    EXPECT_EQ(series.drop_before(kBlock * 15), 0U);
+    EXPECT_EQ(series.size(), total - kBlock);
+    EXPECT_EQ(collect(series).front().timestamp, kBlock * 10);
+}
+
+TEST(SeriesStoreTest, StoreAppendsDecodedPayloads)
+{
+    Decoder decoder;
+    decoder.add_custom_type(0xC0, "Custom", 1,
+                            [](std::span<const std::uint8_t> data) { return Json(data[0]); });
+    SeriesStore store;
+    const std::vector<std::uint8_t> payload = {
+        0x01, 0x67, 0x01, 0x10,  // Temperature 27.2
+        0x02, 0x68, 0x02, 0x58,  // Humidity 60.0
+        0x03, 0xC0, 0x2A         // Custom: not stored
+    };
+
+    ASSERT_TRUE(store.append_payload(decoder, 7, 1000, payload));
+    ASSERT_TRUE(store.append_payload(decoder, 7, 2000, payload, RecordFilter::types({0x67})));
+    ASSERT_TRUE(store.append_payload(decoder, 8, 1000, payload));
+    EXPECT_EQ(store.series_count(), 4U);
+    EXPECT_EQ(store.point_count(), 5U);
+    EXPECT_GT(store.memory_bytes(), 0U);
+
+    const CompressedSeries* temperature = store.find(7, 1, 0x67);
+    ASSERT_NE(temperature, nullptr);
+    const auto points = collect(*temperature);
+    ASSERT_EQ(points.size(), 2U);
+    EXPECT_DOUBLE_EQ(points[1].value(), 27.2);
+    EXPECT_EQ(store.find(7, 3, 0xC0), nullptr);
+
+    std::size_t series = 0;
+    store.for_each_series(
+        [&series](std::uint32_t device, std::uint8_t channel, std::uint8_t type_id,
+                  const CompressedSeries& values)
+        {
+            EXPECT_TRUE(device == 7 || device == 8);
+            EXPECT_EQ(type_id, values.type_id());
+            EXPECT_EQ(channel, type_id == 0x67 ? 1 : 2);
+            ++series;
+        });
+    EXPECT_EQ(series, 4U);
+
+    EXPECT_EQ(store.drop_before(1500), 3U);
+    EXPECT_EQ(store.series_count(), 1U);
+    EXPECT_EQ(store.point_count(), 2U);
+}
+
+}  // namespace cayene::test
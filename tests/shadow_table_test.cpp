@@ -0,0 +1,210 @@
+/**
+ * @file shadow_table_test.cpp
+ * @brief Unit tests for the concurrent latest-value table
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cayene/shadow_table.hpp"
+
+namespace cayene::test
+{
+
+namespace
+{
+
+Record temperature(std::uint8_t channel, std::int32_t raw)
+{
+    Record record;
+    record.channel = channel;
+    record.type_id = 0x67;
+    record.value_count = 1;
+    record.raw[0] = raw;
+    return record;
+}
+
+}  // namespace
+
+TEST(ShadowTableTest, KeepsLatestValue)
+{
+    ShadowTable shadow(1, 16);
+    EXPECT_FALSE(shadow.read(1, 1, 0x67).has_value());
+
+    ASSERT_TRUE(shadow.update(1, 100, temperature(1, 250)));
+    ASSERT_TRUE(shadow.update(1, 200, temperature(1, 272)));
+    ASSERT_TRUE(shadow.update(0, 50, temperature(0, -5)));
+
+    const auto latest = shadow.read(1, 1, 0x67);
+    ASSERT_TRUE(latest.has_value());
+    EXPECT_EQ(latest->timestamp, 200U);
+    EXPECT_DOUBLE_EQ(latest->value(), 27.2);
+
+    const auto zero = shadow.read(0, 0, 0x67);
+    ASSERT_TRUE(zero.has_value());
+    EXPECT_DOUBLE_EQ(zero->value(), -0.5);
+
+    EXPECT_FALSE(shadow.read(1, 2, 0x67).has_value());
+    EXPECT_FALSE(shadow.read(1, 1, 0x68).has_value());
+    EXPECT_EQ(shadow.size(0), 2U);
+}
+
+TEST(ShadowTableTest, UpdatesFromPayloads)
+{
+    Decoder decoder;
+    ShadowTable shadow(4, 64);
+    const std::vector<std::uint8_t> payload = {
+        0x03, 0x88, 0x06, 0x76, 0x5F, 0xF2, 0x96, 0x0A, 0x00, 0x03, 0xE8,  // GPS
+        0x01, 0x67, 0x01, 0x10                                             // Temperature 27.2
+    };
+    ASSERT_TRUE(shadow.update_payload(decoder, 42, 1000, payload));
+    ASSERT_TRUE(shadow.update_payload(decoder, 43, 1000, payload, RecordFilter::types({0x67})));
+
+    const auto gps = shadow.read(42, 3, 0x88);
+    ASSERT_TRUE(gps.has_value());
+    EXPECT_DOUBLE_EQ(gps->value(0), 42.3519);
+    EXPECT_DOUBLE_EQ(gps->value(1), -87.9094);
+    EXPECT_EQ(gps->device, 42U);
+    EXPECT_TRUE(shadow.read(43, 1, 0x67).has_value());
+    EXPECT_FALSE(shadow.read(43, 3, 0x88).has_value());
+}
+
+TEST(ShadowTableTest, CustomTypesAndFullShards)
+{
+    ShadowTable shadow(1, 4);
+    Record custom;
+    custom.type_id = 0xC0;
+    EXPECT_FALSE(shadow.update(1, 0, custom));
+
+    std::size_t stored = 0;
+    for (std::uint32_t device = 0; device < 100; ++device)
+    {
+        if (shadow.update(device, 0, temperature(1, 1)))
+        {
+            ++stored;
+        }
+    }
+    EXPECT_EQ(stored, shadow.size(0));
+    EXPECT_LT(stored, 100U);
+    // Existing keys can still be updated when the shard is full
+    EXPECT_TRUE(shadow.update(0, 1, temperature(1, 2)));
+    EXPECT_FALSE(shadow.read(99, 1, 0x67).has_value());
+}
+
+TEST(ShadowTableTest, ShardsSpreadDevices)
+{
+    ShadowTable shadow(4, 16);
+    std::vector<std::size_t> per_shard(4);
+    for (std::uint32_t device = 0; device < 4000; ++device)
+    {
+        const std::size_t shard = shadow.shard_of(device);
+        ASSERT_LT(shard, 4U);
+        ++per_shard[shard];
+    }
+    for (const std::size_t count : per_shard)
+    {
+        EXPECT_GT(count, 800U);
+    }
+}
+
+TEST(ShadowTableTest, SlotLeftLockedByDeadWriterIsUnreadable)
+{
+    constexpr std::size_t kCapacity = 16;
+    std::vector<ShadowSlot> slots(kCapacity);
+    ShadowTable shadow(slots, 1, kCapacity);
+    ASSERT_TRUE(shadow.update(5, 1, temperature(1, 100)));
+    ASSERT_TRUE(shadow.update(6, 1, temperature(1, 200)));
+
+    // A writer that died between the two sequence stores of the device 5 slot
+    for (ShadowSlot& slot : slots)
+    {
+        if (slot.key.load() != 0 && slot.raw[0].load() == 100)
+        {
+            slot.sequence.fetch_add(1);
+        }
+    }
+    EXPECT_FALSE(shadow.read(5, 1, 0x67).has_value());
+    ASSERT_TRUE(shadow.read(6, 1, 0x67).has_value());
+    EXPECT_EQ(shadow.read(6, 1, 0x67)->raw[0], 200);
+}
+
+TEST(ShadowTableTest, ReadersNeverSeeTornValues)
+{
+    constexpr std::size_t kShards = 2;
+    constexpr std::uint32_t kDevices = 64;
+    ShadowTable shadow(kShards, kDevices);
+    std::atomic<bool> done{false};
+
+    // Each writer owns the devices of its shard and writes x == y == z == timestamp
+    std::vector<std::thread> threads;
+    for (std::size_t shard = 0; shard < kShards; ++shard)
+    {
+        threads.emplace_back(
+            [&shadow, shard]()
+            {
+                Record accel;
+                accel.type_id = 0x71;
+                accel.value_count = 3;
+                for (std::int32_t round = 0; round < 2000; ++round)
+                {
+                    for (std::uint32_t device = 0; device < kDevices; ++device)
+                    {
+                        if (shadow.shard_of(device) == shard)
+                        {
+                            accel.raw = {round, round, round};
+                            shadow.update(device, static_cast<std::uint64_t>(round), accel);
+                        }
+                    }
+                }
+            });
+    }
+
+    std::atomic<std::size_t> torn{0};
+    for (int reader = 0; reader < 2; ++reader)
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                while (!done.load(std::memory_order_relaxed))
+                {
+                    for (std::uint32_t device = 0; device < kDevices; ++device)
+                    {
+                        if (const auto value = shadow.read(device, 0, 0x71))
+                        {
+                            const bool consistent =
+                                value->raw[0] == value->raw[1] && value->raw[1] == value->raw[2] &&
+                                static_cast<std::uint64_t>(value->raw[0]) == value->timestamp;
+                            if (!consistent)
+                            {
+                                ++torn;
+                            }
+                        }
+                    }
+                }
+            });
+    }
+
+    threads[0].join();
+    threads[1].join();
+    done = true;
+    threads[2].join();
+    threads[3].join();
+
+    EXPECT_EQ(torn.load(), 0U);
+    for (std::uint32_t device = 0; device < kDevices; ++device)
+    {
+        const auto value = shadow.read(device, 0, 0x71);
+        ASSERT_TRUE(value.has_value());
+        EXPECT_EQ(value->timestamp, 1999U);
+    }
+}
+
+}  // namespace cayene::test
@@ -0,0 +1,319 @@
+/**
+ * @file shared_ring_test.cpp
+ * @brief Unit tests for the shared-memory uplink ring
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cayene/shared_ring.hpp"
+
+namespace cayene::test
+{
+
+class SharedRingTest : public ::testing::Test
+{
+protected:
+    const std::string name_ = "/cayene-ring-test-" + std::to_string(::getpid());
+    Decoder decoder_;
+
+    const std::vector<std::uint8_t> payload_ = {0x01, 0x67, 0x01, 0x10};  // Temperature 27.2
+};
+
+TEST_F(SharedRingTest, PushAndConsumeInPlace)
+{
+    auto ring = SharedUplinkRing::create(name_, 3);
+    ASSERT_TRUE(ring.has_value()) << errno;
+    EXPECT_EQ(ring->capacity(), 4U);
+    EXPECT_EQ(ring->size_bytes(), sizeof(SharedRingHeader) + (4 * sizeof(SharedRingSlot)));
+    EXPECT_FALSE(ring->try_consume([](const PayloadRef&) { FAIL(); }));
+
+    for (std::uint32_t device = 0; device < 4; ++device)
+    {
+        EXPECT_EQ(ring->try_push(device, 100 + device, payload_), SubmitStatus::Accepted);
+    }
+    EXPECT_EQ(ring->try_push(9, 0, payload_), SubmitStatus::Full);
+    const std::vector<std::uint8_t> huge(kMaxPipelinePayload + 1, 0);
+    EXPECT_EQ(ring->try_push(9, 0, huge), SubmitStatus::TooLarge);
+    EXPECT_EQ(ring->size(), 4U);
+
+    // The payload handed out is the slot itself, decodable without a copy
+    const std::uint8_t* first = nullptr;
+    ASSERT_TRUE(ring->try_consume(
+        [&](const PayloadRef& ref)
+        {
+            EXPECT_EQ(ref.device, 0U);
+            EXPECT_EQ(ref.timestamp, 100U);
+            first = ref.payload.data();
+            std::array<Record, 4> records{};
+            const DecodeStatus status = decoder_.decode_records(ref.payload, records);
+            ASSERT_TRUE(status.ok());
+            EXPECT_DOUBLE_EQ(records[0].value(), 27.2);
+        }));
+    EXPECT_EQ(ring->try_push(4, 104, payload_), SubmitStatus::Accepted);
+
+    std::vector<std::uint32_t> devices;
+    while (ring->try_consume(
+        [&](const PayloadRef& ref)
+        {
+            // Consecutive uplinks sit one slot apart in the mapping
+            EXPECT_EQ(ref.payload.data() - first,
+                      static_cast<std::ptrdiff_t>((ref.device % 4) * sizeof(SharedRingSlot)));
+            devices.push_back(ref.device);
+        }))
+    {
+    }
+    EXPECT_EQ(devices, (std::vector<std::uint32_t>{1, 2, 3, 4}));
+    EXPECT_EQ(ring->size(), 0U);
+}
+
+TEST_F(SharedRingTest, BatchClaimsConsecutiveUplinks)
+{
+    auto ring = SharedUplinkRing::create(name_, 16);
+    ASSERT_TRUE(ring.has_value());
+    for (std::uint32_t device = 0; device < 10; ++device)
+    {
+        ASSERT_EQ(ring->try_push(device, device, payload_), SubmitStatus::Accepted);
+    }
+
+    std::array<PayloadRef, 4> refs{};
+    std::vector<std::size_t> batch_sizes;
+    std::vector<std::uint32_t> devices;
+    auto visitor = [&](std::span<const PayloadRef> batch)
+    {
+        batch_sizes.push_back(batch.size());
+        for (const PayloadRef& ref : batch)
+        {
+            devices.push_back(ref.device);
+        }
+    };
+    while (ring->consume_batch(refs, visitor) != 0)
+    {
+    }
+    EXPECT_EQ(batch_sizes, (std::vector<std::size_t>{4, 4, 2}));
+    ASSERT_EQ(devices.size(), 10U);
+    for (std::uint32_t device = 0; device < 10; ++device)
+    {
+        EXPECT_EQ(devices[device], device);
+    }
+}
+
+#ifndef CAYENE_NO_EXCEPTIONS
+TEST_F(SharedRingTest, ThrowingVisitorReleasesTheBatch)
+{
+    auto ring = SharedUplinkRing::create(name_, 2);
+    ASSERT_TRUE(ring.has_value());
+    ASSERT_EQ(ring->try_push(1, 1, payload_), SubmitStatus::Accepted);
+    ASSERT_EQ(ring->try_push(2, 2, payload_), SubmitStatus::Accepted);
+
+    std::array<PayloadRef, 2> refs{};
+    EXPECT_THROW(ring->consume_batch(refs, [](std::span<const PayloadRef>)
+                                     { throw std::runtime_error("decode failed"); }),
+                 std::runtime_error);
+    EXPECT_EQ(ring->size(), 0U);
+    EXPECT_EQ(ring->try_push(3, 3, payload_), SubmitStatus::Accepted);
+    EXPECT_EQ(ring->try_push(4, 4, payload_), SubmitStatus::Accepted);
+}
+#endif
+
+TEST_F(SharedRingTest, ManyProducersAndConsumers)
+{
+    auto ring = SharedUplinkRing::create_anonymous(64);
+    ASSERT_TRUE(ring.has_value()) << errno;
+
+    constexpr std::uint32_t kProducers = 3;
+    constexpr std::uint32_t kPerProducer = 20'000;
+    std::atomic<std::uint64_t> consumed{0};
+    std::atomic<bool> ordered{true};
+    std::vector<std::thread> threads;
+
+    for (std::uint32_t p = 0; p < kProducers; ++p)
+    {
+        threads.emplace_back(
+            [&ring, p, this]()
+            {
+                for (std::uint32_t i = 0; i < kPerProducer; ++i)
+                {
+                    while (ring->try_push(p, i, payload_) != SubmitStatus::Accepted)
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+    }
+    // One consumer per producer's sequence would be needed for strict
+    // order; here a single consumer checks per-producer FIFO and others
+    // just count
+    std::array<std::uint64_t, kProducers> next{};
+    threads.emplace_back(
+        [&]()
+        {
+            while (consumed.load() < std::uint64_t{kProducers} * kPerProducer)
+            {
+                if (!ring->try_consume(
+                        [&](const PayloadRef& ref)
+                        {
+                            if (ref.timestamp < next[ref.device])
+                            {
+                                ordered = false;
+                            }
+                            next[ref.device] = ref.timestamp + 1;
+                            ++consumed;
+                        }))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    threads.emplace_back(
+        [&]()
+        {
+            std::array<PayloadRef, 8> refs{};
+            while (consumed.load() < std::uint64_t{kProducers} * kPerProducer)
+            {
+                if (ring->consume_batch(refs, [&](std::span<const PayloadRef> batch)
+                                        { consumed += batch.size(); }) == 0)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(consumed.load(), std::uint64_t{kProducers} * kPerProducer);
+    EXPECT_TRUE(ordered.load());
+    EXPECT_EQ(ring->size(), 0U);
+}
+
+TEST_F(SharedRingTest, OtherProcessesProduceThroughMemfd)
+{
+    auto ring = SharedUplinkRing::create_anonymous(32);
+    ASSERT_TRUE(ring.has_value()) << errno;
+    ASSERT_GE(ring->fd(), 0);
+
+    constexpr std::uint32_t kPerChild = 5000;
+    std::vector<pid_t> children;
+    for (std::uint32_t c = 0; c < 2; ++c)
+    {
+        const pid_t child = ::fork();
+        ASSERT_GE(child, 0);
+        if (child == 0)
+        {
+            // Map the ring afresh from the inherited descriptor, as a gateway process would
+            auto producer = SharedUplinkRing::open_fd(ring->fd());
+            if (!producer)
+            {
+                ::_exit(2);
+            }
+            for (std::uint32_t i = 0; i < kPerChild; ++i)
+            {
+                while (producer->try_push(c, i, payload_) != SubmitStatus::Accepted)
+                {
+                    std::this_thread::yield();
+                }
+            }
+            ::_exit(0);
+        }
+        children.push_back(child);
+    }
+
+    std::array<std::uint64_t, 2> received{};
+    std::size_t decoded = 0;
+    while (received[0] + received[1] < 2 * kPerChild)
+    {
+        ring->try_consume(
+            [&](const PayloadRef& ref)
+            {
+                EXPECT_EQ(ref.timestamp, received[ref.device]);
+                ++received[ref.device];
+                std::array<Record, 4> records{};
+                decoded += decoder_.decode_records(ref.payload, records).count;
+            });
+    }
+    for (const pid_t child : children)
+    {
+        int status = 0;
+        ASSERT_EQ(::waitpid(child, &status, 0), child);
+        ASSERT_TRUE(WIFEXITED(status));
+        EXPECT_EQ(WEXITSTATUS(status), 0);
+    }
+    EXPECT_EQ(decoded, 2U * kPerChild);
+}
+
+TEST_F(SharedRingTest, NamedRingOpenedByConsumer)
+{
+    auto producer = SharedUplinkRing::create(name_, 8);
+    ASSERT_TRUE(producer.has_value());
+    auto consumer = SharedUplinkRing::open(name_);
+    ASSERT_TRUE(consumer.has_value()) << errno;
+    EXPECT_EQ(consumer->capacity(), 8U);
+
+    ASSERT_EQ(producer->try_push(5, 6, payload_), SubmitStatus::Accepted);
+    EXPECT_TRUE(consumer->try_consume([](const PayloadRef& ref) { EXPECT_EQ(ref.device, 5U); }));
+    EXPECT_EQ(producer->size(), 0U);
+
+    // The creator unlinks the name when it goes away
+    SharedUplinkRing moved = std::move(*producer);
+    producer.reset();
+    EXPECT_TRUE(SharedUplinkRing::open(name_).has_value());
+    {
+        const SharedUplinkRing gone = std::move(moved);
+    }
+    errno = 0;
+    EXPECT_FALSE(SharedUplinkRing::open(name_).has_value());
+    EXPECT_EQ(errno, ENOENT);
+}
+
+TEST_F(SharedRingTest, ReplacingLeavesLiveConsumersMapped)
+{
+    auto first = SharedUplinkRing::create(name_, 8);
+    ASSERT_TRUE(first.has_value());
+    ASSERT_EQ(first->try_push(5, 6, payload_), SubmitStatus::Accepted);
+    auto consumer = SharedUplinkRing::open(name_);
+    ASSERT_TRUE(consumer.has_value());
+
+    // A smaller replacement must not truncate the segment the consumer maps
+    auto second = SharedUplinkRing::create(name_, 2);
+    ASSERT_TRUE(second.has_value());
+    EXPECT_TRUE(consumer->try_consume([](const PayloadRef& ref) { EXPECT_EQ(ref.device, 5U); }));
+    EXPECT_EQ(SharedUplinkRing::open(name_)->capacity(), 2U);
+
+    // The replaced creator leaves the new segment's name alone
+    first.reset();
+    EXPECT_TRUE(SharedUplinkRing::open(name_).has_value());
+}
+
+TEST_F(SharedRingTest, RejectsForeignSegments)
+{
+    const int fd = ::shm_open(name_.c_str(), O_CREAT | O_RDWR, 0600);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(::ftruncate(fd, 4096), 0);
+    errno = 0;
+    EXPECT_FALSE(SharedUplinkRing::open(name_).has_value());
+    EXPECT_EQ(errno, EINVAL);
+    EXPECT_FALSE(SharedUplinkRing::open_fd(fd).has_value());
+    EXPECT_EQ(errno, EINVAL);
+    ::close(fd);
+    ::shm_unlink(name_.c_str());
+}
+
+}  // namespace cayene::test
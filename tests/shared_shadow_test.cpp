@@ -0,0 +1,158 @@
+/**
+ * @file shared_shadow_test.cpp
+ * @brief Unit tests for the shared-memory device shadow
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cayene/shared_shadow.hpp"
+
+namespace cayene::test
+{
+
+class SharedShadowTest : public ::testing::Test
+{
+protected:
+    const std::string name_ = "/cayene-shadow-test-" + std::to_string(::getpid());
+    Decoder decoder_;
+
+    const std::vector<std::uint8_t> payload_ = {
+        0x03, 0x88, 0x06, 0x76, 0x5F, 0xF2, 0x96, 0x0A, 0x00, 0x03, 0xE8,  // GPS
+        0x01, 0x67, 0x01, 0x10                                             // Temperature 27.2
+    };
+};
+
+TEST_F(SharedShadowTest, ReaderMappingSeesWrites)
+{
+    auto writer = SharedShadowTable::create(name_, 2, 100);
+    ASSERT_TRUE(writer.has_value()) << errno;
+    EXPECT_EQ(writer->size_bytes(),
+              sizeof(SharedShadowHeader) + (2 * writer->table().shard_capacity() * 40));
+
+    auto reader = SharedShadowView::open(name_);
+    ASSERT_TRUE(reader.has_value()) << errno;
+    static_assert(std::is_const_v<std::remove_reference_t<decltype(reader->table())>>,
+                  "readers map the segment read-only and only get a const table");
+    EXPECT_EQ(reader->table().shard_count(), 2U);
+    EXPECT_FALSE(reader->table().read(7, 1, 0x67).has_value());
+
+    ASSERT_TRUE(writer->table().update_payload(decoder_, 7, 1000, payload_));
+    const auto temperature = reader->table().read(7, 1, 0x67);
+    ASSERT_TRUE(temperature.has_value());
+    EXPECT_EQ(temperature->timestamp, 1000U);
+    EXPECT_DOUBLE_EQ(temperature->value(), 27.2);
+
+    ASSERT_TRUE(writer->table().update_payload(decoder_, 7, 2000, payload_));
+    EXPECT_EQ(reader->table().read(7, 3, 0x88)->timestamp, 2000U);
+}
+
+TEST_F(SharedShadowTest, OtherProcessReads)
+{
+    auto writer = SharedShadowTable::create(name_, 1, 16);
+    ASSERT_TRUE(writer.has_value());
+    ASSERT_TRUE(writer->table().update_payload(decoder_, 42, 5, payload_));
+
+    const pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0)
+    {
+        // Map the segment afresh, as an independent reader process would
+        const auto reader = SharedShadowView::open(name_);
+        const bool ok = reader.has_value() && reader->table().read(42, 3, 0x88).has_value() &&
+                        reader->table().read(42, 3, 0x88)->value(0) == 42.3519;
+        ::_exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(::waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST_F(SharedShadowTest, RejectsMissingAndForeignSegments)
+{
+    errno = 0;
+    EXPECT_FALSE(SharedShadowView::open(name_).has_value());
+    EXPECT_EQ(errno, ENOENT);
+
+    const int fd = ::shm_open(name_.c_str(), O_CREAT | O_RDWR, 0600);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(::ftruncate(fd, 4096), 0);
+    ::close(fd);
+    errno = 0;
+    EXPECT_FALSE(SharedShadowView::open(name_).has_value());
+    EXPECT_EQ(errno, EINVAL);
+    ::shm_unlink(name_.c_str());
+}
+
+TEST_F(SharedShadowTest, CreatorUnlinksOnDestruction)
+{
+    {
+        auto writer = SharedShadowTable::create(name_, 1, 16);
+        ASSERT_TRUE(writer.has_value());
+        SharedShadowTable moved = std::move(*writer);
+        ASSERT_TRUE(moved.table().update_payload(decoder_, 1, 1, payload_));
+    }
+    EXPECT_FALSE(SharedShadowView::open(name_).has_value());
+
+    // Re-creating replaces any previous contents
+    auto first = SharedShadowTable::create(name_, 1, 16);
+    ASSERT_TRUE(first.has_value());
+    ASSERT_TRUE(first->table().update_payload(decoder_, 1, 1, payload_));
+    auto second = SharedShadowTable::create(name_, 1, 16);
+    ASSERT_TRUE(second.has_value());
+    EXPECT_FALSE(second->table().read(1, 1, 0x67).has_value());
+}
+
+TEST_F(SharedShadowTest, ReplacingLeavesLiveReadersMapped)
+{
+    auto first = SharedShadowTable::create(name_, 4, 1000);
+    ASSERT_TRUE(first.has_value());
+    ASSERT_TRUE(first->table().update_payload(decoder_, 9, 10, payload_));
+    auto reader = SharedShadowView::open(name_);
+    ASSERT_TRUE(reader.has_value());
+
+    // A smaller replacement must not shrink the object the reader maps
+    auto second = SharedShadowTable::create(name_, 1, 16);
+    ASSERT_TRUE(second.has_value());
+    const auto kept = reader->table().read(9, 1, 0x67);
+    ASSERT_TRUE(kept.has_value());
+    EXPECT_EQ(kept->timestamp, 10U);
+
+    auto fresh = SharedShadowView::open(name_);
+    ASSERT_TRUE(fresh.has_value());
+    EXPECT_EQ(fresh->table().shard_count(), 1U);
+    EXPECT_FALSE(fresh->table().read(9, 1, 0x67).has_value());
+
+    // The replaced creator leaves the new segment's name alone
+    first.reset();
+    EXPECT_TRUE(SharedShadowView::open(name_).has_value());
+}
+
+TEST_F(SharedShadowTest, SegmentIsPrivateToItsUser)
+{
+    auto writer = SharedShadowTable::create(name_, 1, 16);
+    ASSERT_TRUE(writer.has_value());
+    const int fd = ::shm_open(name_.c_str(), O_RDONLY, 0);
+    ASSERT_GE(fd, 0);
+    struct stat status{};
+    ASSERT_EQ(::fstat(fd, &status), 0);
+    ::close(fd);
+    EXPECT_EQ(status.st_mode & 0777U, 0600U);
+}
+
+}  // namespace cayene::test
@@ -0,0 +1,120 @@
+/**
+ * @file spsc_ring_test.cpp
+ * @brief Unit tests for the single-producer/single-consumer ring
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <cstdint>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "cayene/spsc_ring.hpp"
+
+namespace cayene::test
+{
+
+TEST(SpscRingTest, RoundsCapacityUp)
+{
+    EXPECT_EQ(SpscRing<int>(0).capacity(), 2U);
+    EXPECT_EQ(SpscRing<int>(5).capacity(), 8U);
+    EXPECT_EQ(SpscRing<int>(1024).capacity(), 1024U);
+}
+
+TEST(SpscRingTest, FifoUntilFull)
+{
+    SpscRing<int> ring(4);
+    EXPECT_EQ(ring.front(), nullptr);
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_TRUE(ring.try_push(i));
+    }
+    EXPECT_FALSE(ring.try_push(4));
+    EXPECT_EQ(ring.claim(), nullptr);
+    EXPECT_EQ(ring.size(), 4U);
+
+    ASSERT_NE(ring.front(), nullptr);
+    EXPECT_EQ(*ring.front(), 0);
+    ring.pop();
+    EXPECT_TRUE(ring.try_push(4));
+
+    for (int expected = 1; expected <= 4; ++expected)
+    {
+        ASSERT_NE(ring.front(), nullptr);
+        EXPECT_EQ(*ring.front(), expected);
+        ring.pop();
+    }
+    EXPECT_EQ(ring.front(), nullptr);
+    EXPECT_EQ(ring.size(), 0U);
+}
+
+TEST(SpscRingTest, KnownSizeFollowsTheCachedTail)
+{
+    SpscRing<int> ring(8);
+    EXPECT_TRUE(ring.try_push(1));
+    EXPECT_TRUE(ring.try_push(2));
+    EXPECT_EQ(ring.known_size(), 0U);
+
+    ASSERT_NE(ring.front(), nullptr);
+    EXPECT_EQ(ring.known_size(), 2U);
+
+    // Published after the consumer's last reload: a lower bound until the next one
+    EXPECT_TRUE(ring.try_push(3));
+    ring.pop();
+    EXPECT_EQ(ring.known_size(), 1U);
+    ring.pop();
+    ASSERT_NE(ring.front(), nullptr);
+    EXPECT_EQ(ring.known_size(), 1U);
+}
+
+TEST(SpscRingTest, ClaimFillsInPlace)
+{
+    SpscRing<int> ring(2);
+    int* slot = ring.claim();
+    ASSERT_NE(slot, nullptr);
+    *slot = 7;
+    // Not visible until published
+    EXPECT_EQ(ring.front(), nullptr);
+    ring.publish();
+    ASSERT_NE(ring.front(), nullptr);
+    EXPECT_EQ(*ring.front(), 7);
+}
+
+TEST(SpscRingTest, TransfersAcrossThreadsInOrder)
+{
+    constexpr std::uint64_t kCount = 200'000;
+    SpscRing<std::uint64_t> ring(64);
+
+    std::thread producer(
+        [&ring]()
+        {
+            for (std::uint64_t i = 0; i < kCount; ++i)
+            {
+                while (!ring.try_push(i))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+    std::uint64_t expected = 0;
+    bool ordered = true;
+    while (expected < kCount)
+    {
+        const std::uint64_t* value = ring.front();
+        if (value == nullptr)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ordered = ordered && *value == expected;
+        ++expected;
+        ring.pop();
+    }
+    producer.join();
+    EXPECT_TRUE(ordered);
+}
+
+}  // namespace cayene::test
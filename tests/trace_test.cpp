@@ -0,0 +1,291 @@
+/**
+ * @file trace_test.cpp
+ * @brief Unit tests for pipeline stage tracing and Chrome trace export
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include "cayene/trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <latch>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "cayene/decoder.hpp"
+#include "cayene/pipeline.hpp"
+
+namespace cayene::test
+{
+
+class TraceTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        trace::set_enabled(true);
+        trace::clear();
+    }
+
+    void TearDown() override
+    {
+        trace::set_enabled(true);
+        trace::clear();
+    }
+
+    static nlohmann::json dump()
+    {
+        std::ostringstream output;
+        trace::write_chrome_trace(output);
+        return nlohmann::json::parse(output.str());
+    }
+
+    static std::vector<nlohmann::json> spans(const nlohmann::json& document)
+    {
+        std::vector<nlohmann::json> result;
+        for (const auto& event : document["traceEvents"])
+        {
+            if (event["ph"] == "X")
+            {
+                result.push_back(event);
+            }
+        }
+        return result;
+    }
+};
+
+TEST_F(TraceTest, StageNames)
+{
+    EXPECT_STREQ(trace::stage_name(trace::Stage::Ingest), "ingest");
+    EXPECT_STREQ(trace::stage_name(trace::Stage::Base64Decode), "base64_decode");
+    EXPECT_STREQ(trace::stage_name(trace::Stage::LppDecode), "lpp_decode");
+    EXPECT_STREQ(trace::stage_name(trace::Stage::Serialize), "serialize");
+    EXPECT_STREQ(trace::stage_name(trace::Stage::SinkWrite), "sink_write");
+}
+
+TEST_F(TraceTest, EmptyTraceIsValidJson)
+{
+    auto document = dump();
+    EXPECT_TRUE(document.contains("traceEvents"));
+    EXPECT_TRUE(spans(document).empty());
+}
+
+TEST_F(TraceTest, RecordedSpanIsExported)
+{
+    trace::record(trace::Stage::SinkWrite, 5'000'123, 7'500'456);
+
+    auto events = spans(dump());
+    ASSERT_EQ(events.size(), 1U);
+    EXPECT_EQ(events[0]["name"], "sink_write");
+    EXPECT_EQ(events[0]["cat"], "cayene");
+    EXPECT_DOUBLE_EQ(events[0]["ts"].get<double>(), 5000.123);
+    EXPECT_DOUBLE_EQ(events[0]["dur"].get<double>(), 2500.333);
+}
+
+TEST_F(TraceTest, ScopedSpanRecordsDuration)
+{
+    {
+        const trace::ScopedSpan span(trace::Stage::Serialize);
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    auto events = spans(dump());
+    ASSERT_EQ(events.size(), 1U);
+    EXPECT_EQ(events[0]["name"], "serialize");
+    EXPECT_GE(events[0]["dur"].get<double>(), 50.0);
+}
+
+TEST_F(TraceTest, DisabledRecordsNothing)
+{
+    trace::set_enabled(false);
+    {
+        const trace::ScopedSpan span(trace::Stage::Ingest);
+    }
+    EXPECT_TRUE(spans(dump()).empty());
+}
+
+TEST_F(TraceTest, SpansFromMultipleThreadsUseDistinctTids)
+{
+    constexpr int kThreads = 4;
+    constexpr int kSpansPerThread = 100;
+
+    // Keep every thread alive until all have recorded, so none reuses another's buffer
+    std::latch recorded(kThreads);
+    std::vector<std::thread> threads;
+    threads.reserve(kThreads);
+    for (int i = 0; i < kThreads; ++i)
+    {
+        threads.emplace_back(
+            [&recorded]
+            {
+                for (int j = 0; j < kSpansPerThread; ++j)
+                {
+                    const trace::ScopedSpan span(trace::Stage::LppDecode);
+                }
+                recorded.arrive_and_wait();
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    auto events = spans(dump());
+    ASSERT_EQ(events.size(), static_cast<std::size_t>(kThreads * kSpansPerThread));
+
+    std::vector<std::uint32_t> tids;
+    for (const auto& event : events)
+    {
+        const auto tid = event["tid"].get<std::uint32_t>();
+        if (std::find(tids.begin(), tids.end(), tid) == tids.end())
+        {
+            tids.push_back(tid);
+        }
+    }
+    EXPECT_EQ(tids.size(), static_cast<std::size_t>(kThreads));
+}
+
+TEST_F(TraceTest, ExitedThreadBuffersAreReused)
+{
+    constexpr int kThreads = 16;
+
+    const auto buffer_count = [](const nlohmann::json& document)
+    {
+        return std::count_if(document["traceEvents"].begin(), document["traceEvents"].end(),
+                             [](const nlohmann::json& event) { return event["ph"] == "M"; });
+    };
+
+    std::thread([] { trace::record(trace::Stage::Ingest, 1000, 2000); }).join();
+    const auto buffers_before = buffer_count(dump());
+
+    for (int i = 0; i < kThreads; ++i)
+    {
+        std::thread([] { trace::record(trace::Stage::Ingest, 1000, 2000); }).join();
+    }
+
+    const auto document = dump();
+    EXPECT_EQ(buffer_count(document), buffers_before);
+    auto events = spans(document);
+    ASSERT_EQ(events.size(), static_cast<std::size_t>(kThreads + 1));
+    for (const auto& event : events)
+    {
+        EXPECT_EQ(event["tid"], events.front()["tid"]);
+    }
+}
+
+TEST_F(TraceTest, RingKeepsMostRecentSpans)
+{
+    const std::size_t total = trace::kThreadBufferCapacity + 10;
+    for (std::size_t i = 0; i < total; ++i)
+    {
+        trace::record(trace::Stage::Ingest, 1000 * (i + 1), (1000 * (i + 1)) + 1);
+    }
+
+    auto events = spans(dump());
+    ASSERT_EQ(events.size(), trace::kThreadBufferCapacity);
+    EXPECT_DOUBLE_EQ(events.front()["ts"].get<double>(), 11.0);
+}
+
+#ifdef CAYENE_ENABLE_TRACING
+TEST_F(TraceTest, DecoderRecordsLppDecodeSpan)
+{
+    Decoder decoder;
+    std::vector<std::uint8_t> payload = {0x01, 0x67, 0x01, 0x10};
+    Json result;
+    static_cast<void>(decoder.try_decode(payload, result));
+
+    auto events = spans(dump());
+    ASSERT_EQ(events.size(), 1U);
+    EXPECT_EQ(events[0]["name"], "lpp_decode");
+}
+
+TEST_F(TraceTest, WriteJsonRecordsSerializeSpan)
+{
+    Decoder decoder;
+    const std::vector<std::uint8_t> payload = {0x01, 0x67, 0x01, 0x10};
+    std::array<char, 256> text{};
+    ASSERT_TRUE(decoder.write_json(payload, text));
+
+    auto events = spans(dump());
+    ASSERT_EQ(events.size(), 1U);
+    EXPECT_EQ(events[0]["name"], "serialize");
+}
+
+TEST_F(TraceTest, PipelineRecordsIngestAndSinkSpans)
+{
+    Decoder decoder;
+    CountingSink sink(1);
+    Pipeline pipeline(decoder, sink);
+    pipeline.start();
+    const std::vector<std::uint8_t> payload = {0x01, 0x67, 0x01, 0x10};
+    ASSERT_EQ(pipeline.producer(0).submit(7, 0, payload), SubmitStatus::Accepted);
+    pipeline.stop();
+
+    std::vector<std::string> names;
+    for (const auto& event : spans(dump()))
+    {
+        names.push_back(event["name"].get<std::string>());
+    }
+    std::sort(names.begin(), names.end());
+    EXPECT_EQ(names, (std::vector<std::string>{"ingest", "lpp_decode", "sink_write"}));
+}
+
+TEST_F(TraceTest, BackpressureRecordsOneIngestSpanPerSubmission)
+{
+    // Holds the worker in its first consume() until released
+    class GateSink final : public PipelineSink
+    {
+    public:
+        void consume(std::size_t /*worker*/, const DecodedPayload& /*result*/) override
+        {
+            while (!open.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        std::atomic<bool> open{false};
+    };
+
+    Decoder decoder;
+    GateSink sink;
+    PipelineConfig config;
+    config.ring_capacity = 2;
+    Pipeline pipeline(decoder, sink, config);
+    pipeline.start();
+    std::thread opener(
+        [&sink]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            sink.open.store(true, std::memory_order_release);
+        });
+    const std::vector<std::uint8_t> payload = {0x01, 0x67, 0x01, 0x10};
+    constexpr std::size_t kSubmissions = 8;
+    for (std::size_t i = 0; i < kSubmissions; ++i)
+    {
+        ASSERT_EQ(pipeline.producer(0).submit(7, i, payload), SubmitStatus::Accepted);
+    }
+    opener.join();
+    pipeline.stop();
+    EXPECT_GT(pipeline.stats().backpressure, 0U);
+
+    const auto events = spans(dump());
+    const auto ingest = std::count_if(events.begin(), events.end(),
+                                      [](const nlohmann::json& event)
+                                      { return event["name"] == "ingest"; });
+    EXPECT_EQ(static_cast<std::size_t>(ingest), kSubmissions);
+}
+#endif
+
+}  // namespace cayene::test
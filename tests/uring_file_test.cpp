@@ -0,0 +1,218 @@
+/**
+ * @file uring_file_test.cpp
+ * @brief Unit tests for the io_uring file reader, writer and JSON lines sink
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cayene/archive.hpp"
+#include "cayene/uring_file.hpp"
+
+namespace cayene::test
+{
+
+// Parameter: whether io_uring may be used (false exercises the pread/pwrite path)
+class UringFileTest : public ::testing::TestWithParam<bool>
+{
+protected:
+    void SetUp() override
+    {
+        path_ = ::testing::TempDir() + "cayene_uring_" + std::to_string(::getpid());
+        small_.use_io_uring = GetParam();
+    }
+
+    void TearDown() override { ::unlink(path_.c_str()); }
+
+    std::string read_back() const
+    {
+        std::ifstream file(path_, std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+    std::string path_;
+    UringConfig small_{4, 4096};  // Many buffers per file, exercising refills
+};
+
+TEST_P(UringFileTest, WritesAndReadsBackInOrder)
+{
+    std::vector<std::uint8_t> data(4096 * 9 + 123);
+    for (std::size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<std::uint8_t>((i * 31) ^ (i >> 8));
+    }
+
+    {
+        auto writer = UringFileWriter::create(path_, small_);
+        ASSERT_TRUE(writer.has_value());
+        if (!GetParam())
+        {
+            EXPECT_FALSE(writer->uses_io_uring());
+        }
+        // Odd-sized writes straddle buffer boundaries
+        for (std::size_t offset = 0; offset < data.size(); offset += 1000)
+        {
+            const std::size_t size = std::min<std::size_t>(1000, data.size() - offset);
+            ASSERT_TRUE(writer->write(std::span(data).subspan(offset, size)));
+        }
+        EXPECT_EQ(writer->bytes_written(), data.size());
+        ASSERT_TRUE(writer->flush());
+    }
+
+    auto reader = UringFileReader::open(path_, small_);
+    ASSERT_TRUE(reader.has_value());
+    EXPECT_EQ(reader->file_size(), data.size());
+
+    std::vector<std::uint8_t> read;
+    std::vector<std::size_t> chunk_sizes;
+    ASSERT_TRUE(reader->read_all(
+        [&](std::span<const std::uint8_t> chunk)
+        {
+            chunk_sizes.push_back(chunk.size());
+            read.insert(read.end(), chunk.begin(), chunk.end());
+        }));
+    EXPECT_EQ(read, data);
+    ASSERT_EQ(chunk_sizes.size(), 10U);
+    EXPECT_EQ(chunk_sizes.front(), 4096U);
+    EXPECT_EQ(chunk_sizes.back(), 123U);
+
+    // A second pass reads the same data again
+    std::size_t total = 0;
+    ASSERT_TRUE(
+        reader->read_all([&](std::span<const std::uint8_t> chunk) { total += chunk.size(); }));
+    EXPECT_EQ(total, data.size());
+}
+
+#ifndef CAYENE_NO_EXCEPTIONS
+TEST_P(UringFileTest, ThrowingCallbackLeavesNoReadsInFlight)
+{
+    std::vector<std::uint8_t> data(4096 * 6);
+    for (std::size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<std::uint8_t>(i / 4096);
+    }
+    {
+        auto writer = UringFileWriter::create(path_, small_);
+        ASSERT_TRUE(writer.has_value());
+        ASSERT_TRUE(writer->write(data));
+    }
+
+    auto reader = UringFileReader::open(path_, small_);
+    ASSERT_TRUE(reader.has_value());
+    const auto stop = [](std::span<const std::uint8_t>) { throw std::runtime_error("stop"); };
+    EXPECT_THROW(reader->read_all(stop), std::runtime_error);
+
+    // The abandoned reads must not be taken for those of the next pass
+    std::vector<std::uint8_t> read;
+    ASSERT_TRUE(reader->read_all([&](std::span<const std::uint8_t> chunk)
+                                 { read.insert(read.end(), chunk.begin(), chunk.end()); }));
+    EXPECT_EQ(read, data);
+}
+#endif
+
+TEST_P(UringFileTest, EmptyAndMissingFiles)
+{
+    {
+        auto writer = UringFileWriter::create(path_, small_);
+        ASSERT_TRUE(writer.has_value());
+        EXPECT_TRUE(writer->flush());
+    }
+    auto reader = UringFileReader::open(path_, small_);
+    ASSERT_TRUE(reader.has_value());
+    EXPECT_TRUE(reader->read_all([](std::span<const std::uint8_t>) { FAIL(); }));
+
+    EXPECT_FALSE(UringFileReader::open(path_ + ".missing").has_value());
+    EXPECT_EQ(errno, ENOENT);
+    EXPECT_FALSE(UringFileWriter::create("/nonexistent-dir/archive").has_value());
+}
+
+TEST_P(UringFileTest, ArchiveReplayThroughPipelineToJsonLines)
+{
+    // Archive with one good and one truncated payload per device
+    std::vector<std::uint8_t> archive;
+    const std::vector<std::uint8_t> good = {0x01, 0x67, 0x01, 0x10};
+    const std::vector<std::uint8_t> bad = {0x01, 0x67, 0x01};
+    for (std::uint32_t device = 0; device < 500; ++device)
+    {
+        append_archive_entry(archive, device, 1000 + device, good);
+        append_archive_entry(archive, device, 2000 + device, bad);
+    }
+    {
+        auto writer = UringFileWriter::create(path_, small_);
+        ASSERT_TRUE(writer.has_value());
+        ASSERT_TRUE(writer->write(archive));
+    }
+    ASSERT_EQ(read_back(), std::string(archive.begin(), archive.end()));
+
+    const std::string output = path_ + ".jsonl";
+    {
+        Decoder decoder;
+        auto reader = UringFileReader::open(path_, small_);
+        auto writer = UringFileWriter::create(output, small_);
+        ASSERT_TRUE(reader.has_value() && writer.has_value());
+
+        JsonLinesSink sink(decoder, *writer, 2);
+        PipelineConfig config;
+        config.workers = 2;
+        Pipeline pipeline(decoder, sink, config);
+        pipeline.start();
+
+        ArchiveParser parser;
+        ASSERT_TRUE(reader->read_all(
+            [&](std::span<const std::uint8_t> chunk)
+            {
+                parser.feed(chunk,
+                            [&](const PayloadRef& ref)
+                            {
+                                pipeline.producer(0).submit(ref.device, ref.timestamp,
+                                                            ref.payload);
+                            });
+            }));
+        EXPECT_TRUE(parser.finish());
+        EXPECT_EQ(parser.entries(), 1000U);
+
+        pipeline.stop();
+        EXPECT_TRUE(sink.ok());
+        ASSERT_TRUE(writer->flush());
+    }
+
+    std::ifstream lines(output);
+    std::string line;
+    std::size_t good_lines = 0;
+    std::size_t error_lines = 0;
+    while (std::getline(lines, line))
+    {
+        if (line.find("\"data\":{\"Temperature_1\":27.2}") != std::string::npos)
+        {
+            ++good_lines;
+        }
+        else if (line.find("\"error\":") != std::string::npos)
+        {
+            ++error_lines;
+        }
+    }
+    EXPECT_EQ(good_lines, 500U);
+    EXPECT_EQ(error_lines, 500U);
+    ::unlink(output.c_str());
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, UringFileTest, ::testing::Bool(),
+                         [](const ::testing::TestParamInfo<bool>& param_info)
+                         { return param_info.param ? "IoUring" : "Fallback"; });
+
+}  // namespace cayene::test
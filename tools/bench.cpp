@@ -0,0 +1,176 @@
+/**
+ * @file bench.cpp
+ * @brief Decode throughput benchmark over a generated payload corpus
+ *
+ * Runs every output mode over the same corpus and reports nanoseconds per
+ * payload and throughput. This is also the training workload for the PGO
+ * presets (see the cayene_pgo_train target).
+ *
+ * Usage: cayene_bench [--payloads N] [--iterations N] [--mode MODE]
+ *        MODE is one of json, gps, flat, dump, writer, records, validate or all
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cayene/decoder.hpp"
+#include "corpus.hpp"
+
+namespace
+{
+
+struct Options
+{
+    std::size_t payloads{10000};
+    std::size_t iterations{50};
+    std::string mode{"all"};
+};
+
+struct Mode
+{
+    std::string_view name;
+    std::function<std::size_t(cayene::Decoder&, std::span<const std::uint8_t>)> run;
+};
+
+Options parse_options(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string_view flag = argv[i];
+        const std::string value = argv[i + 1];
+        if (flag == "--payloads")
+        {
+            options.payloads = std::stoul(value);
+        }
+        else if (flag == "--iterations")
+        {
+            options.iterations = std::stoul(value);
+        }
+        else if (flag == "--mode")
+        {
+            options.mode = value;
+        }
+        else
+        {
+            std::cerr << "Unknown option: " << flag << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return options;
+}
+
+std::vector<Mode> modes()
+{
+    return {
+        {"json",
+         [](cayene::Decoder& decoder, std::span<const std::uint8_t> payload)
+         {
+             cayene::Json result;
+             decoder.try_decode(payload, result);
+             return result.size();
+         }},
+        {"gps",
+         [](cayene::Decoder& decoder, std::span<const std::uint8_t> payload)
+         {
+             // Projected JSON decode: only GPS records are materialized
+             static constexpr auto filter = cayene::RecordFilter::types({0x88});
+             cayene::Json result;
+             decoder.try_decode(payload, result, filter);
+             return result.size();
+         }},
+        {"flat",
+         [](cayene::Decoder& decoder, std::span<const std::uint8_t> payload)
+         {
+             cayene::FlatObject result;
+             decoder.decode_flat(payload, result);
+             return result.size();
+         }},
+        {"dump",
+         [](cayene::Decoder& decoder, std::span<const std::uint8_t> payload)
+         {
+             cayene::Json result;
+             decoder.try_decode(payload, result);
+             return result.dump().size();
+         }},
+        {"writer",
+         [](cayene::Decoder& decoder, std::span<const std::uint8_t> payload)
+         {
+             std::array<char, 1024> buffer{};
+             return decoder.write_json(payload, buffer).count;
+         }},
+        {"records",
+         [](cayene::Decoder& decoder, std::span<const std::uint8_t> payload)
+         {
+             std::array<cayene::Record, 32> records{};
+             return decoder.decode_records(payload, records).count;
+         }},
+        {"validate",
+         [](cayene::Decoder& decoder, std::span<const std::uint8_t> payload)
+         { return decoder.validate(payload).count; }},
+    };
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    const Options options = parse_options(argc, argv);
+    const auto corpus = cayene::tools::generate_corpus(options.payloads);
+
+    std::size_t corpus_bytes = 0;
+    for (const auto& entry : corpus)
+    {
+        corpus_bytes += entry.payload.size();
+    }
+
+    std::cout << "Corpus: " << corpus.size() << " payloads, " << corpus_bytes << " bytes, "
+              << options.iterations << " iterations\n\n";
+    std::cout << std::left << std::setw(10) << "mode" << std::right << std::setw(14)
+              << "ns/payload" << std::setw(16) << "payloads/s" << std::setw(12) << "MB/s"
+              << "\n";
+
+    cayene::Decoder decoder;
+    std::size_t checksum = 0;
+    for (const auto& mode : modes())
+    {
+        if (options.mode != "all" && options.mode != mode.name)
+        {
+            continue;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t iteration = 0; iteration < options.iterations; ++iteration)
+        {
+            for (const auto& entry : corpus)
+            {
+                checksum += mode.run(decoder, entry.payload);
+            }
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        const double decoded = static_cast<double>(corpus.size() * options.iterations);
+        const double bytes = static_cast<double>(corpus_bytes * options.iterations);
+        std::cout << std::left << std::setw(10) << mode.name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(14) << elapsed.count() * 1e9 / decoded
+                  << std::setprecision(0) << std::setw(16) << decoded / elapsed.count()
+                  << std::setprecision(1) << std::setw(12) << bytes / elapsed.count() / 1e6
+                  << "\n";
+    }
+
+    // Keeps the decode results observable so they cannot be optimized away
+    std::cout << "\nchecksum: " << checksum << "\n";
+    return 0;
+}
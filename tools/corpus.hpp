@@ -0,0 +1,118 @@
+#ifndef CAYENE_TOOLS_CORPUS_HPP
+#define CAYENE_TOOLS_CORPUS_HPP
+
+/**
+ * @file corpus.hpp
+ * @brief Deterministic synthetic payload corpus shared by the benchmark tools
+ *
+ * Payloads follow a handful of shapes seen on real deployments, with random
+ * channels and values, so runs (and PGO training) are reproducible.
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "cayene/detail/v1_definitions.hpp"
+
+namespace cayene::tools
+{
+
+/**
+ * @brief A payload shape: the ordered list of record types it carries
+ */
+struct PayloadShape
+{
+    std::string_view name;
+    std::span<const std::uint8_t> type_ids;
+};
+
+inline constexpr std::array<std::uint8_t, 1> kSingleTemperature = {0x67};
+inline constexpr std::array<std::uint8_t, 2> kEnvironment = {0x67, 0x68};
+inline constexpr std::array<std::uint8_t, 4> kWeather = {0x67, 0x68, 0x73, 0x65};
+inline constexpr std::array<std::uint8_t, 4> kTracker = {0x88, 0x71, 0x86, 0x67};
+inline constexpr std::array<std::uint8_t, 6> kIndustrial = {0x02, 0x02, 0x03, 0x00, 0x01, 0x66};
+
+inline constexpr std::array<PayloadShape, 5> kPayloadShapes = {{
+    {"single_temperature", kSingleTemperature},
+    {"environment", kEnvironment},
+    {"weather", kWeather},
+    {"tracker", kTracker},
+    {"industrial", kIndustrial},
+}};
+
+/**
+ * @brief One generated payload and the index of its shape in kPayloadShapes
+ */
+struct CorpusEntry
+{
+    std::size_t shape{0};
+    std::vector<std::uint8_t> payload;
+};
+
+/**
+ * @brief Size in bytes of a standard type's data, or 0 if unknown
+ */
+inline std::size_t standard_type_size(std::uint8_t type_id)
+{
+    static const auto types = definitions::get_v1_standard_data_types();
+    for (const auto& data_type : types)
+    {
+        if (data_type.type_id == type_id)
+        {
+            return data_type.size;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Generate a payload of the given shape with random channels and values
+ */
+inline std::vector<std::uint8_t> generate_payload(const PayloadShape& shape, std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<std::uint8_t> payload;
+    for (const std::uint8_t type_id : shape.type_ids)
+    {
+        payload.push_back(static_cast<std::uint8_t>(byte(rng)));
+        payload.push_back(type_id);
+        for (std::size_t i = 0; i < standard_type_size(type_id); ++i)
+        {
+            payload.push_back(static_cast<std::uint8_t>(byte(rng)));
+        }
+    }
+    return payload;
+}
+
+/**
+ * @brief Generate a corpus cycling uniformly through all payload shapes
+ *
+ * @param count Number of payloads
+ * @param seed Generator seed; equal seeds give equal corpora
+ */
+inline std::vector<CorpusEntry> generate_corpus(std::size_t count, std::uint32_t seed = 0xCA7E4E)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<std::size_t> shape_index(0, kPayloadShapes.size() - 1);
+
+    std::vector<CorpusEntry> corpus;
+    corpus.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const std::size_t shape = shape_index(rng);
+        corpus.push_back({shape, generate_payload(kPayloadShapes[shape], rng)});
+    }
+    return corpus;
+}
+
+}  // namespace cayene::tools
+
+#endif  // CAYENE_TOOLS_CORPUS_HPP
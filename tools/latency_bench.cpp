@@ -0,0 +1,375 @@
+/**
+ * @file latency_bench.cpp
+ * @brief Per-payload decode latency percentiles by payload shape and output mode
+ *
+ * Times every decode call on its own and reports mean, p50, p99, p99.9 and
+ * max per payload shape and output mode, so allocation spikes and other
+ * tail effects show up where an average hides them. Each mode gets one
+ * untimed warm-up pass; all samples are stored in buffers allocated before
+ * timing starts.
+ *
+ * Timestamps come from std::chrono::steady_clock (clock_gettime on Linux)
+ * or, with --clock tsc on x86-64, from the serialized time-stamp counter
+ * calibrated against it. The smallest back-to-back reading of the clock is
+ * printed as its overhead; it is included in every sample.
+ *
+ * Usage: cayene_latency_bench [--payloads N] [--iterations N] [--mode MODE]
+ *                             [--clock steady|tsc] [--cpu N] [--slo-us US]
+ *        MODE is one of json, dump, writer, records, flat or all
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#define CAYENE_HAVE_TSC 1
+#endif
+
+#include "cayene/affinity.hpp"
+#include "cayene/decoder.hpp"
+#include "corpus.hpp"
+
+namespace
+{
+
+struct Options
+{
+    std::size_t payloads{10000};
+    std::size_t iterations{20};
+    std::string mode{"all"};
+    bool tsc{false};
+    int cpu{-1};
+    double slo_us{20.0};
+};
+
+struct Mode
+{
+    std::string_view name;
+    std::function<std::size_t(cayene::Decoder&, std::span<const std::uint8_t>)> run;
+};
+
+Options parse_options(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i += 2)
+    {
+        const std::string_view flag = argv[i];
+        if (i + 1 == argc)
+        {
+            std::cerr << "Missing value for " << flag << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+        const std::string value = argv[i + 1];
+        if (flag == "--payloads")
+        {
+            options.payloads = std::stoul(value);
+        }
+        else if (flag == "--iterations")
+        {
+            options.iterations = std::stoul(value);
+        }
+        else if (flag == "--mode")
+        {
+            options.mode = value;
+        }
+        else if (flag == "--clock" && (value == "steady" || value == "tsc"))
+        {
+            options.tsc = value == "tsc";
+        }
+        else if (flag == "--cpu")
+        {
+            options.cpu = std::stoi(value);
+        }
+        else if (flag == "--slo-us")
+        {
+            options.slo_us = std::stod(value);
+        }
+        else
+        {
+            std::cerr << "Unknown option: " << flag << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+#ifndef CAYENE_HAVE_TSC
+    if (options.tsc)
+    {
+        std::cerr << "--clock tsc is only available on x86-64\n";
+        std::exit(EXIT_FAILURE);
+    }
+#endif
+    return options;
+}
+
+// The output modes of the decoder, as in cayene_bench
+std::vector<Mode> modes()
+{
+    return {
+        {"json",
+         [](cayene::Decoder& decoder, std::span<const std::uint8_t> payload)
+         {
+             cayene::Json result;
+             decoder.try_decode(payload, result);
+             return result.size();
+         }},
+        {"dump",
+         [](cayene::Decoder& decoder, std::span<const std::uint8_t> payload)
+         {
+             cayene::Json result;
+             decoder.try_decode(payload, result);
+             return result.dump().size();
+         }},
+        {"writer",
+         [](cayene::Decoder& decoder, std::span<const std::uint8_t> payload)
+         {
+             std::array<char, 1024> buffer{};
+             return decoder.write_json(payload, buffer).count;
+         }},
+        {"records",
+         [](cayene::Decoder& decoder, std::span<const std::uint8_t> payload)
+         {
+             std::array<cayene::Record, 32> records{};
+             return decoder.decode_records(payload, records).count;
+         }},
+        {"flat",
+         [](cayene::Decoder& decoder, std::span<const std::uint8_t> payload)
+         {
+             cayene::FlatObject result;
+             decoder.decode_flat(payload, result);
+             return result.size();
+         }},
+    };
+}
+
+/**
+ * @brief Monotonic timestamps in ticks, and their length in nanoseconds
+ */
+class Clock
+{
+public:
+    explicit Clock(bool tsc) : tsc_(tsc)
+    {
+        if (tsc_)
+        {
+            calibrate();
+        }
+    }
+
+    [[nodiscard]] std::uint64_t now() const noexcept
+    {
+#ifdef CAYENE_HAVE_TSC
+        if (tsc_)
+        {
+            // lfence keeps the read from moving across the timed code
+            _mm_lfence();
+            const std::uint64_t ticks = __rdtsc();
+            _mm_lfence();
+            return ticks;
+        }
+#endif
+        return static_cast<std::uint64_t>(
+            std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+
+    [[nodiscard]] double to_ns(std::uint64_t ticks) const noexcept
+    {
+        return static_cast<double>(ticks) * ns_per_tick_;
+    }
+
+    /**
+     * @brief Smallest difference between two back-to-back readings, in nanoseconds
+     */
+    [[nodiscard]] double overhead_ns() const noexcept
+    {
+        std::uint64_t best = UINT64_MAX;
+        for (int i = 0; i < 10000; ++i)
+        {
+            const std::uint64_t start = now();
+            best = std::min(best, now() - start);
+        }
+        return to_ns(best);
+    }
+
+    [[nodiscard]] std::string_view name() const noexcept
+    {
+        return tsc_ ? "rdtsc" : "steady_clock";
+    }
+
+private:
+    void calibrate()
+    {
+        const auto wall_start = std::chrono::steady_clock::now();
+        const std::uint64_t start = now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        const std::uint64_t ticks = now() - start;
+        const std::chrono::duration<double, std::nano> wall =
+            std::chrono::steady_clock::now() - wall_start;
+        ns_per_tick_ = wall.count() / static_cast<double>(ticks);
+    }
+
+    bool tsc_;
+    double ns_per_tick_{
+        1e9 * std::chrono::steady_clock::period::num / std::chrono::steady_clock::period::den};
+};
+
+/**
+ * @brief Latency summary of one set of samples, in nanoseconds
+ */
+struct Summary
+{
+    std::size_t samples{0};
+    double mean{0.0};
+    double p50{0.0};
+    double p99{0.0};
+    double p999{0.0};
+    double max{0.0};
+};
+
+// Nearest-rank percentiles; sorts the samples in place
+Summary summarize(std::vector<double>& samples)
+{
+    Summary summary;
+    summary.samples = samples.size();
+    if (samples.empty())
+    {
+        return summary;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double fraction)
+    {
+        const auto rank = static_cast<std::size_t>(
+            std::ceil(fraction * static_cast<double>(samples.size())));
+        return samples[std::clamp<std::size_t>(rank, 1, samples.size()) - 1];
+    };
+    summary.mean = std::accumulate(samples.begin(), samples.end(), 0.0) /
+                   static_cast<double>(samples.size());
+    summary.p50 = percentile(0.50);
+    summary.p99 = percentile(0.99);
+    summary.p999 = percentile(0.999);
+    summary.max = samples.back();
+    return summary;
+}
+
+void print_row(std::string_view mode, std::string_view shape, const Summary& summary)
+{
+    std::cout << std::left << std::setw(9) << mode << std::setw(20) << shape << std::right
+              << std::setw(9) << summary.samples << std::fixed << std::setprecision(0)
+              << std::setw(9) << summary.mean << std::setw(9) << summary.p50 << std::setw(9)
+              << summary.p99 << std::setw(10) << summary.p999 << std::setw(10) << summary.max
+              << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    const Options options = parse_options(argc, argv);
+    const std::vector<Mode> all_modes = modes();
+    if (options.mode != "all" &&
+        std::none_of(all_modes.begin(), all_modes.end(),
+                     [&options](const Mode& mode) { return mode.name == options.mode; }))
+    {
+        std::cerr << "Unknown mode: " << options.mode << "\n";
+        return EXIT_FAILURE;
+    }
+
+    if (options.cpu >= 0)
+    {
+        const std::array<unsigned, 1> cpu = {static_cast<unsigned>(options.cpu)};
+        if (!cayene::pin_current_thread(cpu))
+        {
+            std::cerr << "Could not pin to CPU " << options.cpu << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto corpus = cayene::tools::generate_corpus(options.payloads);
+    const Clock clock(options.tsc);
+    const auto& shapes = cayene::tools::kPayloadShapes;
+
+    std::array<std::size_t, shapes.size()> per_shape{};
+    for (const auto& entry : corpus)
+    {
+        ++per_shape[entry.shape];
+    }
+
+    std::cout << "Corpus: " << corpus.size() << " payloads, " << options.iterations
+              << " iterations, clock " << clock.name() << " (overhead " << std::fixed
+              << std::setprecision(1) << clock.overhead_ns() << " ns)\n\n";
+    std::cout << std::left << std::setw(9) << "mode" << std::setw(20) << "shape" << std::right
+              << std::setw(9) << "samples" << std::setw(9) << "mean" << std::setw(9) << "p50"
+              << std::setw(9) << "p99" << std::setw(10) << "p99.9" << std::setw(10) << "max"
+              << "   (ns)\n";
+
+    cayene::Decoder decoder;
+    std::size_t checksum = 0;
+    bool slo_met = true;
+    for (const auto& mode : all_modes)
+    {
+        if (options.mode != "all" && options.mode != mode.name)
+        {
+            continue;
+        }
+
+        for (const auto& entry : corpus)
+        {
+            checksum += mode.run(decoder, entry.payload);
+        }
+
+        // Raw ticks go into buffers sized up front, so timing allocates nothing of its own
+        std::vector<std::vector<std::uint64_t>> ticks(shapes.size());
+        for (std::size_t shape = 0; shape < shapes.size(); ++shape)
+        {
+            ticks[shape].reserve(per_shape[shape] * options.iterations);
+        }
+        for (std::size_t iteration = 0; iteration < options.iterations; ++iteration)
+        {
+            for (const auto& entry : corpus)
+            {
+                const std::uint64_t start = clock.now();
+                checksum += mode.run(decoder, entry.payload);
+                ticks[entry.shape].push_back(clock.now() - start);
+            }
+        }
+
+        std::vector<double> all;
+        all.reserve(corpus.size() * options.iterations);
+        for (std::size_t shape = 0; shape < shapes.size(); ++shape)
+        {
+            std::vector<double> samples;
+            samples.reserve(ticks[shape].size());
+            for (const std::uint64_t sample : ticks[shape])
+            {
+                samples.push_back(clock.to_ns(sample));
+            }
+            all.insert(all.end(), samples.begin(), samples.end());
+            print_row(mode.name, shapes[shape].name, summarize(samples));
+        }
+        const Summary total = summarize(all);
+        print_row(mode.name, "all", total);
+        std::cout << "\n";
+        slo_met = slo_met && total.p999 <= options.slo_us * 1000.0;
+    }
+
+    std::cout << "p99.9 <= " << std::setprecision(1) << options.slo_us
+              << " us in every mode: " << (slo_met ? "yes" : "NO") << "\n";
+    // Keeps the decode results observable so they cannot be optimized away
+    std::cout << "checksum: " << checksum << "\n";
+    return slo_met ? EXIT_SUCCESS : 2;
+}
@@ -0,0 +1,211 @@
+/**
+ * @file pipeline_bench.cpp
+ * @brief End-to-end throughput benchmark of the sharded ingest pipeline
+ *
+ * Each producer thread replays its slice of a generated corpus (one device
+ * per payload index) into the pipeline with blocking submits; the workers
+ * decode into records and count them. Reports payloads per second, how
+ * often producers were held back by full rings and the load of each worker.
+ *
+ * --pin node|core pins the workers and producers across the NUMA nodes;
+ * --local on additionally has each producer submit only the devices
+ * decoded on its own node, so no payload crosses a socket.
+ *
+ * Usage: cayene_pipeline_bench [--payloads N] [--iterations N] [--producers N]
+ *                              [--workers N] [--ring N] [--pin none|node|core]
+ *                              [--local on|off]
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "cayene/pipeline.hpp"
+#include "corpus.hpp"
+
+namespace
+{
+
+struct Options
+{
+    std::size_t payloads{10000};
+    std::size_t iterations{50};
+    std::size_t producers{1};
+    std::size_t workers{std::max(1U, std::thread::hardware_concurrency() / 2)};
+    std::size_t ring{1024};
+    cayene::CpuPlacement pin{cayene::CpuPlacement::None};
+    bool local{false};
+};
+
+Options parse_options(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string_view flag = argv[i];
+        const std::string value = argv[i + 1];
+        if (flag == "--payloads")
+        {
+            options.payloads = std::stoul(value);
+        }
+        else if (flag == "--iterations")
+        {
+            options.iterations = std::stoul(value);
+        }
+        else if (flag == "--producers")
+        {
+            options.producers = std::stoul(value);
+        }
+        else if (flag == "--workers")
+        {
+            options.workers = std::stoul(value);
+        }
+        else if (flag == "--ring")
+        {
+            options.ring = std::stoul(value);
+        }
+        else if (flag == "--pin" && (value == "none" || value == "node" || value == "core"))
+        {
+            options.pin = value == "none"   ? cayene::CpuPlacement::None
+                          : value == "node" ? cayene::CpuPlacement::Node
+                                            : cayene::CpuPlacement::Core;
+        }
+        else if (flag == "--local" && (value == "on" || value == "off"))
+        {
+            options.local = value == "on";
+        }
+        else
+        {
+            std::cerr << "Unknown option: " << flag << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return options;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    const Options options = parse_options(argc, argv);
+    const auto corpus = cayene::tools::generate_corpus(options.payloads);
+
+    cayene::PipelineConfig config;
+    config.producers = options.producers;
+    config.workers = options.workers;
+    config.ring_capacity = options.ring;
+    config.placement = options.pin;
+
+    cayene::Decoder decoder;
+    cayene::CountingSink sink(config.workers);
+    cayene::Pipeline pipeline(decoder, sink, config);
+
+    std::cout << "Corpus: " << corpus.size() << " payloads, " << options.iterations
+              << " iterations, " << pipeline.producer_count() << " producers, "
+              << pipeline.worker_count() << " workers, ring " << config.ring_capacity << "\n";
+    if (options.pin != cayene::CpuPlacement::None)
+    {
+        std::cout << "Placement:  " << pipeline.topology().node_count() << " node(s), "
+                  << (options.pin == cayene::CpuPlacement::Node ? "node" : "core") << " pinning"
+                  << (options.local ? ", node-local submission" : "") << "\n";
+    }
+    std::cout << "\n";
+    if (options.local && pipeline.producer_count() < pipeline.topology().node_count())
+    {
+        std::cerr << "--local needs at least one producer per node\n";
+        return EXIT_FAILURE;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    pipeline.start();
+    std::vector<std::thread> producers;
+    for (std::size_t p = 0; p < pipeline.producer_count(); ++p)
+    {
+        producers.emplace_back(
+            [&, p]()
+            {
+                auto& producer = pipeline.producer(p);
+                if (options.pin != cayene::CpuPlacement::None)
+                {
+                    producer.pin();
+                }
+                // Without --local, producer p takes every P-th device. With it,
+                // the producers of a node share that node's devices instead.
+                std::size_t rank = p;
+                std::size_t stride = pipeline.producer_count();
+                if (options.local)
+                {
+                    rank = 0;
+                    stride = 0;
+                    for (std::size_t q = 0; q < pipeline.producer_count(); ++q)
+                    {
+                        if (pipeline.producer(q).node() == producer.node())
+                        {
+                            rank += q < p ? 1 : 0;
+                            ++stride;
+                        }
+                    }
+                }
+                std::vector<std::size_t> devices;
+                std::size_t seen = 0;
+                for (std::size_t i = 0; i < corpus.size(); ++i)
+                {
+                    const auto device = static_cast<std::uint32_t>(i);
+                    if (options.local && pipeline.node_of(device) != producer.node())
+                    {
+                        continue;
+                    }
+                    if (seen++ % stride == rank)
+                    {
+                        devices.push_back(i);
+                    }
+                }
+                for (std::size_t iteration = 0; iteration < options.iterations; ++iteration)
+                {
+                    for (const std::size_t i : devices)
+                    {
+                        producer.submit(static_cast<std::uint32_t>(i), iteration,
+                                        corpus[i].payload);
+                    }
+                }
+            });
+    }
+    for (std::thread& producer : producers)
+    {
+        producer.join();
+    }
+    pipeline.stop();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const cayene::PipelineStats stats = pipeline.stats();
+    const double decoded = static_cast<double>(stats.decoded);
+    std::cout << std::fixed << std::setprecision(1)
+              << "ns/payload:   " << elapsed.count() * 1e9 / decoded << "\n"
+              << std::setprecision(0) << "payloads/s:   " << decoded / elapsed.count() << "\n"
+              << "records:      " << sink.records() << "\n"
+              << "failures:     " << sink.failures() << "\n"
+              << "backpressure: " << stats.backpressure << " waits\n"
+              << "unpinned:     " << stats.unpinned << " workers\n";
+
+    const cayene::PartitionSkew skew = pipeline.skew();
+    std::cout << std::setprecision(2) << "imbalance:    " << skew.imbalance << " (max / mean)\n";
+    for (std::size_t worker = 0; worker < skew.workers.size(); ++worker)
+    {
+        const cayene::WorkerLoad& load = skew.workers[worker];
+        std::cout << "worker " << worker << ":     " << load.decoded << " payloads, peak backlog "
+                  << load.peak_queued << ", top device " << load.top_device
+                  << (load.hot ? "  HOT" : "") << "\n";
+    }
+    return 0;
+}
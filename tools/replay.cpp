@@ -0,0 +1,238 @@
+/**
+ * @file replay.cpp
+ * @brief Archive generator and replay/export tool
+ *
+ * --generate writes an archive of the benchmark corpus; otherwise an
+ * archive is read through a UringFileReader, decoded by the pipeline and,
+ * with --output, exported as JSON lines through a UringFileWriter.
+ * Reports read/decode/write throughput and the I/O path in use.
+ *
+ * Usage: cayene_replay --generate N --archive FILE
+ *        cayene_replay --archive FILE [--output FILE] [--workers N] [--depth N]
+ *                      [--buffer-kib N] [--io uring|sync]
+ *
+ * This library is licensed under the GNU General Public License v2 (GPLv2).
+ * See LICENSE file for details.
+ */
+
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "cayene/archive.hpp"
+#include "cayene/pipeline.hpp"
+#include "cayene/uring_file.hpp"
+#include "corpus.hpp"
+
+namespace
+{
+
+struct Options
+{
+    std::size_t generate{0};
+    std::string archive;
+    std::string output;
+    std::size_t workers{1};
+    cayene::UringConfig io;
+};
+
+[[noreturn]] void usage_error(std::string_view message, std::string_view flag)
+{
+    std::cerr << message << flag << "\n";
+    std::exit(EXIT_FAILURE);
+}
+
+// The whole value must be a number that fits, scaled by unit
+std::size_t parse_count(std::string_view flag, std::string_view value, std::size_t unit = 1)
+{
+    std::size_t count = 0;
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), count);
+    if (error != std::errc() || end != value.data() + value.size() || value.empty() ||
+        count > std::numeric_limits<std::size_t>::max() / unit)
+    {
+        usage_error("Invalid value for ", flag);
+    }
+    return count * unit;
+}
+
+Options parse_options(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i += 2)
+    {
+        const std::string_view flag = argv[i];
+        if (i + 1 == argc)
+        {
+            usage_error("Missing value for ", flag);
+        }
+        const std::string value = argv[i + 1];
+        if (flag == "--generate")
+        {
+            options.generate = parse_count(flag, value);
+        }
+        else if (flag == "--archive")
+        {
+            options.archive = value;
+        }
+        else if (flag == "--output")
+        {
+            options.output = value;
+        }
+        else if (flag == "--workers")
+        {
+            options.workers = parse_count(flag, value);
+        }
+        else if (flag == "--depth")
+        {
+            options.io.queue_depth = parse_count(flag, value);
+        }
+        else if (flag == "--buffer-kib")
+        {
+            options.io.buffer_size = parse_count(flag, value, 1024);
+        }
+        else if (flag == "--io")
+        {
+            if (value != "uring" && value != "sync")
+            {
+                usage_error("Invalid value for ", flag);
+            }
+            options.io.use_io_uring = value == "uring";
+        }
+        else
+        {
+            usage_error("Unknown option: ", flag);
+        }
+    }
+    if (options.archive.empty())
+    {
+        std::cerr << "--archive is required\n";
+        std::exit(EXIT_FAILURE);
+    }
+    return options;
+}
+
+[[noreturn]] void fail(const std::string& what)
+{
+    std::cerr << what << ": " << std::strerror(errno) << "\n";
+    std::exit(EXIT_FAILURE);
+}
+
+const char* backend(bool io_uring) { return io_uring ? "io_uring" : "pread/pwrite"; }
+
+int generate(const Options& options)
+{
+    auto writer = cayene::UringFileWriter::create(options.archive, options.io);
+    if (!writer)
+    {
+        fail("cannot create " + options.archive);
+    }
+
+    const auto corpus = cayene::tools::generate_corpus(10000);
+    writer->write(cayene::kArchiveMagic);
+    for (std::size_t i = 0; i < options.generate; ++i)
+    {
+        const auto& payload = corpus[i % corpus.size()].payload;
+        const auto header = cayene::encode_archive_entry_header(
+            static_cast<std::uint32_t>(i % 50'000), 1'700'000'000'000ULL + i,
+            static_cast<std::uint16_t>(payload.size()));
+        writer->write(header);
+        writer->write(payload);
+    }
+    if (!writer->flush())
+    {
+        fail("cannot write " + options.archive);
+    }
+    std::cout << "Wrote " << options.generate << " payloads, " << writer->bytes_written()
+              << " bytes (" << backend(writer->uses_io_uring()) << ")\n";
+    return 0;
+}
+
+int replay(const Options& options)
+{
+    auto reader = cayene::UringFileReader::open(options.archive, options.io);
+    if (!reader)
+    {
+        fail("cannot open " + options.archive);
+    }
+    std::optional<cayene::UringFileWriter> writer;
+    if (!options.output.empty())
+    {
+        writer = cayene::UringFileWriter::create(options.output, options.io);
+        if (!writer)
+        {
+            fail("cannot create " + options.output);
+        }
+    }
+
+    cayene::Decoder decoder;
+    cayene::CountingSink counting(options.workers);
+    std::unique_ptr<cayene::JsonLinesSink> json;
+    cayene::PipelineSink* sink = &counting;
+    if (writer)
+    {
+        json = std::make_unique<cayene::JsonLinesSink>(decoder, *writer, options.workers);
+        sink = json.get();
+    }
+
+    cayene::PipelineConfig config;
+    config.workers = options.workers;
+    cayene::Pipeline pipeline(decoder, *sink, config);
+    cayene::ArchiveParser parser;
+
+    const auto start = std::chrono::steady_clock::now();
+    pipeline.start();
+    const bool read = reader->read_all(
+        [&](std::span<const std::uint8_t> chunk)
+        {
+            parser.feed(chunk,
+                        [&](const cayene::PayloadRef& ref)
+                        { pipeline.producer(0).submit(ref.device, ref.timestamp, ref.payload); });
+        });
+    pipeline.stop();
+    if (!read)
+    {
+        fail("cannot read " + options.archive);
+    }
+    if (writer && (!json->ok() || !writer->flush()))
+    {
+        fail("cannot write " + options.output);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const cayene::PipelineStats stats = pipeline.stats();
+    const double seconds = elapsed.count();
+    std::cout << "I/O:          " << backend(reader->uses_io_uring()) << ", depth "
+              << options.io.queue_depth << " x " << options.io.buffer_size / 1024 << " KiB\n"
+              << "archive:      " << reader->file_size() << " bytes, " << parser.entries()
+              << " payloads" << (parser.finish() ? "" : " (truncated)") << "\n"
+              << std::fixed << std::setprecision(1)
+              << "read MB/s:    " << static_cast<double>(reader->file_size()) / seconds / 1e6
+              << "\n"
+              << std::setprecision(0)
+              << "payloads/s:   " << static_cast<double>(stats.decoded) / seconds << "\n"
+              << "failed:       " << stats.failed << "\n";
+    if (writer)
+    {
+        std::cout << "written:      " << writer->bytes_written() << " bytes\n";
+    }
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    const Options options = parse_options(argc, argv);
+    return options.generate != 0 ? generate(options) : replay(options);
+}